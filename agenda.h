@@ -0,0 +1,179 @@
+/**
+ * @file agenda.h
+ * @brief Goal agenda for the incremental satisficing search (agenda).
+ *
+ * The goals of the problem are solved one at a time. The agenda starts with an
+ * empty goal; before every increment, each goal not yet on it is evaluated from
+ * the state reached so far with the heuristic (h4 or rp), together with the
+ * goals already on the agenda, and the one with the lowest value is added. The
+ * search then only has to reach the new goal, which keeps every increment small
+ * (see agenda_search in planner.c).
+ *
+ * The global `goal` holds the goals of the agenda while the increments run, so
+ * that the goal test, the heuristics and the actions generated by find_children
+ * (samples and communications are only tried for goals) all see the partial
+ * goal. The heuristic caches are cleared whenever it changes.
+ *
+ * A goal is referred to by its slot: soil goals come first (one slot per
+ * waypoint), then rock goals, then image goals (one slot per objective and mode).
+ */
+
+#ifndef AGENDA_H
+#define AGENDA_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include "auxiliary.h"
+#include "heuristic.h"
+#include "hcache.h"
+
+#define GOAL_SLOTS (MAX_WAYPOINTS * 2 + MAX_OBJECTIVES * MAX_MODES) // Slots of all possible goals.
+#define AGENDA_EXTRACTS 5000 // Extractions an increment may take besides those of the earlier ones.
+
+int agenda_fallback = 0;      // Search for all goals when an increment fails (--agenda-fallback).
+int agenda_active = 0;        // Set while the increments run.
+int agenda_first_extract;     // Value of total_extracts when the first increment started.
+Goal full_goal;               // The goals of the problem, while `goal` holds the agenda.
+
+/**
+ * @brief Returns the flag of a goal slot in a goal set.
+ */
+int *goal_slot(Goal *g, int slot) {
+    if (slot < MAX_WAYPOINTS) return &g->communicated_soil_data[slot];
+    if (slot < 2 * MAX_WAYPOINTS) return &g->communicated_rock_data[slot - MAX_WAYPOINTS];
+    slot -= 2 * MAX_WAYPOINTS;
+    return &g->communicated_image_data[slot / MAX_MODES][slot % MAX_MODES];
+}
+
+/**
+ * @brief Checks if the goal of a slot holds in a state.
+ */
+int goal_slot_achieved(const State *s, int slot) {
+    if (slot < MAX_WAYPOINTS) return s->waypoints[slot].communicated_soil;
+    if (slot < 2 * MAX_WAYPOINTS) return s->waypoints[slot - MAX_WAYPOINTS].communicated_rock;
+    slot -= 2 * MAX_WAYPOINTS;
+    return (s->objectives[slot / MAX_MODES].communicated_image >> (slot % MAX_MODES)) & 1;
+}
+
+/**
+ * @brief Writes the PDDL name of the goal of a slot (e.g. "communicated_soil_data waypoint3").
+ * @param slot The goal slot.
+ * @param name Output buffer of at least MAX_LINE characters.
+ */
+void goal_slot_name(int slot, char *name) {
+    static const char *modes[] = {"colour", "high_res", "low_res"};
+    if (slot < MAX_WAYPOINTS) sprintf(name, "communicated_soil_data waypoint%d", slot);
+    else if (slot < 2 * MAX_WAYPOINTS) sprintf(name, "communicated_rock_data waypoint%d", slot - MAX_WAYPOINTS);
+    else {
+        slot -= 2 * MAX_WAYPOINTS;
+        sprintf(name, "communicated_image_data objective%d %s", slot / MAX_MODES, modes[slot % MAX_MODES]);
+    }
+}
+
+/**
+ * @brief Counts the goals of a goal set.
+ */
+int count_goals(Goal *g) {
+    int count = 0;
+    for (int slot = 0; slot < GOAL_SLOTS; slot++) count += *goal_slot(g, slot) != 0;
+    return count;
+}
+
+/**
+ * @brief Moves the goals of the problem to full_goal and starts with an empty agenda.
+ */
+void agenda_begin() {
+    full_goal = goal;
+    memset(&goal, 0, sizeof(Goal));
+    goal_changed();
+    clear_h_cache();
+    agenda_active = 1;
+}
+
+/**
+ * @brief Puts the goals of the problem back.
+ */
+void agenda_end() {
+    goal = full_goal;
+    goal_changed();
+    clear_h_cache();
+    agenda_active = 0;
+}
+
+/**
+ * @brief Returns the extraction limit of the next increment.
+ *
+ * An increment that takes much longer than the others is usually stuck on a
+ * plateau that the earlier increments led it to. It may take AGENDA_EXTRACTS
+ * extractions plus ten times as many as all the earlier increments together, so
+ * that the late increments of a large problem, which are slower, get more room.
+ * @param extracts The number of extractions so far (total_extracts).
+ * @return The value of total_extracts after which the increment fails.
+ */
+int agenda_extract_limit(int extracts) {
+    return extracts + AGENDA_EXTRACTS + 10 * (extracts - agenda_first_extract);
+}
+
+/**
+ * @brief Checks if a state is a dead end for the goals of the problem.
+ *
+ * An increment only sees the goals of the agenda, and would gladly spend the
+ * energy or the samples that a later goal needs. The search of an increment
+ * drops the states from which the whole problem can no longer be solved, as
+ * proven by the routing bound (the task assignment estimate proves nothing).
+ * @param s The state.
+ * @return 1 if some goal of the problem can no longer be achieved from s, 0 otherwise.
+ */
+int agenda_dead_end(State *s) {
+    Goal agenda_goal = goal;
+
+    goal = full_goal; // The goal bitmasks are not rebuilt: no goal is tested before the agenda is back.
+    int dead_end = routing_bound(s) == INT_MAX;
+    goal = agenda_goal;
+    return dead_end;
+}
+
+/**
+ * @brief Adds the next goal to the agenda (see the file comment).
+ *
+ * Goals that already hold in the state are added as well, without counting as
+ * the next goal.
+ * @param s The state reached by the previous increments.
+ * @return The slot of the goal added, or -1 if all goals are on the agenda.
+ */
+int agenda_next_goal(State *s) {
+    int best_slot = -1, best_h = INT_MAX, cache_enabled = h_cache_enabled;
+
+    for (int slot = 0; slot < GOAL_SLOTS; slot++) {
+        if (*goal_slot(&full_goal, slot) && goal_slot_achieved(s, slot)) *goal_slot(&goal, slot) = 1;
+    }
+    goal_changed();
+
+    // The cached rover rows only hold the goals they were computed for.
+    h_cache_enabled = 0;
+    for (int slot = 0; slot < GOAL_SLOTS; slot++) {
+        if (!*goal_slot(&full_goal, slot) || *goal_slot(&goal, slot)) continue;
+
+        *goal_slot(&goal, slot) = 1;
+        goal_changed();
+        int h = heuristic_function(s);
+        *goal_slot(&goal, slot) = 0;
+        goal_changed();
+
+        // A goal that looks unreachable is only taken when no other is left.
+        if (best_slot < 0 || h < best_h) {
+            best_slot = slot;
+            best_h = h;
+        }
+    }
+
+    h_cache_enabled = cache_enabled;
+
+    if (best_slot >= 0) *goal_slot(&goal, best_slot) = 1;
+    goal_changed();
+    clear_h_cache();
+    return best_slot;
+}
+
+#endif // AGENDA_H
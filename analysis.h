@@ -0,0 +1,281 @@
+/**
+ * @file analysis.h
+ * @brief Measures how accurate the heuristic was on a solved problem (--analyze).
+ *
+ * During the search, every extracted node is counted in its f-layer, and the
+ * number of extractions between two improvements of the best h seen so far is
+ * recorded as a plateau of the search.
+ *
+ * After the search, the plan is replayed from the initial state. At every step,
+ * h and its two components (assignment_estimate and routing_bound) are compared
+ * with the cost of the rest of the plan. That cost is the true cost-to-go h* when
+ * the plan is optimal (A*), and an upper bound of it otherwise.
+ *
+ * The results are written to two files:
+ *  - <prefix>.csv: one line per step of the plan;
+ *  - <prefix>.json: a summary with error statistics per component, the error
+ *    histogram, the plateaus of the plan and of the search, and the f-layers.
+ */
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "auxiliary.h"
+#include "heuristic.h"
+#include "solution.h"
+
+#define ANALYSIS_BIN_WIDTH 8 // Width of the error histogram bins (the energy of one navigation).
+
+char analysis_prefix[MAX_LINE] = ""; // Output prefix given with --analyze (empty: no analysis).
+
+long long *layer_extracts = NULL;    // Extracted nodes by f value.
+int layer_size = 0;                  // Entries of layer_extracts.
+int layers_failed = 0;               // Set if layer_extracts could not grow.
+
+int plateau_best_h = -1;             // Best h extracted so far (-1: nothing extracted yet).
+long long plateau_length = 0;        // Extractions since plateau_best_h was reached.
+long long *plateaus = NULL;          // Lengths of the finished plateaus of the search.
+int plateau_count = 0, plateau_capacity = 0;
+
+/**
+ * @struct StepAnalysis
+ * @brief The heuristic values at one state of the plan.
+ */
+typedef struct {
+    int g;          // Energy spent to reach the state.
+    int h;          // The heuristic value.
+    int assignment; // The task assignment estimate.
+    int routing;    // The routing bound.
+    int to_go;      // Energy spent by the rest of the plan.
+} StepAnalysis;
+
+/**
+ * @brief Appends a finished plateau to the list.
+ */
+void add_plateau(long long length) {
+    if (plateau_count == plateau_capacity) {
+        int capacity = plateau_capacity ? 2 * plateau_capacity : 64;
+        long long *grown = (long long*) realloc(plateaus, capacity * sizeof(long long));
+        if (grown == NULL) return;
+        plateaus = grown;
+        plateau_capacity = capacity;
+    }
+    plateaus[plateau_count++] = length;
+}
+
+/**
+ * @brief Records an extracted node (called by the search loop when --analyze is given).
+ * @param f The node's f value.
+ * @param h The node's h value.
+ */
+void analysis_record_extract(int f, int h) {
+    if (f >= 0 && !layers_failed) {
+        if (f >= layer_size) {
+            int size = layer_size ? layer_size : 256;
+            while (size <= f) size *= 2;
+            long long *grown = (long long*) realloc(layer_extracts, size * sizeof(long long));
+            if (grown == NULL) {
+                printf("Memory exhausted while counting f-layers. The layers will not be reported.\n");
+                layers_failed = 1;
+                return;
+            }
+            for (int i = layer_size; i < size; i++) grown[i] = 0;
+            layer_extracts = grown;
+            layer_size = size;
+        }
+        layer_extracts[f]++;
+    }
+
+    if (plateau_best_h < 0 || h < plateau_best_h) {
+        if (plateau_best_h >= 0) add_plateau(plateau_length);
+        plateau_best_h = h;
+        plateau_length = 0;
+    }
+    else plateau_length++;
+}
+
+/**
+ * @brief Replays the plan in `solution` and computes the values at every state.
+ * @param init The initial state.
+ * @param steps Output array of solution_length + 1 entries (step 0 is the initial state).
+ * @return 1 on success, 0 if an action of the plan is not applicable.
+ */
+int analyse_plan(State *init, StepAnalysis *steps) {
+    State current = *init, next;
+    int params[5], energy_spent, g = 0;
+
+    for (int i = 0; i <= solution_length; i++) {
+        if (i > 0) {
+            int action_type = compact_action_unpack(solution[i - 1].code, params);
+            if (!apply_action(&current, action_type, params, &next, &energy_spent)) return 0;
+            g += energy_spent;
+            current = next;
+        }
+
+        steps[i].g = g;
+        steps[i].h = heuristic(current);
+        if (is_goal_state(&current)) {
+            steps[i].assignment = steps[i].routing = 0;
+        } else {
+            steps[i].assignment = assignment_estimate(&current);
+            steps[i].routing = routing_bound(&current);
+        }
+    }
+    for (int i = 0; i <= solution_length; i++) steps[i].to_go = g - steps[i].g;
+    return 1;
+}
+
+/**
+ * @brief Writes the error statistics of one component of the heuristic as a JSON object.
+ * @param name The name of the component.
+ * @param which 0 for h, 1 for the assignment estimate, 2 for the routing bound.
+ */
+void write_component_json(FILE *f, const char *name, StepAnalysis *steps, int which) {
+    int count = 0, over = 0, exact = 0, dominant = 0;
+    double sum_error = 0, sum_abs = 0, sum_ratio = 0;
+
+    for (int i = 0; i < solution_length; i++) {
+        int value = which == 0 ? steps[i].h : (which == 1 ? steps[i].assignment : steps[i].routing);
+        if (value == INT_MAX) continue;
+        int error = steps[i].to_go - value;
+        count++;
+        sum_error += error;
+        sum_abs += error < 0 ? -error : error;
+        sum_ratio += steps[i].to_go > 0 ? (double) value / steps[i].to_go : 1.0;
+        if (error < 0) over++;
+        if (error == 0) exact++;
+        if (which > 0 && value == steps[i].h) dominant++;
+    }
+
+    fprintf(f, "    \"%s\": {\"steps\": %d, \"mean_error\": %.3f, \"mean_abs_error\": %.3f, \"mean_ratio\": %.4f, "
+               "\"exact\": %d, \"overestimates\": %d",
+            name, count, count ? sum_error / count : 0.0, count ? sum_abs / count : 0.0,
+            count ? sum_ratio / count : 0.0, exact, over);
+    if (which > 0) fprintf(f, ", \"equals_h\": %d", dominant);
+    fprintf(f, "}");
+}
+
+/**
+ * @brief Writes the analysis of the plan and of the search (see the file comment).
+ * @param init The initial state.
+ * @param method_name The search method, as given on the command line.
+ * @return 0 on success, -1 on failure.
+ */
+int write_analysis(State *init, const char *method_name) {
+    char filename[MAX_LINE + 8];
+    StepAnalysis *steps = (StepAnalysis*) malloc((solution_length + 1) * sizeof(StepAnalysis));
+    if (steps == NULL) {
+        printf("Memory allocation for the analysis failed!\n");
+        return -1;
+    }
+    if (!analyse_plan(init, steps)) {
+        printf("The plan could not be replayed for the analysis.\n");
+        free(steps);
+        return -1;
+    }
+
+    // One line per step.
+    snprintf(filename, sizeof(filename), "%s.csv", analysis_prefix);
+    FILE *f = fopen(filename, "w");
+    if (f == NULL) {
+        printf("Cannot open analysis file %s.\n", filename);
+        free(steps);
+        return -1;
+    }
+    fprintf(f, "step,action,g,h,assignment,routing,cost_to_go,error\n");
+    for (int i = 0; i <= solution_length; i++) {
+        fprintf(f, "%d,", i);
+        if (i > 0) {
+            fprintf(f, "%s", action_name(solution[i - 1].action_type));
+            for (int j = 0; j < solution[i - 1].num_params; j++) {
+                if (solution[i - 1].param_names[j][0] != '\0') fprintf(f, " %s", solution[i - 1].param_names[j]);
+            }
+        }
+        fprintf(f, ",%d,%d,%d,%d,%d,%d\n", steps[i].g, steps[i].h, steps[i].assignment, steps[i].routing,
+                steps[i].to_go, steps[i].to_go - steps[i].h);
+    }
+    fclose(f);
+
+    // The summary.
+    snprintf(filename, sizeof(filename), "%s.json", analysis_prefix);
+    f = fopen(filename, "w");
+    if (f == NULL) {
+        printf("Cannot open analysis file %s.\n", filename);
+        free(steps);
+        return -1;
+    }
+
+    fprintf(f, "{\n  \"method\": \"%s\",\n  \"plan_length\": %d,\n  \"plan_cost\": %d,\n  \"initial_h\": %d,\n",
+            method_name, solution_length, total_energy, steps[0].h);
+    fprintf(f, "  \"expansions\": %d,\n  \"generated\": %d,\n", total_extracts, total_inserts);
+
+    fprintf(f, "  \"components\": {\n");
+    write_component_json(f, "h", steps, 0);
+    fprintf(f, ",\n");
+    write_component_json(f, "assignment", steps, 1);
+    fprintf(f, ",\n");
+    write_component_json(f, "routing", steps, 2);
+    fprintf(f, "\n  },\n");
+
+    // Histogram of h errors (cost-to-go - h) over the non-goal states of the plan.
+    int min_bin = 0, max_bin = 0;
+    for (int i = 0; i < solution_length; i++) {
+        int error = steps[i].to_go - steps[i].h;
+        int bin = error >= 0 ? error / ANALYSIS_BIN_WIDTH : -((-error + ANALYSIS_BIN_WIDTH - 1) / ANALYSIS_BIN_WIDTH);
+        if (i == 0 || bin < min_bin) min_bin = bin;
+        if (i == 0 || bin > max_bin) max_bin = bin;
+    }
+    fprintf(f, "  \"error_histogram\": [");
+    for (int bin = min_bin; solution_length > 0 && bin <= max_bin; bin++) {
+        int count = 0;
+        for (int i = 0; i < solution_length; i++) {
+            int error = steps[i].to_go - steps[i].h;
+            if (error >= bin * ANALYSIS_BIN_WIDTH && error < (bin + 1) * ANALYSIS_BIN_WIDTH) count++;
+        }
+        fprintf(f, "%s\n    {\"from\": %d, \"to\": %d, \"count\": %d}", bin > min_bin ? "," : "",
+                bin * ANALYSIS_BIN_WIDTH, (bin + 1) * ANALYSIS_BIN_WIDTH - 1, count);
+    }
+    fprintf(f, "\n  ],\n");
+
+    // Runs of steps of the plan along which h did not decrease.
+    fprintf(f, "  \"plan_plateaus\": [");
+    int run = 0, runs = 0;
+    for (int i = 1; i <= solution_length; i++) {
+        if (steps[i].h >= steps[i - 1].h) run++;
+        if ((steps[i].h < steps[i - 1].h || i == solution_length) && run > 0) {
+            fprintf(f, "%s%d", runs++ ? ", " : "", run);
+            run = 0;
+        }
+    }
+    fprintf(f, "],\n");
+
+    // Extractions between two improvements of the best h (the last one ends at the goal).
+    long long longest = 0, total = 0;
+    for (int i = 0; i < plateau_count; i++) {
+        total += plateaus[i];
+        if (plateaus[i] > longest) longest = plateaus[i];
+    }
+    fprintf(f, "  \"search_plateaus\": {\"count\": %d, \"longest\": %lld, \"mean\": %.2f, \"lengths\": [",
+            plateau_count, longest, plateau_count ? (double) total / plateau_count : 0.0);
+    for (int i = 0; i < plateau_count; i++) fprintf(f, "%s%lld", i ? ", " : "", plateaus[i]);
+    fprintf(f, "]},\n");
+
+    fprintf(f, "  \"f_layers\": [");
+    int layers = 0;
+    for (int i = 0; i < layer_size; i++) {
+        if (layer_extracts[i] == 0) continue;
+        fprintf(f, "%s\n    {\"f\": %d, \"extracted\": %lld}", layers++ ? "," : "", i, layer_extracts[i]);
+    }
+    fprintf(f, "\n  ]\n}\n");
+    fclose(f);
+
+    printf("Heuristic analysis written to %s.csv and %s.json (initial h=%d, plan cost=%d).\n",
+           analysis_prefix, analysis_prefix, steps[0].h, total_energy);
+    free(steps);
+    return 0;
+}
+
+#endif // ANALYSIS_H
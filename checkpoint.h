@@ -0,0 +1,481 @@
+/**
+ * @file checkpoint.h
+ * @brief Saving and restoring the state of a running search.
+ *
+ * A checkpoint holds everything the sequential search needs to continue where it
+ * stopped: the frontier, the expanded nodes the frontier entries descend from,
+ * the closed set and the heap statistics. States are not stored: every node and
+ * frontier entry is written as (parent, compact action, g, h, f) and its state is
+ * rebuilt on resume by replaying the action on the parent's state, starting from
+ * the initial state of the problem. The same layout serves the normal and the
+ * compact frontier (see open_entry). Closed set keys are delta-encoded against
+ * the key of the initial state (see put_key_delta); each is followed by the
+ * lowest g of its state, which decides whether a cheaper path reopens it.
+ *
+ * File layout (all integers are varints unless noted otherwise):
+ *   magic (8 bytes), version, problem fingerprint, method,
+ *   inserts, extracts, CPU time spent so far in ms,
+ *   node count, expanded nodes (parent id + 1 or 0 for the root, action code, g, h, f),
+ *   frontier count, frontier entries (parent id + 1 or 0 for the root, action code, g, h, f),
+ *   closed count, closed entries (key, g),
+ *   checksum of everything above (8 bytes, little-endian).
+ *
+ * Checkpoints are written by a forked child process, so the search never waits
+ * for the disk, and are crash-consistent: the data goes to "<file>.tmp", which
+ * is flushed to disk and only then renamed over the previous checkpoint.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "auxiliary.h"
+#include "minheap.h"
+#include "statekey.h"
+#include "uthash.h"
+
+#define CHECKPOINT_MAGIC    "RVCKPT\r\n" // 8 bytes; the CR/LF pair detects text-mode corruption.
+#define CHECKPOINT_VERSION  3
+#define CHECKPOINT_INTERVAL 300          // Default seconds between checkpoints.
+
+char checkpoint_file[MAX_LINE] = "";           // Checkpoint file (--checkpoint); empty when disabled.
+char resume_file[MAX_LINE] = "";               // Checkpoint to resume from (--resume); empty when disabled.
+int checkpoint_interval = CHECKPOINT_INTERVAL; // Seconds between checkpoints (--checkpoint-interval).
+time_t last_checkpoint;                        // Time the last checkpoint was started.
+pid_t checkpoint_pid = 0;                      // Child process writing a checkpoint (0 if none).
+
+/**
+ * @struct CheckpointWriter
+ * @brief Buffered output stream that keeps a running checksum of what it writes.
+ */
+typedef struct {
+    FILE *fp;
+    unsigned long long checksum;
+    int error;
+} CheckpointWriter;
+
+/**
+ * @struct CheckpointReader
+ * @brief Input stream over a checkpoint file loaded into memory.
+ */
+typedef struct {
+    unsigned char *data;
+    long len, pos;
+    int error;      // Set when a read runs past the end of the data.
+} CheckpointReader;
+
+/**
+ * @struct node_id
+ * @brief Maps a search tree node to its index in the checkpoint (using uthash).
+ */
+typedef struct {
+    struct tree_node *node;
+    long long id;
+    UT_hash_handle hh;
+} node_id;
+
+/**
+ * @brief Continues an FNV-1a hash over a block of bytes.
+ */
+unsigned long long checkpoint_hash(unsigned long long h, const void *data, size_t n) {
+    const unsigned char *bytes = (const unsigned char*) data;
+    for (size_t i = 0; i < n; i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief Identifies the problem a checkpoint belongs to.
+ *
+ * Hashes the initial state (which the parser zeroes before filling it, so its
+ * padding is well defined), the goal and the object counts.
+ */
+unsigned long long problem_fingerprint(State *init) {
+    int counts[6] = {num_rovers, num_waypoints, num_stores, num_cameras, num_modes, num_objectives};
+    unsigned long long h = 1469598103934665603ULL;
+    h = checkpoint_hash(h, init, sizeof(State));
+    h = checkpoint_hash(h, &goal, sizeof(Goal));
+    return checkpoint_hash(h, counts, sizeof(counts));
+}
+
+void ckpt_write_bytes(CheckpointWriter *w, const void *data, size_t n) {
+    w->checksum = checkpoint_hash(w->checksum, data, n);
+    if (fwrite(data, 1, n, w->fp) != n) w->error = 1;
+}
+
+void ckpt_write_varint(CheckpointWriter *w, unsigned long long v) {
+    unsigned char buf[10];
+    ckpt_write_bytes(w, buf, put_varint(buf, v));
+}
+
+unsigned long long ckpt_read_varint(CheckpointReader *r) {
+    unsigned long long v = 0;
+    int n = (r->pos < r->len) ? get_varint(r->data + r->pos, (int) ((r->len - r->pos) > 10 ? 10 : (r->len - r->pos)), &v) : 0;
+    if (n == 0) {
+        r->error = 1;
+        return 0;
+    }
+    r->pos += n;
+    return v;
+}
+
+/**
+ * @brief Returns the fields of a frontier entry, whichever form it has.
+ * @param entry The entry stored in the heap (a tree_node, or an open_entry if `compact` is set).
+ * @param compact 1 if the frontier holds open_entry records.
+ * @param e Output parameter receiving the fields.
+ */
+void checkpoint_entry(void *entry, int compact, open_entry *e) {
+    if (compact) {
+        *e = *(open_entry*) entry;
+        return;
+    }
+    struct tree_node *node = (struct tree_node*) entry;
+    e->parent = node->parent;
+    e->code = node->parent != NULL ? node->action_taken.code : 0;
+    e->g = node->g;
+    e->h = node->h;
+    e->f = node->f;
+}
+
+/**
+ * @brief Writes the (parent, action, g, h, f) record of a node or frontier entry.
+ */
+void ckpt_write_record(CheckpointWriter *w, node_id *ids, open_entry *e) {
+    node_id *entry = NULL;
+    if (e->parent != NULL) HASH_FIND_PTR(ids, &e->parent, entry);
+    ckpt_write_varint(w, entry != NULL ? (unsigned long long) entry->id + 1 : 0);
+    ckpt_write_varint(w, e->code);
+    ckpt_write_varint(w, (unsigned long long) e->g);
+    ckpt_write_varint(w, (unsigned long long) e->h);
+    ckpt_write_varint(w, (unsigned long long) e->f);
+}
+
+/**
+ * @brief Writes a checkpoint file.
+ *
+ * The expanded ancestors of the frontier entries are numbered so that every
+ * parent comes before its children, which lets the loader rebuild the states in
+ * one pass.
+ * @param filename The checkpoint file. The data is written to "<filename>.tmp" first.
+ * @param init The initial state of the problem.
+ * @param method The search method (it determines how f was computed).
+ * @param heap The frontier.
+ * @param compact 1 if the frontier holds open_entry records instead of tree nodes.
+ * @param closed The closed set.
+ * @param inserts, extracts The heap statistics.
+ * @param cpu_ms The CPU time spent by the search so far, in milliseconds.
+ * @return 0 on success, -1 on error.
+ */
+int write_checkpoint(const char *filename, State *init, int method, MinHeap *heap, int compact,
+                     state_entry *closed, int inserts, int extracts, long long cpu_ms) {
+    char tmp_name[MAX_LINE + 8];
+    snprintf(tmp_name, sizeof(tmp_name), "%s.tmp", filename);
+
+    // Number the expanded ancestors of the frontier entries, parents first.
+    node_id *ids = NULL, *entry, *next;
+    struct tree_node **order = NULL, **chain = NULL;
+    long long count = 0, capacity = 0, chain_cap = 0;
+    open_entry e;
+    int ok = 1;
+
+    for (int i = 0; i < heap->nodeSize && ok; i++) {
+        long long chain_len = 0;
+        checkpoint_entry(heap_node_at(heap, i), compact, &e);
+        struct tree_node *node = e.parent;
+
+        // Collect the ancestors that have not been numbered yet...
+        while (node != NULL) {
+            HASH_FIND_PTR(ids, &node, entry);
+            if (entry != NULL) break;
+            if (chain_len == chain_cap) {
+                chain_cap = chain_cap ? 2 * chain_cap : 64;
+                chain = (struct tree_node**) realloc(chain, chain_cap * sizeof(struct tree_node*));
+                if (chain == NULL) { ok = 0; break; }
+            }
+            chain[chain_len++] = node;
+            node = node->parent;
+        }
+        // ... and number them from the oldest one down.
+        while (ok && chain_len > 0) {
+            if (count == capacity) {
+                capacity = capacity ? 2 * capacity : 1024;
+                order = (struct tree_node**) realloc(order, capacity * sizeof(struct tree_node*));
+                if (order == NULL) { ok = 0; break; }
+            }
+            entry = (node_id*) malloc(sizeof(node_id));
+            if (entry == NULL) { ok = 0; break; }
+            entry->node = chain[--chain_len];
+            entry->id = count;
+            order[count++] = entry->node;
+            HASH_ADD_PTR(ids, node, entry);
+        }
+    }
+
+    FILE *fp = ok ? fopen(tmp_name, "wb") : NULL;
+    if (fp == NULL) ok = 0;
+
+    if (ok) {
+        CheckpointWriter w = {fp, 1469598103934665603ULL, 0};
+        StateKey base, key;
+        unsigned char buf[11 * sizeof(StateKey) + 10];
+        make_state_key(init, &base);
+
+        ckpt_write_bytes(&w, CHECKPOINT_MAGIC, 8);
+        ckpt_write_varint(&w, CHECKPOINT_VERSION);
+        ckpt_write_varint(&w, problem_fingerprint(init));
+        ckpt_write_varint(&w, (unsigned long long) method);
+        ckpt_write_varint(&w, (unsigned long long) inserts);
+        ckpt_write_varint(&w, (unsigned long long) extracts);
+        ckpt_write_varint(&w, (unsigned long long) cpu_ms);
+
+        ckpt_write_varint(&w, (unsigned long long) count);
+        for (long long i = 0; i < count; i++) {
+            checkpoint_entry(order[i], 0, &e);
+            ckpt_write_record(&w, ids, &e);
+        }
+
+        ckpt_write_varint(&w, (unsigned long long) heap->nodeSize);
+        for (int i = 0; i < heap->nodeSize; i++) {
+            checkpoint_entry(heap_node_at(heap, i), compact, &e);
+            ckpt_write_record(&w, ids, &e);
+        }
+
+        ckpt_write_varint(&w, (unsigned long long) HASH_COUNT(closed));
+        state_entry *s, *tmp;
+        HASH_ITER(hh, closed, s, tmp) {
+            key = s->key;
+            ckpt_write_bytes(&w, buf, put_key_delta(buf, &key, &base));
+            ckpt_write_varint(&w, (unsigned long long) s->g);
+        }
+
+        unsigned char trailer[8];
+        for (int i = 0; i < 8; i++) trailer[i] = (unsigned char) (w.checksum >> (8 * i));
+        if (fwrite(trailer, 1, 8, fp) != 8) w.error = 1;
+
+        // The data must be on disk before the rename makes it the current checkpoint.
+        if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) w.error = 1;
+        if (fclose(fp) != 0) w.error = 1;
+        ok = !w.error && rename(tmp_name, filename) == 0;
+        if (!ok) remove(tmp_name);
+    }
+
+    HASH_ITER(hh, ids, entry, next) {
+        HASH_DEL(ids, entry);
+        free(entry);
+    }
+    free(order);
+    free(chain);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief Waits for the process writing the last checkpoint.
+ * @param block 1 to wait until it finishes, 0 to only check.
+ */
+void wait_checkpoint(int block) {
+    int status;
+    if (checkpoint_pid == 0) return;
+    pid_t res = waitpid(checkpoint_pid, &status, block ? 0 : WNOHANG);
+    if (res == 0) return; // Still running.
+    if (res == checkpoint_pid && (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+        printf("Writing checkpoint %s failed.\n", checkpoint_file);
+    checkpoint_pid = 0;
+}
+
+/**
+ * @brief Starts writing a checkpoint in the background.
+ *
+ * The search process forks; the child sees a frozen copy of the search tree
+ * (copy-on-write) and writes it while the parent continues the search. If the
+ * previous checkpoint is still being written, no new one is started.
+ * Must only be called from a single-threaded process, between two node expansions.
+ */
+void start_checkpoint(State *init, int method, MinHeap *heap, int compact, state_entry *closed,
+                      int inserts, int extracts, long long cpu_ms) {
+    wait_checkpoint(0);
+    if (checkpoint_pid != 0) return;
+
+    last_checkpoint = time(NULL);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        int res = write_checkpoint(checkpoint_file, init, method, heap, compact, closed, inserts, extracts, cpu_ms);
+        _exit(res == 0 ? 0 : 1);
+    }
+    if (pid < 0) {
+        // fork failed (e.g. no memory for the page tables); write in the foreground instead.
+        if (write_checkpoint(checkpoint_file, init, method, heap, compact, closed, inserts, extracts, cpu_ms) < 0)
+            printf("Writing checkpoint %s failed.\n", checkpoint_file);
+        return;
+    }
+    checkpoint_pid = pid;
+}
+
+/**
+ * @brief Reports an unusable checkpoint and terminates the program.
+ */
+void checkpoint_error(const char *filename, const char *reason) {
+    printf("Cannot resume from checkpoint %s: %s\n", filename, reason);
+    exit(1);
+}
+
+/**
+ * @brief Reads one (parent, action, g, h, f) record.
+ * @param nodes The expanded nodes read so far.
+ * @param limit The number of valid entries in `nodes`.
+ * @param e Output parameter for the record; the parent is resolved to a node.
+ */
+void ckpt_read_record(const char *filename, CheckpointReader *r, struct tree_node **nodes, long long limit, open_entry *e) {
+    long long parent = (long long) ckpt_read_varint(r);
+    e->code = (CompactAction) ckpt_read_varint(r);
+    e->g = (int) ckpt_read_varint(r);
+    e->h = (int) ckpt_read_varint(r);
+    e->f = (int) ckpt_read_varint(r);
+    if (r->error || parent > limit) checkpoint_error(filename, "the file is malformed");
+    e->parent = parent > 0 ? nodes[parent - 1] : NULL;
+}
+
+/**
+ * @brief Builds the full search tree node described by a record.
+ *
+ * The state is the initial state for the root, and the result of replaying the
+ * action on the parent's state otherwise.
+ */
+struct tree_node *ckpt_make_node(const char *filename, State *init, open_entry *e) {
+    struct tree_node *node = (struct tree_node*) malloc(sizeof(struct tree_node));
+    if (node == NULL) checkpoint_error(filename, "memory exhausted");
+
+    node->parent = e->parent;
+    if (e->parent == NULL) {
+        node->action_taken.action_type = -1;
+        node->currState = *init;
+        node->depth = 0;
+        if (e->g != 0) checkpoint_error(filename, "the file is malformed");
+    }
+    else {
+        int params[5], energy_spent;
+        int action_type = compact_action_unpack(e->code, params);
+        if (!apply_action(&e->parent->currState, action_type, params, &node->currState, &energy_spent) ||
+            e->parent->g + energy_spent != e->g)
+            checkpoint_error(filename, "a stored action does not replay on this problem");
+        node->depth = e->parent->depth + 1;
+        set_action(&node->action_taken, action_type, params, action_param_count(action_type));
+    }
+    node->g = e->g;
+    node->h = e->h;
+    node->f = e->f;
+    return node;
+}
+
+/**
+ * @brief Restores a search from a checkpoint file.
+ *
+ * Rebuilds the expanded nodes by replaying the stored actions from the initial
+ * state, refills the frontier and the closed set, and restores the statistics.
+ * With a compact frontier, the frontier entries are restored as open_entry
+ * records and their states are only regenerated when they are extracted.
+ * Terminates the program if the file cannot be used.
+ * @param filename The checkpoint file.
+ * @param init The initial state of the problem.
+ * @param method The search method of the current run; it must match the checkpoint.
+ * @param heap The (empty) frontier to fill.
+ * @param compact 1 to fill the frontier with open_entry records instead of tree nodes.
+ * @param closed The closed set to fill.
+ * @param inserts, extracts Output parameters for the heap statistics.
+ * @param cpu_ms Output parameter for the CPU time spent before the checkpoint.
+ * @return The number of frontier entries restored.
+ */
+long long load_checkpoint(const char *filename, State *init, int method, MinHeap *heap, int compact,
+                          state_entry **closed, int *inserts, int *extracts, long long *cpu_ms) {
+    CheckpointReader r = {NULL, 0, 0, 0};
+    open_entry e;
+
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) checkpoint_error(filename, "the file cannot be opened");
+    if (fseek(fp, 0, SEEK_END) == 0) r.len = ftell(fp);
+    rewind(fp);
+    if (r.len < 16) checkpoint_error(filename, "the file is truncated");
+    r.data = (unsigned char*) malloc(r.len);
+    if (r.data == NULL) checkpoint_error(filename, "memory exhausted");
+    if (fread(r.data, 1, r.len, fp) != (size_t) r.len) checkpoint_error(filename, "the file cannot be read");
+    fclose(fp);
+
+    unsigned long long checksum = 0;
+    for (int i = 0; i < 8; i++) checksum |= (unsigned long long) r.data[r.len - 8 + i] << (8 * i);
+    r.len -= 8;
+    if (memcmp(r.data, CHECKPOINT_MAGIC, 8) != 0 ||
+        checkpoint_hash(1469598103934665603ULL, r.data, r.len) != checksum)
+        checkpoint_error(filename, "the file is corrupt");
+    r.pos = 8;
+
+    if (ckpt_read_varint(&r) != CHECKPOINT_VERSION)
+        checkpoint_error(filename, "the file was written by another version of the planner");
+    if (ckpt_read_varint(&r) != problem_fingerprint(init))
+        checkpoint_error(filename, "the file was written for another problem");
+    if (ckpt_read_varint(&r) != (unsigned long long) method)
+        checkpoint_error(filename, "the file was written by another search method");
+    *inserts = (int) ckpt_read_varint(&r);
+    *extracts = (int) ckpt_read_varint(&r);
+    *cpu_ms = (long long) ckpt_read_varint(&r);
+
+    // Rebuild the expanded nodes.
+    long long count = (long long) ckpt_read_varint(&r);
+    if (r.error || count > r.len) checkpoint_error(filename, "the file is malformed");
+    struct tree_node **nodes = (struct tree_node**) calloc(count > 0 ? count : 1, sizeof(struct tree_node*));
+    if (nodes == NULL) checkpoint_error(filename, "memory exhausted");
+
+    for (long long i = 0; i < count; i++) {
+        ckpt_read_record(filename, &r, nodes, i, &e);
+        if ((e.parent == NULL) != (i == 0)) checkpoint_error(filename, "the file is malformed");
+        nodes[i] = ckpt_make_node(filename, init, &e);
+    }
+
+    // Refill the frontier.
+    long long open_count = (long long) ckpt_read_varint(&r);
+    if (r.error || open_count > r.len) checkpoint_error(filename, "the file is malformed");
+    for (long long i = 0; i < open_count; i++) {
+        ckpt_read_record(filename, &r, nodes, count, &e);
+        if (compact) {
+            open_entry *entry = (open_entry*) malloc(sizeof(open_entry));
+            if (entry == NULL) checkpoint_error(filename, "memory exhausted");
+            *entry = e;
+            insert_node(heap, e.f, e.h, entry);
+        }
+        else {
+            insert_node(heap, e.f, e.h, ckpt_make_node(filename, init, &e));
+        }
+    }
+
+    // Refill the closed set.
+    long long closed_count = (long long) ckpt_read_varint(&r);
+    if (r.error || closed_count > r.len) checkpoint_error(filename, "the file is malformed");
+    StateKey base;
+    make_state_key(init, &base);
+    for (long long i = 0; i < closed_count; i++) {
+        state_entry *entry = (state_entry*) malloc(sizeof(state_entry));
+        if (entry == NULL) checkpoint_error(filename, "memory exhausted");
+        long avail = r.len - r.pos;
+        int n = get_key_delta(r.data + r.pos, avail > 0x7fffffff ? 0x7fffffff : (int) avail, &entry->key, &base);
+        if (n == 0) checkpoint_error(filename, "the file is malformed");
+        r.pos += n;
+        entry->g = (int) ckpt_read_varint(&r);
+        if (r.error) checkpoint_error(filename, "the file is malformed");
+        HASH_ADD(hh, *closed, key, sizeof(StateKey), entry);
+    }
+
+    free(nodes);
+    free(r.data);
+    return open_count;
+}
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,248 @@
+/**
+ * @file concurrent_set.h
+ * @brief Lock-free closed set for multi-threaded search.
+ *
+ * The sequential planner keeps its closed set in a uthash table, which cannot be
+ * shared between threads. This file provides a fixed-capacity, open-addressing
+ * hash set over packed StateKeys that any number of threads can query and update
+ * concurrently without locks:
+ *  - insert-if-absent claims an empty slot with a single compare-and-swap on the
+ *    slot tag, writes the key and then publishes it;
+ *  - every stored key carries the best g-value seen so far, which is lowered
+ *    atomically when a cheaper path to the same state is found (needed for the
+ *    reopening rule of parallel A*);
+ *  - each thread counts its own operations in a private, cache-line-aligned
+ *    statistics block, so the counters never cause false sharing.
+ */
+
+#ifndef CONCURRENT_SET_H
+#define CONCURRENT_SET_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "statekey.h"
+
+// Maximum number of threads that can own a statistics block.
+#define CSET_MAX_THREADS 64
+
+// Slot tag states. The two lowest bits of a tag mark the state of the slot,
+// the remaining bits hold the upper part of the key hash.
+#define CSET_EMPTY   0ULL
+#define CSET_BUSY    1ULL   // A thread has claimed the slot and is writing the key.
+#define CSET_READY   2ULL   // The key is published and can be compared.
+#define CSET_STATE_MASK 3ULL
+
+// Return values of cset_insert.
+#define CSET_FULL       -1  // No free slot was found; the set must be made larger.
+#define CSET_DUPLICATE   0  // The key was already present with an equal or better g.
+#define CSET_INSERTED    1  // The key was new and has been inserted.
+#define CSET_IMPROVED    2  // The key was present, but with a worse g that has now been lowered.
+
+/**
+ * @struct CSetSlot
+ * @brief A single slot of the open-addressing table.
+ */
+typedef struct {
+    _Atomic unsigned long long tag; // Hash bits plus slot state (EMPTY, BUSY or READY).
+    _Atomic int best_g;             // Lowest g-value with which this state has been reached.
+    StateKey key;                   // The packed state.
+} CSetSlot;
+
+/**
+ * @struct CSetStats
+ * @brief Per-thread operation counters, padded to a cache line.
+ */
+typedef struct {
+    long long inserts;      // Keys inserted as new.
+    long long duplicates;   // Lookups that found the key already present.
+    long long improvements; // Duplicates whose best g was lowered.
+    long long probes;       // Slots inspected in total.
+    long long cas_failures; // Lost races when claiming a slot or lowering g.
+    char pad[64 - 5 * sizeof(long long)];
+} __attribute__((aligned(64))) CSetStats;
+
+/**
+ * @struct ConcurrentSet
+ * @brief The concurrent closed set.
+ */
+typedef struct {
+    CSetSlot *slots;                      // The slot array (capacity is a power of two).
+    unsigned long long mask;              // capacity - 1, used to wrap probe positions.
+    unsigned long long capacity;          // Number of slots.
+    _Atomic long long count;              // Number of stored keys.
+    CSetStats stats[CSET_MAX_THREADS];    // One statistics block per thread.
+} ConcurrentSet;
+
+/**
+ * @brief Creates a concurrent set able to hold at least `min_capacity` keys.
+ *
+ * The capacity is rounded up to the next power of two. The slot array is
+ * allocated once and never resized, so no thread ever has to stop the others.
+ * @param min_capacity The minimum number of slots.
+ * @return A pointer to the new set, or NULL if memory could not be allocated.
+ */
+ConcurrentSet *cset_create(unsigned long long min_capacity) {
+    unsigned long long capacity = 1024;
+    while (capacity < min_capacity) capacity <<= 1;
+
+    ConcurrentSet *set = (ConcurrentSet*) aligned_alloc(64, sizeof(ConcurrentSet));
+    if (set == NULL) return NULL;
+    memset(set, 0, sizeof(ConcurrentSet));
+
+    // calloc gives zeroed memory, i.e. every tag starts as CSET_EMPTY.
+    set->slots = (CSetSlot*) calloc(capacity, sizeof(CSetSlot));
+    if (set->slots == NULL) {
+        free(set);
+        return NULL;
+    }
+    set->capacity = capacity;
+    set->mask = capacity - 1;
+    atomic_init(&set->count, 0);
+    return set;
+}
+
+/**
+ * @brief Frees a concurrent set. Must not be called while other threads use it.
+ * @param set The set to free.
+ */
+void cset_free(ConcurrentSet *set) {
+    if (set == NULL) return;
+    free(set->slots);
+    free(set);
+}
+
+/**
+ * @brief Lowers the best g-value of a slot if `g` is smaller.
+ * @return 1 if the value was lowered, 0 otherwise.
+ */
+int cset_lower_g(ConcurrentSet *set, CSetSlot *slot, int g, int thread_id) {
+    int old = atomic_load_explicit(&slot->best_g, memory_order_relaxed);
+    while (g < old) {
+        if (atomic_compare_exchange_weak_explicit(&slot->best_g, &old, g,
+                                                  memory_order_acq_rel, memory_order_relaxed)) {
+            return 1;
+        }
+        set->stats[thread_id].cas_failures++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Inserts a key if it is absent, or lowers its best g if it is present.
+ *
+ * Uses linear probing. An empty slot is claimed by a compare-and-swap from EMPTY
+ * to BUSY; the key and g are then written and the slot is published by storing
+ * the READY tag with release semantics. A thread that meets a BUSY slot with the
+ * same hash bits waits for the owner to publish it before comparing keys, so two
+ * threads inserting the same state can never both succeed.
+ * @param set The set.
+ * @param key The packed state.
+ * @param hash The value returned by state_key_hash for this key.
+ * @param g The g-value with which the state has been reached.
+ * @param thread_id The caller's thread index (0 .. CSET_MAX_THREADS-1).
+ * @return CSET_INSERTED, CSET_IMPROVED, CSET_DUPLICATE or CSET_FULL.
+ */
+int cset_insert(ConcurrentSet *set, const StateKey *key, unsigned long long hash, int g, int thread_id) {
+    CSetStats *stats = &set->stats[thread_id];
+    unsigned long long hash_bits = hash & ~CSET_STATE_MASK;
+    unsigned long long busy_tag = hash_bits | CSET_BUSY;
+    unsigned long long ready_tag = hash_bits | CSET_READY;
+    unsigned long long pos = (hash >> 7) & set->mask;
+
+    for (unsigned long long probe = 0; probe < set->capacity; probe++) {
+        CSetSlot *slot = &set->slots[pos];
+        unsigned long long tag = atomic_load_explicit(&slot->tag, memory_order_acquire);
+        stats->probes++;
+
+        if (tag == CSET_EMPTY) {
+            unsigned long long expected = CSET_EMPTY;
+            if (atomic_compare_exchange_strong_explicit(&slot->tag, &expected, busy_tag,
+                                                        memory_order_acq_rel, memory_order_acquire)) {
+                slot->key = *key;
+                atomic_store_explicit(&slot->best_g, g, memory_order_relaxed);
+                atomic_store_explicit(&slot->tag, ready_tag, memory_order_release);
+                atomic_fetch_add_explicit(&set->count, 1, memory_order_relaxed);
+                stats->inserts++;
+                return CSET_INSERTED;
+            }
+            // Another thread claimed the slot first; look at what it is writing.
+            stats->cas_failures++;
+            tag = expected;
+        }
+
+        if ((tag & ~CSET_STATE_MASK) == hash_bits) {
+            // Same hash bits: wait until the key is published before comparing.
+            while ((tag & CSET_STATE_MASK) == CSET_BUSY) {
+                tag = atomic_load_explicit(&slot->tag, memory_order_acquire);
+            }
+            if (memcmp(&slot->key, key, sizeof(StateKey)) == 0) {
+                stats->duplicates++;
+                if (cset_lower_g(set, slot, g, thread_id)) {
+                    stats->improvements++;
+                    return CSET_IMPROVED;
+                }
+                return CSET_DUPLICATE;
+            }
+        }
+
+        pos = (pos + 1) & set->mask;
+    }
+
+    return CSET_FULL;
+}
+
+/**
+ * @brief Checks whether a key is present, without inserting it.
+ * @param best_g Output parameter for the stored best g (may be NULL).
+ * @return 1 if the key is present, 0 otherwise.
+ */
+int cset_contains(ConcurrentSet *set, const StateKey *key, unsigned long long hash, int *best_g) {
+    unsigned long long hash_bits = hash & ~CSET_STATE_MASK;
+    unsigned long long pos = (hash >> 7) & set->mask;
+
+    for (unsigned long long probe = 0; probe < set->capacity; probe++) {
+        CSetSlot *slot = &set->slots[pos];
+        unsigned long long tag = atomic_load_explicit(&slot->tag, memory_order_acquire);
+        if (tag == CSET_EMPTY) return 0;
+        if ((tag & ~CSET_STATE_MASK) == hash_bits) {
+            while ((tag & CSET_STATE_MASK) == CSET_BUSY) {
+                tag = atomic_load_explicit(&slot->tag, memory_order_acquire);
+            }
+            if (memcmp(&slot->key, key, sizeof(StateKey)) == 0) {
+                if (best_g != NULL) *best_g = atomic_load_explicit(&slot->best_g, memory_order_relaxed);
+                return 1;
+            }
+        }
+        pos = (pos + 1) & set->mask;
+    }
+    return 0;
+}
+
+/**
+ * @brief Prints the per-thread and total statistics of the set.
+ * @param set The set.
+ * @param num_threads The number of threads whose blocks should be reported.
+ */
+void cset_print_stats(ConcurrentSet *set, int num_threads) {
+    CSetStats total = {0};
+    for (int t = 0; t < num_threads; t++) {
+        CSetStats *s = &set->stats[t];
+        printf("Closed set thread %d: inserts=%lld, duplicates=%lld, improvements=%lld, probes=%lld, cas_failures=%lld\n",
+               t, s->inserts, s->duplicates, s->improvements, s->probes, s->cas_failures);
+        total.inserts += s->inserts;
+        total.duplicates += s->duplicates;
+        total.improvements += s->improvements;
+        total.probes += s->probes;
+        total.cas_failures += s->cas_failures;
+    }
+    printf("Closed set: keys=%lld/%llu (load %.2f), inserts=%lld, duplicates=%lld, avg probes=%.2f\n",
+           (long long) atomic_load(&set->count), set->capacity,
+           (double) atomic_load(&set->count) / (double) set->capacity,
+           total.inserts, total.duplicates,
+           (total.inserts + total.duplicates) ? (double) total.probes / (double) (total.inserts + total.duplicates) : 0.0);
+}
+
+#endif // CONCURRENT_SET_H
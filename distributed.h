@@ -0,0 +1,612 @@
+/**
+ * @file distributed.h
+ * @brief Message passing between cooperating planner processes.
+ *
+ * In distributed mode several `rover_planner` processes, on one machine or on
+ * several, search the same problem together. Every state has exactly one owner
+ * process, chosen by its hash, and only the owner checks it for duplicates,
+ * evaluates it and expands it. When a process generates a state owned by another
+ * one, it appends it to an outgoing batch for that process; full batches are
+ * framed into messages and exchanged over TCP or Unix domain sockets.
+ *
+ * A node travels as its g-value, the plan that reaches it (as compact actions)
+ * and its StateKey. The key is XORed with the key of the initial state and only
+ * the non-zero bytes are sent, together with the distance to the previous
+ * non-zero byte, which makes a typical state a few dozen bytes long.
+ *
+ * Termination of an unsuccessful search is detected with Safra's token algorithm:
+ * a token travels around the ring of processes, collecting the balance of sent
+ * and received node messages, and process 0 declares termination when the token
+ * comes back white with a zero balance while it is itself passive.
+ */
+
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "auxiliary.h"
+#include "statekey.h"
+
+#define DIST_MAX_PROCS       64     // Maximum number of cooperating processes.
+#define DIST_BATCH_BYTES     32768  // A batch is sent as soon as it reaches this size.
+#define DIST_FLUSH_INTERVAL  16     // Otherwise, all batches are sent after this many expansions.
+#define DIST_CONNECT_TIMEOUT 30     // Seconds to wait for the other processes to start.
+
+// Message types. Every message is framed as [type:1][payload length:4][payload].
+#define DIST_MSG_NODES    1   // A batch of nodes for the receiving process.
+#define DIST_MSG_TOKEN    2   // Safra's termination token.
+#define DIST_MSG_SOLUTION 3   // A plan found by a process, sent to process 0.
+#define DIST_MSG_STOP     4   // Sent by process 0: the search is over.
+
+#define DIST_HEADER 5
+
+/**
+ * @struct ByteBuffer
+ * @brief A growable byte array.
+ */
+typedef struct {
+    unsigned char *data;
+    size_t len;
+    size_t cap;
+} ByteBuffer;
+
+/**
+ * @struct DistPeer
+ * @brief The connection to another process and its buffers.
+ */
+typedef struct {
+    int fd;            // Connected socket (-1 for the process itself).
+    ByteBuffer out;    // Framed messages not yet written to the socket.
+    size_t out_off;    // Bytes of `out` already written.
+    ByteBuffer in;     // Received bytes not yet parsed into messages.
+    ByteBuffer batch;  // Encoded nodes waiting to be framed into a NODES message.
+    int batch_count;   // Number of nodes in `batch`.
+} DistPeer;
+
+/**
+ * @struct DistNode
+ * @brief A node received from another process.
+ */
+typedef struct {
+    StateKey key;          // The packed state.
+    int g;                 // Its cost from the initial state.
+    int path_len;          // Length of the plan reaching it.
+    CompactAction *path;   // The plan reaching it (malloc'ed).
+} DistNode;
+
+// --- Global Variables ---
+int dist_rank = 0;                   // Index of this process.
+int dist_procs = 1;                  // Number of processes (1 means distributed mode is off).
+char dist_spec[MAX_LINE] = "";       // Endpoints given with --peers.
+char dist_socket_path[MAX_LINE] = ""; // Unix socket path of this process (unlinked at exit).
+DistPeer dist_peers[DIST_MAX_PROCS]; // Connections, indexed by process.
+StateKey dist_base_key;              // Key of the initial state, used for delta encoding.
+
+DistNode *dist_inbox = NULL;         // Nodes received and not yet processed.
+int dist_inbox_len = 0, dist_inbox_cap = 0;
+
+int dist_stop = 0;                   // Set when process 0 has ended the search.
+CompactAction *dist_plan = NULL;     // Plan received by process 0.
+int dist_plan_len = -1;              // Its length (-1 while no plan has been found).
+
+// Safra's termination detection.
+long long dist_msg_balance = 0;      // NODES messages sent minus received.
+int dist_black = 0;                  // Set when a NODES message has been received since the token last left.
+int dist_has_token = 0;              // The token is held by this process.
+long long dist_token_count = 0;      // Balance accumulated in the token.
+int dist_token_black = 0;            // Colour of the token.
+int dist_token_out = 0;              // Process 0 only: a token round is in progress.
+
+// Statistics.
+long long dist_nodes_sent = 0, dist_nodes_received = 0;
+long long dist_messages_sent = 0, dist_bytes_sent = 0;
+
+/**
+ * @brief Makes sure a buffer can hold `extra` more bytes.
+ */
+void buffer_reserve(ByteBuffer *b, size_t extra) {
+    if (b->len + extra <= b->cap) return;
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + extra) cap *= 2;
+    b->data = (unsigned char*) realloc(b->data, cap);
+    if (b->data == NULL) {
+        printf("[ERROR] Memory allocation failed for a message buffer!\n");
+        exit(1);
+    }
+    b->cap = cap;
+}
+
+/**
+ * @brief Appends raw bytes to a buffer.
+ */
+void buffer_append(ByteBuffer *b, const void *bytes, size_t n) {
+    buffer_reserve(b, n);
+    memcpy(b->data + b->len, bytes, n);
+    b->len += n;
+}
+
+/**
+ * @brief Appends a variable-length integer to a buffer.
+ */
+void buffer_put_varint(ByteBuffer *b, unsigned long long v) {
+    buffer_reserve(b, 10);
+    b->len += put_varint(b->data + b->len, v);
+}
+
+/**
+ * @brief Writes as much of a peer's pending output as the socket accepts.
+ * @return 0 on success, -1 if the connection is broken.
+ */
+int dist_try_write(DistPeer *p) {
+    while (p->out_off < p->out.len) {
+        ssize_t n = send(p->fd, p->out.data + p->out_off, p->out.len - p->out_off, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p->out_off += (size_t) n;
+    }
+    p->out.len = 0;
+    p->out_off = 0;
+    return 0;
+}
+
+/**
+ * @brief Frames a message and queues it for a peer.
+ */
+void dist_send(int to, int type, const unsigned char *payload, size_t len) {
+    DistPeer *p = &dist_peers[to];
+    unsigned char header[DIST_HEADER];
+    header[0] = (unsigned char) type;
+    header[1] = (unsigned char) (len & 0xFF);
+    header[2] = (unsigned char) ((len >> 8) & 0xFF);
+    header[3] = (unsigned char) ((len >> 16) & 0xFF);
+    header[4] = (unsigned char) ((len >> 24) & 0xFF);
+    buffer_append(&p->out, header, DIST_HEADER);
+    if (len > 0) buffer_append(&p->out, payload, len);
+    dist_messages_sent++;
+    dist_bytes_sent += DIST_HEADER + len;
+    dist_try_write(p);
+}
+
+/**
+ * @brief Sends the pending batch of nodes for one peer as a NODES message.
+ */
+void dist_flush_batch(int to) {
+    DistPeer *p = &dist_peers[to];
+    if (p->batch_count == 0) return;
+
+    unsigned char count[10];
+    int n = put_varint(count, (unsigned long long) p->batch_count);
+    ByteBuffer payload = {0};
+    buffer_append(&payload, count, n);
+    buffer_append(&payload, p->batch.data, p->batch.len);
+    dist_send(to, DIST_MSG_NODES, payload.data, payload.len);
+    free(payload.data);
+
+    dist_msg_balance++;
+    p->batch.len = 0;
+    p->batch_count = 0;
+}
+
+/**
+ * @brief Sends the pending batches of all peers and writes out what the sockets accept.
+ */
+void dist_flush_all() {
+    for (int i = 0; i < dist_procs; i++) {
+        if (i == dist_rank) continue;
+        dist_flush_batch(i);
+        dist_try_write(&dist_peers[i]);
+    }
+}
+
+/**
+ * @brief Returns the process that owns a state.
+ */
+int dist_owner(unsigned long long hash) {
+    return (int) ((hash >> 32) % (unsigned long long) dist_procs);
+}
+
+/**
+ * @brief Encodes a node into the outgoing batch of its owner.
+ * @param to The owner process.
+ * @param key The node's packed state.
+ * @param g The node's g-value.
+ * @param path The plan reaching the node.
+ * @param path_len The length of the plan.
+ */
+void dist_queue_node(int to, const StateKey *key, int g, CompactAction *path, int path_len) {
+    DistPeer *p = &dist_peers[to];
+
+    buffer_put_varint(&p->batch, (unsigned long long) g);
+    buffer_put_varint(&p->batch, (unsigned long long) path_len);
+    for (int i = 0; i < path_len; i++) buffer_put_varint(&p->batch, path[i]);
+
+    // Delta against the initial state (see put_key_delta).
+    buffer_reserve(&p->batch, 11 * sizeof(StateKey) + 10);
+    p->batch.len += put_key_delta(p->batch.data + p->batch.len, key, &dist_base_key);
+
+    p->batch_count++;
+    dist_nodes_sent++;
+    if (p->batch.len >= DIST_BATCH_BYTES) dist_flush_batch(to);
+}
+
+/**
+ * @brief Decodes the nodes of a NODES message into the inbox.
+ * @return 0 on success, -1 if the message is malformed.
+ */
+int dist_decode_nodes(const unsigned char *buf, int len) {
+    unsigned long long count, v;
+    int pos = 0, n;
+
+    if ((n = get_varint(buf, len, &count)) == 0) return -1;
+    pos += n;
+
+    for (unsigned long long c = 0; c < count; c++) {
+        DistNode node;
+
+        if ((n = get_varint(buf + pos, len - pos, &v)) == 0) return -1;
+        pos += n;
+        node.g = (int) v;
+        if ((n = get_varint(buf + pos, len - pos, &v)) == 0) return -1;
+        pos += n;
+        node.path_len = (int) v;
+        node.path = (CompactAction*) malloc((node.path_len > 0 ? node.path_len : 1) * sizeof(CompactAction));
+        if (node.path == NULL) return -1;
+        for (int i = 0; i < node.path_len; i++) {
+            if ((n = get_varint(buf + pos, len - pos, &v)) == 0) return -1;
+            pos += n;
+            node.path[i] = (CompactAction) v;
+        }
+
+        if ((n = get_key_delta(buf + pos, len - pos, &node.key, &dist_base_key)) == 0) return -1;
+        pos += n;
+
+        if (dist_inbox_len == dist_inbox_cap) {
+            dist_inbox_cap = dist_inbox_cap ? 2 * dist_inbox_cap : 256;
+            dist_inbox = (DistNode*) realloc(dist_inbox, dist_inbox_cap * sizeof(DistNode));
+            if (dist_inbox == NULL) return -1;
+        }
+        dist_inbox[dist_inbox_len++] = node;
+        dist_nodes_received++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Handles one complete message.
+ */
+void dist_handle_message(int type, const unsigned char *payload, int len) {
+    unsigned long long v = 0;
+    int n, pos = 0;
+
+    switch (type) {
+        case DIST_MSG_NODES:
+            dist_msg_balance--;
+            dist_black = 1;
+            if (dist_decode_nodes(payload, len) < 0) {
+                printf("Malformed node message received. Search is terminated...\n");
+                exit(1);
+            }
+            break;
+        case DIST_MSG_TOKEN:
+            n = get_varint(payload, len, &v);
+            dist_token_count = zigzag_decode(v);
+            dist_token_black = (n < len) ? payload[n] : 1;
+            dist_has_token = 1;
+            break;
+        case DIST_MSG_SOLUTION:
+            if (dist_plan_len >= 0) break; // Keep only the first plan.
+            n = get_varint(payload, len, &v);
+            pos = n;
+            dist_plan_len = (int) v;
+            dist_plan = (CompactAction*) malloc((dist_plan_len > 0 ? dist_plan_len : 1) * sizeof(CompactAction));
+            for (int i = 0; i < dist_plan_len; i++) {
+                pos += get_varint(payload + pos, len - pos, &v);
+                dist_plan[i] = (CompactAction) v;
+            }
+            break;
+        default: // DIST_MSG_STOP
+            dist_stop = 1;
+            break;
+    }
+}
+
+/**
+ * @brief Reads from all sockets and handles every complete message.
+ * @param timeout_ms How long to wait for data when none is available.
+ */
+void dist_poll(int timeout_ms) {
+    struct pollfd fds[DIST_MAX_PROCS];
+    int peer_of[DIST_MAX_PROCS];
+    int count = 0;
+
+    for (int i = 0; i < dist_procs; i++) {
+        if (i == dist_rank || dist_peers[i].fd < 0) continue;
+        fds[count].fd = dist_peers[i].fd;
+        fds[count].events = POLLIN | (dist_peers[i].out.len > dist_peers[i].out_off ? POLLOUT : 0);
+        fds[count].revents = 0;
+        peer_of[count++] = i;
+    }
+    if (count == 0 || poll(fds, count, timeout_ms) <= 0) return;
+
+    for (int k = 0; k < count; k++) {
+        DistPeer *p = &dist_peers[peer_of[k]];
+        if (fds[k].revents & POLLOUT) dist_try_write(p);
+        if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+        unsigned char chunk[65536];
+        ssize_t n;
+        while ((n = recv(p->fd, chunk, sizeof(chunk), 0)) > 0) buffer_append(&p->in, chunk, (size_t) n);
+        if (n == 0) {
+            // A peer went away: nothing more can be done together.
+            close(p->fd);
+            p->fd = -1;
+            dist_stop = 1;
+        }
+
+        size_t off = 0;
+        while (p->in.len - off >= DIST_HEADER) {
+            const unsigned char *h = p->in.data + off;
+            size_t len = (size_t) h[1] | ((size_t) h[2] << 8) | ((size_t) h[3] << 16) | ((size_t) h[4] << 24);
+            if (p->in.len - off < DIST_HEADER + len) break;
+            dist_handle_message(h[0], h + DIST_HEADER, (int) len);
+            off += DIST_HEADER + len;
+        }
+        if (off > 0) {
+            memmove(p->in.data, p->in.data + off, p->in.len - off);
+            p->in.len -= off;
+        }
+    }
+}
+
+/**
+ * @brief Sends the termination token to the next process of the ring.
+ */
+void dist_pass_token(long long count, int black) {
+    unsigned char payload[11];
+    int n = put_varint(payload, zigzag_encode(count));
+    payload[n++] = (unsigned char) black;
+    dist_has_token = 0;
+    dist_send((dist_rank + 1) % dist_procs, DIST_MSG_TOKEN, payload, n);
+}
+
+/**
+ * @brief Runs Safra's termination detection while this process is passive.
+ *
+ * Must only be called when the local frontier and inbox are empty and all
+ * batches have been flushed.
+ * @return 1 if process 0 has detected global termination, 0 otherwise.
+ */
+int dist_passive() {
+    if (dist_rank == 0) {
+        if (!dist_token_out) {
+            // Start a new round.
+            dist_black = 0;
+            dist_token_out = 1;
+            dist_pass_token(0, 0);
+            return 0;
+        }
+        if (!dist_has_token) return 0;
+        dist_token_out = 0;
+        dist_has_token = 0;
+        if (!dist_token_black && !dist_black && dist_token_count + dist_msg_balance == 0) return 1;
+        return 0; // Unsuccessful round; a new one starts on the next call.
+    }
+
+    if (dist_has_token) {
+        dist_pass_token(dist_token_count + dist_msg_balance, dist_token_black || dist_black);
+        dist_black = 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Sends the STOP message to all other processes and waits until it is written.
+ */
+void dist_broadcast_stop() {
+    for (int i = 0; i < dist_procs; i++) {
+        if (i == dist_rank || dist_peers[i].fd < 0) continue;
+        dist_send(i, DIST_MSG_STOP, NULL, 0);
+        int flags = fcntl(dist_peers[i].fd, F_GETFL, 0);
+        fcntl(dist_peers[i].fd, F_SETFL, flags & ~O_NONBLOCK);
+        dist_try_write(&dist_peers[i]);
+    }
+    dist_stop = 1;
+}
+
+/**
+ * @brief Reports a plan found by this process.
+ *
+ * Process 0 keeps it directly; any other process sends it to process 0.
+ */
+void dist_report_plan(CompactAction *path, int path_len) {
+    if (dist_rank == 0) {
+        if (dist_plan_len >= 0) return;
+        dist_plan = (CompactAction*) malloc((path_len > 0 ? path_len : 1) * sizeof(CompactAction));
+        memcpy(dist_plan, path, path_len * sizeof(CompactAction));
+        dist_plan_len = path_len;
+        return;
+    }
+
+    ByteBuffer payload = {0};
+    buffer_put_varint(&payload, (unsigned long long) path_len);
+    for (int i = 0; i < path_len; i++) buffer_put_varint(&payload, path[i]);
+    dist_send(0, DIST_MSG_SOLUTION, payload.data, payload.len);
+    free(payload.data);
+}
+
+/**
+ * @brief Fills in the socket address of a process from the --peers specification.
+ *
+ * Accepted forms are `unix:<prefix>` (process i uses the socket `<prefix>.<i>`),
+ * `tcp:<host>:<port>` (process i uses port `<port>+i` on one host) and
+ * `tcp:<host0>:<port0>,<host1>:<port1>,...` (one endpoint per process).
+ * @return The socket family, or -1 if the specification is invalid or a socket path is too long.
+ */
+int dist_endpoint(int rank, struct sockaddr_storage *addr, socklen_t *addr_len) {
+    memset(addr, 0, sizeof(*addr));
+
+    if (strncmp(dist_spec, "unix:", 5) == 0) {
+        struct sockaddr_un *un = (struct sockaddr_un*) addr;
+        un->sun_family = AF_UNIX;
+        // A truncated path could name the socket of another process, so it is rejected.
+        char path[MAX_LINE + 16];
+        int len = snprintf(path, sizeof(path), "%s.%d", dist_spec + 5, rank);
+        if (len < 0 || len >= (int) sizeof(un->sun_path)) {
+            printf("The socket path %s is longer than %d characters.\n", path, (int) sizeof(un->sun_path) - 1);
+            return -1;
+        }
+        memcpy(un->sun_path, path, len + 1);
+        *addr_len = sizeof(struct sockaddr_un);
+        return AF_UNIX;
+    }
+
+    if (strncmp(dist_spec, "tcp:", 4) == 0) {
+        char list[MAX_LINE], host[MAX_LINE];
+        int port = -1, index = 0, single = (strchr(dist_spec, ',') == NULL);
+        strcpy(list, dist_spec + 4);
+        for (char *item = strtok(list, ","); item != NULL; item = strtok(NULL, ","), index++) {
+            char *colon = strrchr(item, ':');
+            if (colon == NULL) return -1;
+            if (single || index == rank) {
+                *colon = '\0';
+                strcpy(host, item);
+                port = atoi(colon + 1) + (single ? rank : 0);
+                break;
+            }
+        }
+        if (port < 0) return -1;
+
+        struct addrinfo hints, *res;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host, NULL, &hints, &res) != 0) return -1;
+        memcpy(addr, res->ai_addr, res->ai_addrlen);
+        ((struct sockaddr_in*) addr)->sin_port = htons((unsigned short) port);
+        *addr_len = res->ai_addrlen;
+        freeaddrinfo(res);
+        return AF_INET;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Connects this process with all the others (a full mesh).
+ *
+ * Every process listens on its own endpoint, connects to all processes with a
+ * lower index and accepts connections from all processes with a higher index.
+ * The first four bytes sent on a new connection identify the connecting process.
+ * @param base_state The initial state, whose key is the base of the delta encoding.
+ * @return 0 on success, -1 on failure.
+ */
+int dist_setup(State *base_state) {
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    int family, one = 1;
+
+    make_state_key(base_state, &dist_base_key);
+    for (int i = 0; i < dist_procs; i++) {
+        memset(&dist_peers[i], 0, sizeof(DistPeer));
+        dist_peers[i].fd = -1;
+    }
+
+    // Listen on our own endpoint.
+    for (int i = 0; i < dist_procs; i++) {
+        if (dist_endpoint(i, &addr, &addr_len) < 0) {
+            printf("Invalid --peers specification: %s\n", dist_spec);
+            return -1;
+        }
+    }
+    family = dist_endpoint(dist_rank, &addr, &addr_len);
+    int listener = socket(family, SOCK_STREAM, 0);
+    if (listener < 0) return -1;
+    if (family == AF_UNIX) {
+        strcpy(dist_socket_path, ((struct sockaddr_un*) &addr)->sun_path);
+        unlink(dist_socket_path);
+    }
+    else setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(listener, (struct sockaddr*) &addr, addr_len) < 0 || listen(listener, DIST_MAX_PROCS) < 0) {
+        printf("Cannot listen on the endpoint of process %d: %s\n", dist_rank, strerror(errno));
+        close(listener);
+        return -1;
+    }
+
+    // Connect to the processes with a lower index, retrying while they start up.
+    for (int i = 0; i < dist_rank; i++) {
+        time_t start = time(NULL);
+        dist_endpoint(i, &addr, &addr_len);
+        while (1) {
+            int fd = socket(family, SOCK_STREAM, 0);
+            if (fd >= 0 && connect(fd, (struct sockaddr*) &addr, addr_len) == 0) {
+                int rank = dist_rank;
+                if (send(fd, &rank, sizeof(rank), MSG_NOSIGNAL) != sizeof(rank)) {
+                    close(fd);
+                    return -1;
+                }
+                dist_peers[i].fd = fd;
+                break;
+            }
+            if (fd >= 0) close(fd);
+            if (difftime(time(NULL), start) > DIST_CONNECT_TIMEOUT) {
+                printf("Cannot connect to process %d.\n", i);
+                close(listener);
+                return -1;
+            }
+            usleep(100000);
+        }
+    }
+
+    // Accept the processes with a higher index.
+    for (int accepted = dist_rank + 1; accepted < dist_procs; accepted++) {
+        int fd = accept(listener, NULL, NULL);
+        int rank;
+        if (fd < 0 || recv(fd, &rank, sizeof(rank), MSG_WAITALL) != sizeof(rank) ||
+            rank <= dist_rank || rank >= dist_procs || dist_peers[rank].fd >= 0) {
+            printf("Unexpected connection while setting up the processes.\n");
+            close(listener);
+            return -1;
+        }
+        dist_peers[rank].fd = fd;
+    }
+    close(listener);
+
+    for (int i = 0; i < dist_procs; i++) {
+        int fd = dist_peers[i].fd;
+        if (fd < 0) continue;
+        if (family == AF_INET) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+    return 0;
+}
+
+/**
+ * @brief Closes all connections and removes this process's Unix socket.
+ */
+void dist_finish() {
+    for (int i = 0; i < dist_procs; i++) {
+        if (dist_peers[i].fd >= 0) close(dist_peers[i].fd);
+        free(dist_peers[i].out.data);
+        free(dist_peers[i].in.data);
+        free(dist_peers[i].batch.data);
+    }
+    if (dist_socket_path[0] != '\0') unlink(dist_socket_path);
+}
+
+#endif // DISTRIBUTED_H
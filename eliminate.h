@@ -0,0 +1,170 @@
+/**
+ * @file eliminate.h
+ * @brief Action elimination over a found plan (--eliminate).
+ *
+ * Every action of the plan is removed in turn, together with the later actions
+ * that are no longer applicable without it: a navigation away from a waypoint
+ * the rover never reached, an image with a camera that was never calibrated, a
+ * recharge of a rover that has enough energy left. If the rest of the plan still
+ * reaches the goal, the removal is kept. This drops calibrations that are never
+ * used, navigation loops, drops of empty stores and recharges that are not
+ * needed.
+ *
+ * The state before every action of the plan is kept as a StateKey, so the plan
+ * is only simulated from the removed action on. The simulation stops early
+ * - with success, once its state matches the state the plan had at the same
+ *   action, up to the energy saved (the rest of the plan is then unchanged),
+ *   unless a rover with more energy than before still has a recharge ahead, and
+ * - with failure, once a communication is dropped: the plan never
+ *   communicates the same data twice, so its goal can no longer be reached.
+ * On most plans both happen within a few actions, and the pass takes time
+ * close to linear in the length of the plan.
+ */
+
+#ifndef ELIMINATE_H
+#define ELIMINATE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "auxiliary.h"
+#include "statekey.h"
+#include "solution.h"
+
+int eliminate = 0; // Remove redundant actions from the plan found (--eliminate).
+
+/**
+ * @brief Replays a plan from an action on and records the state before every action.
+ * @param codes The plan.
+ * @param length The number of actions.
+ * @param from The first action to replay; keys[from] must be set.
+ * @param init The initial state (template of the unpacked states).
+ * @param keys Output: the state before every action, and after the last (length + 1 entries).
+ * @param recharge_ahead Output: for every action, the rovers that recharge at or after it (bitmap).
+ */
+void eliminate_replay(CompactAction *codes, int length, int from, State *init, StateKey *keys, unsigned int *recharge_ahead) {
+    static State current, next;
+    int params[5], energy_spent;
+
+    unpack_state_key(&keys[from], init, &current);
+    for (int i = from; i < length; i++) {
+        int action_type = compact_action_unpack(codes[i], params);
+        apply_action(&current, action_type, params, &next, &energy_spent);
+        current = next;
+        make_state_key(&current, &keys[i + 1]);
+    }
+
+    recharge_ahead[length] = 0;
+    for (int i = length - 1; i >= 0; i--) {
+        int action_type = compact_action_unpack(codes[i], params);
+        recharge_ahead[i] = recharge_ahead[i + 1] | (action_type == 1 ? 1u << params[0] : 0);
+    }
+}
+
+/**
+ * @brief Compares a state of the shortened plan with the state of the plan at the same action.
+ * @param key The state of the shortened plan.
+ * @param original The state of the plan.
+ * @param surplus Output: the rovers that have more energy in key (bitmap).
+ * @return 1 if key equals original up to more energy and the recharge count, 0 otherwise.
+ */
+int eliminate_converged(const StateKey *key, const StateKey *original, unsigned int *surplus) {
+    StateKey a = *key, b = *original;
+
+    *surplus = 0;
+    for (int r = 0; r < num_rovers; r++) {
+        if (a.energy_levels[r] < b.energy_levels[r]) return 0;
+        if (a.energy_levels[r] > b.energy_levels[r]) *surplus |= 1u << r;
+        a.energy_levels[r] = b.energy_levels[r] = 0;
+    }
+    a.recharges = b.recharges = 0;
+    return memcmp(&a, &b, sizeof(StateKey)) == 0;
+}
+
+/**
+ * @brief Tries to remove an action and the actions that depend on it (see the file comment).
+ * @param init The initial state.
+ * @param codes The plan; shortened in place on success.
+ * @param length In/out: the number of actions.
+ * @param removed The action to remove.
+ * @param keys The state before every action (see eliminate_replay).
+ * @param recharge_ahead The rovers that recharge at or after every action.
+ * @param kept Scratch space for length actions.
+ * @return 1 if the actions were removed, 0 otherwise.
+ */
+int eliminate_try(State *init, CompactAction *codes, int *length, int removed, StateKey *keys,
+                  unsigned int *recharge_ahead, CompactAction *kept) {
+    static State current, next;
+    StateKey key;
+    unsigned int surplus;
+    int params[5], energy_spent, count = 0, rest = *length;
+
+    unpack_state_key(&keys[removed], init, &current);
+    for (int i = removed + 1; i < *length; i++) {
+        make_state_key(&current, &key);
+        if (eliminate_converged(&key, &keys[i], &surplus) && !(surplus & recharge_ahead[i])) {
+            rest = i;
+            break;
+        }
+
+        int action_type = compact_action_unpack(codes[i], params);
+        if (apply_action(&current, action_type, params, &next, &energy_spent)) {
+            kept[count++] = codes[i];
+            current = next;
+        }
+        else if (action_type >= 7) return 0;
+    }
+    if (rest == *length && !is_goal_state(&current)) return 0;
+
+    memmove(codes + removed + count, codes + rest, (*length - rest) * sizeof(CompactAction));
+    memcpy(codes + removed, kept, count * sizeof(CompactAction));
+    *length = removed + count + (*length - rest);
+    return 1;
+}
+
+/**
+ * @brief Removes redundant actions from the plan in `solution` (see the file comment).
+ * @param init The initial state.
+ * @return 0 on success, -1 if memory is exhausted.
+ */
+int eliminate_plan(State *init) {
+    int length = solution_length, energy = total_energy;
+    clock_t started = clock();
+
+    CompactAction *codes = (CompactAction*) malloc((length + 1) * sizeof(CompactAction));
+    CompactAction *kept = (CompactAction*) malloc((length + 1) * sizeof(CompactAction));
+    StateKey *keys = (StateKey*) malloc((length + 1) * sizeof(StateKey));
+    unsigned int *recharge_ahead = (unsigned int*) malloc((length + 1) * sizeof(unsigned int));
+    if (codes == NULL || kept == NULL || keys == NULL || recharge_ahead == NULL) {
+        printf("Memory allocation for the action elimination failed!\n");
+        free(codes); free(kept); free(keys); free(recharge_ahead);
+        return -1;
+    }
+    for (int i = 0; i < length; i++) codes[i] = solution[i].code;
+
+    make_state_key(init, &keys[0]);
+    eliminate_replay(codes, length, 0, init, keys, recharge_ahead);
+
+    // After a removal, the action that took its place is tried next.
+    for (int i = 0; i < length; ) {
+        if (eliminate_try(init, codes, &length, i, keys, recharge_ahead, kept))
+            eliminate_replay(codes, length, i, init, keys, recharge_ahead);
+        else
+            i++;
+    }
+
+    int removed = solution_length - length;
+    if (removed > 0) {
+        free(solution);
+        solution_from_codes(init, codes, length);
+    }
+    printf("Action elimination: removed %d of %d actions, energy %d -> %d, %.2f secs\n", removed, length + removed,
+           energy, total_energy, (double) (clock() - started) / CLOCKS_PER_SEC);
+
+    free(codes); free(kept); free(keys); free(recharge_ahead);
+    return 0;
+}
+
+#endif // ELIMINATE_H
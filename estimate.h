@@ -0,0 +1,177 @@
+/**
+ * @file estimate.h
+ * @brief Online estimate of the remaining effort of the A* search (--estimate, --predict-abort).
+ *
+ * Two predictions of the remaining extractions are made:
+ *  - h velocity: the lowest h extracted so far fell from the h of the root at
+ *    some rate per extraction, and the search ends once it reaches 0. This
+ *    needs no f-layers, so it also works when an inconsistent heuristic keeps
+ *    f from rising, but it ignores that A* slows down as its layers grow.
+ *  - f-layers: A* extracts its nodes in layers of equal f, and the number of
+ *    extractions per layer grows roughly geometrically, so the growth of the
+ *    last few layers predicts the size of the next ones. How many layers are
+ *    left is predicted from the rate at which the lowest h fell per layer.
+ *    Compounded over many layers, a small error in the growth or in the number
+ *    of layers grows into orders of magnitude.
+ * The remaining time is the extractions times the time per extraction so far.
+ *
+ * Every estimate_interval seconds the estimates are printed. With --predict-abort,
+ * the search is only given up when even the lower of the two predictions has
+ * exceeded the time left before TIMEOUT at ESTIMATE_STABLE checks in a row,
+ * without falling much in between; it then ends (stop) or turns into a Greedy
+ * Best-First Search on the same frontier (best), which finds some plan much sooner.
+ */
+
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#define ESTIMATE_INTERVAL 10   // Default seconds between two estimates.
+#define ESTIMATE_LAYERS 4      // Finished layers the growth rate is averaged over.
+#define ESTIMATE_STABLE 3      // Checks in a row a prediction must exceed the time left before it ends the search.
+#define ESTIMATE_DROP 0.8      // A predicted total below this share of the previous one is not stable.
+
+#define PREDICT_NONE 0  // Only report the estimates.
+#define PREDICT_STOP 1  // End the search when it cannot finish in time.
+#define PREDICT_BEST 2  // Switch to Greedy Best-First Search when it cannot finish in time.
+
+int estimate_interval = 0;        // Seconds between two estimates (--estimate; 0: none).
+int predict_abort = PREDICT_NONE; // What to do when the search cannot finish in time (--predict-abort).
+
+/**
+ * @struct EffortEstimate
+ * @brief The progress of the A* search so far.
+ */
+typedef struct {
+    int started;                              // Set once the first node was extracted.
+    int root_f, root_h;                       // f and h of the first extracted node.
+    int f;                                    // f of the current layer.
+    int min_h;                                // Lowest h extracted so far.
+    int layers;                               // Finished layers.
+    long long layer_size;                     // Extractions of the current layer.
+    long long last_sizes[ESTIMATE_LAYERS];    // Extractions of the last finished layers (ring).
+    long long extracts;                       // All extractions.
+    clock_t started_at;                       // CPU time of the first extraction.
+    time_t last_report;                       // Time of the last estimate.
+    int over;                                 // Checks in a row whose prediction exceeded the time left.
+    double last_total;                        // Predicted total extractions at the last check.
+} EffortEstimate;
+
+EffortEstimate effort;
+
+/**
+ * @brief Records an extracted node.
+ * @param f The f-value of the node.
+ * @param h The h-value of the node.
+ */
+void estimate_record(int f, int h) {
+    EffortEstimate *e = &effort;
+
+    if (!e->started) {
+        e->started = 1;
+        e->root_f = e->f = f;
+        e->root_h = e->min_h = h;
+        e->started_at = clock();
+        e->last_report = time(NULL);
+    }
+    if (f > e->f) {
+        e->last_sizes[e->layers % ESTIMATE_LAYERS] = e->layer_size;
+        e->layers++;
+        e->layer_size = 0;
+        e->f = f;
+    }
+    if (h < e->min_h) e->min_h = h;
+    e->layer_size++;
+    e->extracts++;
+}
+
+/**
+ * @brief Predicts the remaining extractions from the rate at which the lowest h fell (see the file comment).
+ * @return The remaining extractions, or -1 if h has not fallen yet.
+ */
+double estimate_velocity() {
+    EffortEstimate *e = &effort;
+
+    if (e->min_h >= e->root_h) return -1;
+    return (double) e->extracts * e->min_h / (e->root_h - e->min_h);
+}
+
+/**
+ * @brief Predicts the remaining extractions from the growth of the f-layers (see the file comment).
+ * @param growth Output: the growth rate of the layers.
+ * @param layers_left Output: the layers after the current one.
+ * @return The remaining extractions, or -1 if no layer is finished or h has not fallen yet.
+ */
+double estimate_layers(double *growth, double *layers_left) {
+    EffortEstimate *e = &effort;
+    int count = e->layers < ESTIMATE_LAYERS ? e->layers : ESTIMATE_LAYERS;
+
+    if (count == 0 || e->min_h >= e->root_h) return -1;
+
+    // Geometric mean of the growth between the last finished layers.
+    long long last = e->last_sizes[(e->layers - 1) % ESTIMATE_LAYERS];
+    long long first = e->last_sizes[(e->layers - count) % ESTIMATE_LAYERS];
+    *growth = count > 1 ? pow((double) last / first, 1.0 / (count - 1)) : 1.0;
+    if (*growth < 1.0) *growth = 1.0;
+    // A current layer that has outgrown the prediction raises it.
+    if (e->layer_size > last * *growth) *growth = (double) e->layer_size / last;
+
+    // h fell by (root_h - min_h) over the layers so far, the current one included.
+    double rate = (double) (e->root_h - e->min_h) / (e->layers + 1);
+    *layers_left = e->min_h / rate;
+
+    // The rest of the current layer, then the layers left.
+    double size = last * *growth;
+    double extracts = size > e->layer_size ? size - e->layer_size : 0;
+    for (int k = 0; k < (int) ceil(*layers_left) && extracts < 1e15; k++) {
+        size *= *growth;
+        extracts += size;
+    }
+    return extracts;
+}
+
+/**
+ * @brief Prints the estimate if one is due and checks it against the time left.
+ *
+ * Called between two node expansions of the A* search.
+ * @param secs_left The time left before the search times out.
+ * @return 1 if the search cannot finish in time (only with --predict-abort), 0 otherwise.
+ */
+int estimate_check(double secs_left) {
+    EffortEstimate *e = &effort;
+    double growth, layers_left;
+
+    if (!e->started || difftime(time(NULL), e->last_report) < estimate_interval) return 0;
+    e->last_report = time(NULL);
+
+    double velocity = estimate_velocity();
+    if (velocity < 0) {
+        printf("Estimate: f=%d, %d layers, %lld extracts, min h %d; no prediction yet\n",
+               e->f, e->layers, e->extracts, e->min_h);
+        return 0;
+    }
+    double per_extract = (double) (clock() - e->started_at) / CLOCKS_PER_SEC / e->extracts;
+    double layered = estimate_layers(&growth, &layers_left);
+    printf("Estimate: f=%d, %d layers, %lld extracts, min h %d; ~%.3g extracts, ~%.0f secs left by h velocity",
+           e->f, e->layers, e->extracts, e->min_h, velocity, velocity * per_extract);
+    if (layered >= 0)
+        printf(", ~%.3g extracts, ~%.0f secs left by %.0f more layers (growth %.2f)\n",
+               layered, layered * per_extract, ceil(layers_left), growth);
+    else
+        printf(", no finished f-layer\n");
+    fflush(stdout);
+
+    // Only the lower prediction counts, and only once it is stable.
+    double least = layered >= 0 && layered < velocity ? layered : velocity;
+    double total = e->extracts + least;
+    if (least * per_extract > secs_left && total >= ESTIMATE_DROP * e->last_total) e->over++;
+    else e->over = 0;
+    e->last_total = total;
+
+    return predict_abort != PREDICT_NONE && e->over >= ESTIMATE_STABLE;
+}
+
+#endif // ESTIMATE_H
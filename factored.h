@@ -0,0 +1,215 @@
+/**
+ * @file factored.h
+ * @brief Goal assignment for the factored per-rover search (factored).
+ *
+ * The rovers only interact through the samples at the waypoints and the channel
+ * to the lander, and apply_action only lets a rover sample, photograph or
+ * communicate for a goal of the problem. So once every goal belongs to a single
+ * rover, the rovers can plan on their own: the subproblem of a rover is the
+ * initial state with all other rovers unavailable, and its goal is the set of
+ * goals assigned to it. Such a state space only holds the moves of one rover and
+ * is searched in its own thread (see factored_search in planner.c); the plans
+ * are then interleaved (merge_rover_plans), since no action of one rover can
+ * take away a sample or a goal that another rover's plan relies on.
+ *
+ * Every goal is first given to the rover with the lowest cost for it at the
+ * initial state (rover_goal_costs), as long as the rover has fewer than twice its
+ * share of the goals: the search of a subproblem grows quickly with its number of
+ * goals. When the subproblem of a rover cannot be solved, e.g. because the rover
+ * does not have the energy for all of its goals or the search takes too long,
+ * the rover refuses the more expensive half of its goals, each of which goes to
+ * the cheapest rover that has not refused it yet, and the changed subproblems
+ * are solved again. A rover whose goals no other rover can take searches again
+ * with FACTORED_GROWTH times the extractions, up to FACTORED_MAX_EXTRACTS and as
+ * long as the trees of the searches fit in memory; when that fails as well, the
+ * whole problem is searched jointly (factored_search).
+ */
+
+#ifndef FACTORED_H
+#define FACTORED_H
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "auxiliary.h"
+#include "heuristic.h"
+#include "hcache.h"
+#include "agenda.h"
+
+#define FACTORED_EXTRACTS 5000  // Extractions a rover's subproblem may take before it counts as failed.
+#define FACTORED_GROWTH 4       // Factor of the extractions of a rover that searches again.
+#define FACTORED_MAX_EXTRACTS 80000 // Extractions beyond which a rover's subproblem is not searched again.
+#define FACTORED_MEMORY_SHARE 2 // The trees of the rovers' searches together take at most 1/this of the memory.
+
+/**
+ * @struct RoverTask
+ * @brief The subproblem of one rover in the factored search.
+ */
+typedef struct {
+    int rover;              // The rover.
+    Goal goal;              // The goals assigned to the rover.
+    int goals;              // Number of goals assigned to the rover.
+    int dirty;              // Set when the goals changed since the last search.
+    int limit;              // Extractions the search may take.
+    pthread_t thread;       // The thread searching the subproblem.
+    CompactAction *plan;    // The rover's plan (NULL if none was found).
+    int plan_len;           // Number of actions of the plan.
+    int energy;             // Energy spent by the plan.
+    int inserts, extracts;  // Copies of the thread-local heap statistics at exit.
+    HCacheStats h_stats;    // Copy of the thread-local heuristic cache statistics at exit.
+} RoverTask;
+
+RoverTask rover_tasks[MAX_ROVERS];           // One subproblem per rover.
+int goal_rover[GOAL_SLOTS];                  // Rover a goal is assigned to (-1: none).
+unsigned int goal_refused[GOAL_SLOTS];       // Rovers whose subproblem failed with the goal (bitmap).
+int goal_cost[MAX_ROVERS][GOAL_SLOTS];       // Cost of every goal for every rover at the initial state.
+int goal_share;                              // Goals a rover takes before the cheapest rover is passed over.
+
+/**
+ * @brief Gives a goal to the cheapest rover that has not refused it.
+ *
+ * Rovers that hold goal_share goals already are only taken when no other rover
+ * can achieve the goal. Among rovers with the same cost, the one with fewer goals
+ * gets it.
+ * @param slot The goal slot.
+ * @return The rover, or -1 if no rover is left that can achieve the goal.
+ */
+int assign_goal(int slot) {
+    int best_rover = -1, best_full = 1;
+    for (int r = 0; r < num_rovers; r++) {
+        if ((goal_refused[slot] & (1u << r)) || goal_cost[r][slot] == INT_MAX) continue;
+        int full = rover_tasks[r].goals >= goal_share;
+        if (best_rover < 0 || full < best_full
+            || (full == best_full && (goal_cost[r][slot] < goal_cost[best_rover][slot]
+                || (goal_cost[r][slot] == goal_cost[best_rover][slot] && rover_tasks[r].goals < rover_tasks[best_rover].goals)))) {
+            best_rover = r;
+            best_full = full;
+        }
+    }
+    goal_rover[slot] = best_rover;
+    if (best_rover < 0) return -1;
+
+    *goal_slot(&rover_tasks[best_rover].goal, slot) = 1;
+    rover_tasks[best_rover].goals++;
+    rover_tasks[best_rover].dirty = 1;
+    return best_rover;
+}
+
+/**
+ * @brief Computes the goal costs at the initial state and assigns every open goal.
+ * @param init The initial state.
+ * @return 0 on success, -1 if some goal cannot be achieved by any rover.
+ */
+int factored_assign(State *init) {
+    int row[ROW_CACHE_GOALS], open = 0, able = 0;
+
+    memset(rover_tasks, 0, sizeof(rover_tasks));
+    memset(goal_refused, 0, sizeof(goal_refused));
+    for (int r = 0; r < num_rovers; r++) {
+        rover_tasks[r].rover = r;
+        rover_tasks[r].limit = FACTORED_EXTRACTS;
+
+        // The row only has entries for the goals of the problem, in slot order.
+        rover_goal_costs(init, r, row);
+        int useful = 0;
+        for (int slot = 0, i = 0; slot < GOAL_SLOTS; slot++) {
+            goal_cost[r][slot] = *goal_slot(&goal, slot) ? row[i++] : INT_MAX;
+            if (goal_cost[r][slot] != INT_MAX) useful = 1;
+        }
+        able += useful;
+    }
+
+    for (int slot = 0; slot < GOAL_SLOTS; slot++) open += *goal_slot(&goal, slot) && !goal_slot_achieved(init, slot);
+    goal_share = able > 0 ? 2 * ((open + able - 1) / able) : open;
+
+    for (int slot = 0; slot < GOAL_SLOTS; slot++) {
+        goal_rover[slot] = -1;
+        if (!*goal_slot(&goal, slot) || goal_slot_achieved(init, slot)) continue;
+        if (assign_goal(slot) < 0) return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Checks if a goal can still go to a rover other than the one it is assigned to.
+ */
+int goal_movable(int slot) {
+    for (int r = 0; r < num_rovers; r++) {
+        if (r != goal_rover[slot] && !(goal_refused[slot] & (1u << r)) && goal_cost[r][slot] != INT_MAX) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the memory the process may use: the physical memory, or the address space limit if lower.
+ */
+unsigned long long factored_memory() {
+    long pages = sysconf(_SC_PHYS_PAGES), page_size = sysconf(_SC_PAGE_SIZE);
+    unsigned long long bytes = pages > 0 && page_size > 0 ? (unsigned long long) pages * page_size : 1ULL << 32;
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_AS, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < bytes)
+        bytes = limit.rlim_cur;
+    return bytes;
+}
+
+/**
+ * @brief Lets a rover whose search ran out of extractions search its goals again with more.
+ *
+ * A search keeps every node it inserts, so the tree of the new search is
+ * estimated from the inserts per extraction of the failed one. The searches of
+ * all rovers with goals may run at once; each gets an equal part of
+ * 1/FACTORED_MEMORY_SHARE of the memory, and the extractions are capped to fit.
+ * A search that could not even take twice the extractions is not worth repeating.
+ * @param t The failed subproblem.
+ * @return 0 on success, -1 if the search did not run out of extractions or may not take more.
+ */
+int factored_retry(RoverTask *t) {
+    if (t->extracts <= t->limit || t->limit >= FACTORED_MAX_EXTRACTS) return -1;
+
+    int busy = 0;
+    for (int r = 0; r < num_rovers; r++) busy += rover_tasks[r].goals > 0;
+    double node_bytes = (double) sizeof(struct tree_node) * t->inserts / t->extracts;
+    double fit = (double) factored_memory() / FACTORED_MEMORY_SHARE / (busy > 0 ? busy : 1) / node_bytes;
+
+    int limit = t->limit * FACTORED_GROWTH;
+    if (limit > FACTORED_MAX_EXTRACTS) limit = FACTORED_MAX_EXTRACTS;
+    if (limit > fit) limit = (int) fit;
+    if (limit < 2 * t->limit) return -1;
+    t->limit = limit;
+    t->dirty = 1;
+    return 0;
+}
+
+/**
+ * @brief Moves the more expensive half of the goals of a rover whose subproblem failed to other rovers.
+ *
+ * Goals that no other rover can achieve stay where they are; at least one goal
+ * is moved.
+ * @param t The failed subproblem.
+ * @return 0 on success, -1 if none of the rover's goals can be given to another rover.
+ */
+int factored_reassign(RoverTask *t) {
+    int moves = t->goals / 2 > 0 ? t->goals / 2 : 1, moved = 0;
+
+    while (moved < moves) {
+        int worst = -1;
+        for (int slot = 0; slot < GOAL_SLOTS; slot++) {
+            if (goal_rover[slot] != t->rover || !goal_movable(slot)) continue;
+            if (worst < 0 || goal_cost[t->rover][slot] > goal_cost[t->rover][worst]) worst = slot;
+        }
+        if (worst < 0) break;
+
+        *goal_slot(&t->goal, worst) = 0;
+        t->goals--;
+        t->dirty = 1;
+        goal_refused[worst] |= 1u << t->rover;
+        if (assign_goal(worst) < 0) return -1;
+        moved++;
+    }
+    return moved > 0 ? 0 : -1;
+}
+
+#endif // FACTORED_H
@@ -0,0 +1,210 @@
+/**
+ * @file hcache.h
+ * @brief Caches of heuristic results.
+ *
+ * The closed set keeps exact duplicates from being evaluated twice, but the
+ * heuristic ignores the recharge counter, which is part of the StateKey, so
+ * states that differ only in how often a rover recharged are evaluated again
+ * and again. Most children also differ from their parent in a single rover,
+ * while H4 recomputes the goal costs of every rover.
+ *
+ * This file provides two bounded, direct-mapped caches, one per thread:
+ *  - the h cache maps the hash of a StateKey (with the recharge counter cleared)
+ *    to the heuristic value;
+ *  - the row cache maps one rover's situation (RowKey) to its row of goal costs,
+ *    as computed by calculate_all_goal_costs.
+ * A new entry simply replaces the one stored in its slot. Hits and lookups are
+ * counted for the statistics.
+ */
+
+#ifndef HCACHE_H
+#define HCACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "auxiliary.h"
+#include "statekey.h"
+
+#define H_CACHE_BITS    16 // 65536 heuristic values per thread.
+#define ROW_CACHE_BITS  12 // 4096 rover rows per thread.
+#define ROW_CACHE_GOALS (MAX_WAYPOINTS * 2 + MAX_OBJECTIVES * MAX_MODES) // Goal slots in a row.
+
+/**
+ * @struct HCacheEntry
+ * @brief A slot of the h cache.
+ *
+ * Only the 64-bit hash of the key is kept; with at most 2^16 resident entries a
+ * false match is far less likely than a hardware error.
+ */
+typedef struct {
+    unsigned long long hash; // Hash of the StateKey (0: empty slot).
+    int h;                   // The heuristic value.
+} HCacheEntry;
+
+/**
+ * @struct RowKey
+ * @brief Everything a rover's row of goal costs depends on.
+ *
+ * Fields are ordered from widest to narrowest so that the struct has no padding
+ * between them; the key is zeroed before it is filled, so it can be hashed and
+ * compared as raw bytes, tail padding included.
+ */
+typedef struct {
+    unsigned int soil_analysis;     // Bitmap of waypoints.
+    unsigned int rock_analysis;     // Bitmap of waypoints.
+    unsigned int images;            // Bitmap of (objective, mode) pairs held by the rover.
+    unsigned int soil_samples;      // Waypoints that still have a soil sample.
+    unsigned int rock_samples;      // Waypoints that still have a rock sample.
+    unsigned int communicated_soil; // Bitmap of waypoints.
+    unsigned int communicated_rock; // Bitmap of waypoints.
+    unsigned int communicated_image; // Bitmap of (objective, mode) pairs.
+    unsigned char rover;
+    unsigned char position;
+} RowKey;
+
+/**
+ * @struct RowCacheEntry
+ * @brief A slot of the row cache.
+ */
+typedef struct {
+    RowKey key;
+    int valid;
+    int cost[ROW_CACHE_GOALS]; // Cost of every goal slot for this rover (INT_MAX: not achievable).
+} RowCacheEntry;
+
+/**
+ * @struct HCacheStats
+ * @brief Lookup and hit counters of both caches.
+ */
+typedef struct {
+    long long lookups;     // h cache lookups.
+    long long hits;        // h cache hits.
+    long long row_lookups; // Row cache lookups.
+    long long row_hits;    // Row cache hits.
+} HCacheStats;
+
+int h_cache_enabled = 1; // Cleared by --no-h-cache.
+
+_Thread_local HCacheEntry *h_cache = NULL;     // Allocated on first use in every thread.
+_Thread_local RowCacheEntry *row_cache = NULL;
+_Thread_local HCacheStats h_stats;
+
+/**
+ * @brief Allocates the calling thread's caches if needed.
+ * @return 1 if the caches can be used, 0 if they are disabled or memory is short.
+ */
+int h_cache_ready() {
+    if (!h_cache_enabled) return 0;
+    if (h_cache == NULL) {
+        h_cache = (HCacheEntry*) calloc((size_t) 1 << H_CACHE_BITS, sizeof(HCacheEntry));
+        row_cache = (RowCacheEntry*) calloc((size_t) 1 << ROW_CACHE_BITS, sizeof(RowCacheEntry));
+        if (h_cache == NULL || row_cache == NULL) {
+            free(h_cache);
+            free(row_cache);
+            h_cache = NULL;
+            row_cache = NULL;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Frees the calling thread's caches. Their statistics are kept.
+ */
+void free_h_cache() {
+    free(h_cache);
+    free(row_cache);
+    h_cache = NULL;
+    row_cache = NULL;
+}
+
+/**
+ * @brief Hashes a state for the h cache.
+ *
+ * The recharge counter does not influence the heuristic, so it is cleared
+ * before hashing; the hash is never 0, which marks an empty slot.
+ */
+unsigned long long h_cache_hash(State *s) {
+    StateKey key;
+    make_state_key(s, &key);
+    key.recharges = 0;
+    unsigned long long hash = state_key_hash(&key);
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief Looks a state up in the h cache.
+ * @param hash The state's hash (h_cache_hash).
+ * @param h Output parameter for the cached value.
+ * @return 1 on a hit, 0 otherwise.
+ */
+int h_cache_lookup(unsigned long long hash, int *h) {
+    HCacheEntry *e = &h_cache[hash & (((unsigned long long) 1 << H_CACHE_BITS) - 1)];
+    h_stats.lookups++;
+    if (e->hash != hash) return 0;
+    h_stats.hits++;
+    *h = e->h;
+    return 1;
+}
+
+/**
+ * @brief Stores a heuristic value in the h cache.
+ */
+void h_cache_store(unsigned long long hash, int h) {
+    HCacheEntry *e = &h_cache[hash & (((unsigned long long) 1 << H_CACHE_BITS) - 1)];
+    e->hash = hash;
+    e->h = h;
+}
+
+/**
+ * @brief Returns the row cache slot for a rover's situation.
+ *
+ * If the slot holds this key, `*hit` is set to 1 and the row can be used as is;
+ * otherwise the slot is taken over for the key and must be filled by the caller.
+ * @param key The rover's situation (fully zeroed before its fields were set).
+ * @param hit Output parameter: 1 on a hit, 0 otherwise.
+ * @return The slot.
+ */
+RowCacheEntry *row_cache_slot(const RowKey *key, int *hit) {
+    const unsigned char *bytes = (const unsigned char*) key;
+    unsigned long long hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < sizeof(RowKey); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    RowCacheEntry *e = &row_cache[hash & (((unsigned long long) 1 << ROW_CACHE_BITS) - 1)];
+    h_stats.row_lookups++;
+    *hit = e->valid && memcmp(&e->key, key, sizeof(RowKey)) == 0;
+    if (*hit) {
+        h_stats.row_hits++;
+    } else {
+        e->key = *key;
+        e->valid = 1;
+    }
+    return e;
+}
+
+/**
+ * @brief Empties the calling thread's caches (e.g. when the problem or the goal changes).
+ */
+void clear_h_cache() {
+    if (h_cache != NULL) memset(h_cache, 0, ((size_t) 1 << H_CACHE_BITS) * sizeof(HCacheEntry));
+    if (row_cache != NULL) memset(row_cache, 0, ((size_t) 1 << ROW_CACHE_BITS) * sizeof(RowCacheEntry));
+}
+
+/**
+ * @brief Prints the hit rates of both caches.
+ * @param s The statistics (of one thread, or summed over several).
+ */
+void print_h_cache_stats(const HCacheStats *s) {
+    if (!h_cache_enabled) return;
+    printf("Heuristic cache: lookups=%lld, hits=%lld (%.1f%%), rover rows=%lld, row hits=%lld (%.1f%%)\n",
+           s->lookups, s->hits, s->lookups ? 100.0 * s->hits / s->lookups : 0.0,
+           s->row_lookups, s->row_hits, s->row_lookups ? 100.0 * s->row_hits / s->row_lookups : 0.0);
+}
+
+#endif // HCACHE_H
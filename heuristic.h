@@ -1,320 +1,822 @@
-/**
- * @file heuristic.h
- * @brief Implements all heuristic functions for the planner.
- *
- * This file contains the logic for estimating the cost from a given state to the goal.
- * It includes the main heuristic function called by the planner, which implements the
- * most advanced heuristic (H4 - Optimal Assignment). It also contains crucial helper
- * functions used by all heuristics, such as the precomputation of shortest paths
- * (Floyd-Warshall) and the calculation of relaxed costs for individual goals.
- */
-
-#ifndef HEURISTIC_H
-#define HEURISTIC_H
-
-#include <stdio.h>
-#include <math.h>
-#include "auxiliary.h"
-
-// A large integer value to represent infinity, used in shortest path calculations.
-#define INT_MAX 100000
-// A simple macro to find the maximum of two numbers.
-#define max(a, b) ((a) > (b) ? (a) : (b))
-
-/**
- * @var dist
- * @brief Global 3D array to store precomputed shortest path distances.
- *
- * `dist[rover][from_waypoint][to_waypoint]` stores the minimum energy cost
- * for a specific rover to travel between two waypoints. This is precomputed
- * once at the start of the search using the Floyd-Warshall algorithm.
- */
-int dist[MAX_ROVERS][MAX_WAYPOINTS][MAX_WAYPOINTS];
-
-/**
- * @struct GoalCost
- * @brief A helper struct to store the relaxed cost of achieving a single goal.
- *
- * This is used to evaluate every possible way a single goal can be achieved by any rover
- * and store the best option.
- */
-typedef struct {
-    int cost;       // The estimated minimum energy cost to achieve this goal.
-    int rover_id;   // The ID of the rover that can achieve this goal with the minimum cost.
-} GoalCost;
-
-/**
- * @brief Precomputes all-pairs shortest paths using the Floyd-Warshall algorithm.
- *
- * This function is called once at the beginning of the search. It populates the global
- * `dist` matrix with the minimum travel cost between any two waypoints for each rover,
- * considering their specific traversal capabilities.
- * @param nodeState The initial state, used to get rover traversal permissions.
- */
-void precompute_shortest_paths(State *nodeState) {
-    for (int rover = 0; rover < num_rovers; rover++) {
-        for (int i = 0; i < num_waypoints; i++) {
-            for (int j = 0; j < num_waypoints; j++) {
-                if (i == j) dist[rover][i][j] = 0;
-                else if (nodeState->rovers[rover].can_traverse[i][j] && (nodeState->waypoints[i].visible_waypoints & (1 << j))) dist[rover][i][j] = 8;
-                else dist[rover][i][j] = INT_MAX;
-            }
-        }
-        for (int k = 0; k < num_waypoints; k++) {
-            for (int i = 0; i < num_waypoints; i++) {
-                for (int j = 0; j < num_waypoints; j++) {
-                    if (dist[rover][i][k] != INT_MAX && dist[rover][k][j] != INT_MAX) {
-                        int through_k = dist[rover][i][k] + dist[rover][k][j];
-                        if (through_k < dist[rover][i][j]) dist[rover][i][j] = through_k;
-                    }
-                }
-            }
-        }
-    }
-}
-
-/**
- * @brief Finds the nearest waypoint to a given point that has line-of-sight to the lander.
- *
- * This is a crucial helper function for calculating communication costs.
- * @param rover The rover for which to calculate paths.
- * @param from_wp The starting waypoint.
- * @param state The current state.
- * @return The ID of the nearest communication-enabled waypoint.
- */
-int find_nearest_comm_point(int rover, int from_wp, State *state) {
-    int lander_pos = state->lander.lander_position;
-    if (state->waypoints[from_wp].visible_waypoints & (1 << lander_pos)) return from_wp;
-    int min_dist = INT_MAX;
-    int best_wp = -1;
-    for (int wp = 0; wp < num_waypoints; wp++) {
-        if (!(state->waypoints[wp].visible_waypoints & (1 << lander_pos))) continue;
-        int d = dist[rover][from_wp][wp];
-        if (d < min_dist) {
-            min_dist = d;
-            best_wp = wp;
-        }
-    }
-    return best_wp;
-}
-
-
-/**
- * @brief Calculates the minimum relaxed cost for every unfulfilled goal.
- *
- * This is the core cost estimation function. It iterates through all goals
- * (soil, rock, image) and, for each one, calculates the minimum possible cost
- * for any rover to achieve it, ignoring resource contention. These costs are
- * the building blocks for all heuristics.
- * @param state The current state to evaluate.
- * @param costs An output array to be filled with GoalCost structs.
- * @param count An output parameter storing the number of unfulfilled goals found.
- */void calculate_all_goal_costs(State *state, GoalCost costs[], int *count) {
-    *count = 0;
-
-
-    // --- Soil Goals ---
-    // Calculates travel + sample + travel_to_comm + communicate costs for each rover
-    for (int wp = 0; wp < num_waypoints; wp++) {
-        if (!goal.communicated_soil_data[wp] || state->waypoints[wp].communicated_soil) continue;
-        for (int r = 0; r < num_rovers; r++) {
-            int current_rover_cost = INT_MAX;
-            if (state->rovers[r].has_soil_analysis & (1 << wp)) {
-                int comm_point = find_nearest_comm_point(r, state->rovers[r].position, state);
-                if (comm_point != -1) current_rover_cost = dist[r][state->rovers[r].position][comm_point] + 4;
-            } else if (state->rovers[r].equipped_soil && state->waypoints[wp].has_soil_sample) {
-                int travel_to_sample = dist[r][state->rovers[r].position][wp];
-                if (travel_to_sample != INT_MAX) {
-                    int comm_point = find_nearest_comm_point(r, wp, state);
-                    if (comm_point != -1) current_rover_cost = travel_to_sample + 3 + dist[r][wp][comm_point] + 4;
-                }
-            }
-            if (current_rover_cost != INT_MAX) {
-                costs[*count] = (GoalCost){current_rover_cost, r};
-                (*count)++;
-            }
-        }
-    }
-
-
-    // --- Rock Goals ---
-    // Similar calculation for rock goals
-    for (int wp = 0; wp < num_waypoints; wp++) {
-        if (!goal.communicated_rock_data[wp] || state->waypoints[wp].communicated_rock) continue;
-        for (int r = 0; r < num_rovers; r++) {
-            int current_rover_cost = INT_MAX;
-            if (state->rovers[r].has_rock_analysis & (1 << wp)) {
-                 int comm_point = find_nearest_comm_point(r, state->rovers[r].position, state);
-                 if (comm_point != -1) current_rover_cost = dist[r][state->rovers[r].position][comm_point] + 4;
-            } else if (state->rovers[r].equipped_rock && state->waypoints[wp].has_rock_sample) {
-                int travel_to_sample = dist[r][state->rovers[r].position][wp];
-                if (travel_to_sample != INT_MAX) {
-                    int comm_point = find_nearest_comm_point(r, wp, state);
-                    if (comm_point != -1) current_rover_cost = travel_to_sample + 5 + dist[r][wp][comm_point] + 4;
-                }
-            }
-            if (current_rover_cost != INT_MAX) {
-                costs[*count] = (GoalCost){current_rover_cost, r};
-                (*count)++;
-            }
-        }
-    }
-
-
-    // --- Image Goals ---
-    // Similar calculation for image goals, including calibration cost
-    for (int obj = 0; obj < num_objectives; obj++) {
-        for (int mode = 0; mode < num_modes; mode++) {
-            if (!goal.communicated_image_data[obj][mode] || (state->objectives[obj].communicated_image & (1 << mode))) continue;
-            for (int r = 0; r < num_rovers; r++) {
-                int current_rover_cost = INT_MAX;
-                if (state->rovers[r].have_image[obj][mode]) {
-                    int comm_point = find_nearest_comm_point(r, state->rovers[r].position, state);
-                    if (comm_point != -1) current_rover_cost = dist[r][state->rovers[r].position][comm_point] + 6;
-                } else if (state->rovers[r].equipped_imaging) {
-                    int has_camera = 0;
-                    for (int c = 0; c < num_cameras; c++) if (state->cameras[c].rover_id == r && (state->cameras[c].modes_supported & (1 << mode))) { has_camera = 1; break; }
-                    if (!has_camera) continue;
-
-
-                    int best_shoot_cost = INT_MAX;
-                    for (int shoot_wp = 0; shoot_wp < num_waypoints; shoot_wp++) {
-                        if (!(state->objectives[obj].visible_waypoints & (1 << shoot_wp))) continue;
-                        int travel_cost = dist[r][state->rovers[r].position][shoot_wp];
-                        if (travel_cost == INT_MAX) continue;
-                        int comm_point = find_nearest_comm_point(r, shoot_wp, state);
-                        if (comm_point != -1) {
-                            int total = travel_cost + 2 + 1 + dist[r][shoot_wp][comm_point] + 6;
-                            if (total < best_shoot_cost) best_shoot_cost = total;
-                        }
-                    }
-                    if(best_shoot_cost < current_rover_cost) current_rover_cost = best_shoot_cost;
-                }
-                 if (current_rover_cost != INT_MAX) {
-                    costs[*count] = (GoalCost){current_rover_cost, r};
-                    (*count)++;
-                }
-            }
-        }
-    }
-}
-
-
-/**
- * @brief An admissible heuristic for the additional energy cost due to recharges.
- *
- * Given a set of tasks assigned to rovers, this function calculates a lower bound
- * on the extra energy needed for recharging. It's admissible because it only considers
- * the cost to travel to the nearest recharge station, not the full cycle.
- * @param state The current state.
- * @param assigned_costs An array where assigned_costs[r] is the energy cost of the task assigned to rover r.
- * @return The estimated additional energy cost for recharges.
- */int calculate_energy_cost_for_assignment(State *state, int assigned_costs[MAX_ROVERS]) {
-    int total_recharge_cost = 0;
-    for (int r = 0; r < num_rovers; r++) {
-        if (assigned_costs[r] == 0) continue; // No task assigned to this rover
-
-
-        int work_cost = assigned_costs[r];
-        int available_energy = state->rovers[r].energy;
-
-
-        if (work_cost > available_energy) {
-
-            // Find cost to travel to the nearest recharge station
-            int min_recharge_dist = INT_MAX;
-            for (int wp = 0; wp < num_waypoints; wp++) {
-                if (state->waypoints[wp].in_sun) {
-                    int d = dist[r][state->rovers[r].position][wp];
-                    if (d < min_recharge_dist) min_recharge_dist = d;
-                }
-            }
-
-            if (min_recharge_dist != INT_MAX) {
-                total_recharge_cost += min_recharge_dist;
-            } else {
-                return INT_MAX; // Cannot solve energy deficit
-            }
-        }
-    }
-    return total_recharge_cost;
-}
-
-
-
-
-/**
- * @brief Comparison function for qsort.
- *
- * Used to sort the `GoalCost` array in descending order of cost, so that the
- * most expensive goals can be considered first.
- */int compareGoalCosts(const void *a, const void *b) {
-    GoalCost *costA = (GoalCost *)a;
-    GoalCost *costB = (GoalCost *)b;
-    return (costB->cost - costA->cost);
-}
-
-
-/**
- * @brief The main heuristic function (implements H4 - Optimal Assignment).
- *
- * This is the function called by the search algorithm to get the h-value of a state.
- * It works as follows:
- * 1. Calculate the relaxed cost for every possible rover-goal pairing.
- * 2. Sort these potential tasks in descending order of cost.
- * 3. Greedily assign the most expensive, non-conflicting tasks to each rover.
- * (i.e., each rover can only be assigned one task).
- * 4. Sum the costs of these assigned tasks.
- * 5. Add an admissible estimate for any necessary recharging costs.
- * The result is a highly informed, admissible heuristic value.
- * @param nodeState The state for which to calculate the heuristic value.
- * @return The estimated cost to reach the goal.
- */int heuristic(State nodeState) {
-    if (is_solution(nodeState)) return 0;
-
-
-    // Array to hold all possible goal-rover pairings
-    GoalCost all_costs[ (MAX_WAYPOINTS * 2 + MAX_OBJECTIVES * MAX_MODES) * MAX_ROVERS ];
-    int goal_count = 0;
-
-    // 1. Calculate all individual goal costs
-    calculate_all_goal_costs(&nodeState, all_costs, &goal_count);
-
-
-    if (goal_count == 0) return 0;
-
-    // 2. Sort tasks by cost, descending
-    qsort(all_costs, goal_count, sizeof(GoalCost), compareGoalCosts);
-
-
-    int h_tasks = 0;
-    int rover_used[MAX_ROVERS] = {0};
-    int assigned_costs[MAX_ROVERS] = {0}; // Store cost of task assigned to each rover
-
-
-    // 3. Greedily assign the most expensive tasks to available rovers
-    for (int i = 0; i < goal_count; i++) {
-        int rover_id = all_costs[i].rover_id;
-        if (rover_id != -1 && !rover_used[rover_id]) {
-            h_tasks += all_costs[i].cost;
-            assigned_costs[rover_id] = all_costs[i].cost; // Store the cost for energy calculation
-            rover_used[rover_id] = 1;
-        }
-    }
-
-
-    // 4. Add the admissible energy cost for the assignment
-    int h_energy = calculate_energy_cost_for_assignment(&nodeState, assigned_costs);
-
-
-    if (h_energy == INT_MAX) return INT_MAX;
-
-
-    int final_h = h_tasks + h_energy;
-
-    // Ensure the heuristic value is non-negative and does not overflow
-    return (final_h < 0) ? 0 : ((final_h > INT_MAX) ? INT_MAX : final_h);
-}
-
-
-#endif // HEURISTIC_H
+/**
+ * @file heuristic.h
+ * @brief Implements all heuristic functions for the planner.
+ *
+ * This file contains the logic for estimating the cost from a given state to the goal.
+ * It includes the main heuristic function called by the planner, which implements the
+ * most advanced heuristic (H4 - Optimal Assignment). It also contains crucial helper
+ * functions used by all heuristics, such as the precomputation of shortest paths
+ * (Floyd-Warshall) and the calculation of relaxed costs for individual goals.
+ */
+
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include <stdio.h>
+#include <math.h>
+#include "auxiliary.h"
+#include "hcache.h"
+
+// A large integer value to represent infinity, used in shortest path calculations.
+#define INT_MAX 100000
+// A simple macro to find the maximum of two numbers.
+#define max(a, b) ((a) > (b) ? (a) : (b))
+
+/**
+ * @var dist
+ * @brief Global 3D array to store precomputed shortest path distances.
+ *
+ * `dist[rover][from_waypoint][to_waypoint]` stores the minimum energy cost
+ * for a specific rover to travel between two waypoints. This is precomputed
+ * once at the start of the search using the Floyd-Warshall algorithm.
+ */
+int dist[MAX_ROVERS][MAX_WAYPOINTS][MAX_WAYPOINTS];
+
+/**
+ * @var comm_dist
+ * @brief `comm_dist[rover][waypoint]` is the travel cost from a waypoint to the nearest
+ * waypoint with line-of-sight to the lander (INT_MAX if there is none within reach).
+ */
+int comm_dist[MAX_ROVERS][MAX_WAYPOINTS];
+
+/**
+ * @var calib_detour
+ * @brief `calib_detour[camera][from][to]` is the cheapest travel for the camera's rover from
+ * `from` to `to` through a waypoint where the camera can be calibrated (INT_MAX if there is none).
+ */
+int calib_detour[MAX_CAMERAS][MAX_WAYPOINTS][MAX_WAYPOINTS];
+
+/**
+ * @var rover_stores
+ * @brief The number of stores each rover owns; a rover without a store can never sample.
+ */
+int rover_stores[MAX_ROVERS];
+
+// Task sets up to this size are routed exactly (Held-Karp); larger ones use the MST bound.
+#define HELD_KARP_MAX_SITES 8
+
+// Energy levels tracked by the energy-feasible paths. With 8 energy per move, a rover
+// holding 8 * (waypoints - 1) can follow any shortest path, so more energy never helps.
+#define ENERGY_LEVELS (8 * (MAX_WAYPOINTS - 1) + 1)
+// Target index of energy_hops meaning "any waypoint visible from the lander".
+#define COMM_TARGET MAX_WAYPOINTS
+
+/**
+ * @var energy_hops
+ * @brief Energy-feasible shortest paths, in moves.
+ *
+ * `energy_hops[rover][target][from][energy]` is the minimum number of moves the rover
+ * needs to get from `from` to `target` when it starts with `energy` (capped at
+ * energy_cap) and recharges (+20, only below 8 energy, at `in_sun` waypoints) on
+ * the way. The rover may also spend energy on other actions in between, which
+ * is what makes a recharge possible earlier; the table allows for this, so
+ * 8 times its value is a lower bound on the energy spent on travel. The value is
+ * ENERGY_UNREACHABLE if the target cannot be reached at all.
+ */
+unsigned short energy_hops[MAX_ROVERS][MAX_WAYPOINTS + 1][MAX_WAYPOINTS][ENERGY_LEVELS];
+int energy_cap;
+#define ENERGY_UNREACHABLE 0xFFFF
+
+/**
+ * @struct GoalCost
+ * @brief A helper struct to store the relaxed cost of achieving a single goal.
+ *
+ * This is used to evaluate every possible way a single goal can be achieved by any rover
+ * and store the best option.
+ */
+typedef struct {
+    int cost;       // The estimated minimum energy cost to achieve this goal.
+    int rover_id;   // The ID of the rover that can achieve this goal with the minimum cost.
+} GoalCost;
+
+/**
+ * @brief Fills energy_hops for one rover and one target (a bitmap of goal waypoints).
+ *
+ * Runs a backward breadth-first search over (waypoint, energy) pairs from the
+ * targets. Moves cost one step; recharging and spending energy on other actions
+ * cost none, so every layer is first closed under those free transitions.
+ * @param nodeState The initial state (static traversal, visibility and sun data).
+ * @param rover The rover.
+ * @param targets Bitmap of target waypoints.
+ * @param hops The table to fill, indexed [from][energy].
+ */
+void energy_search(State *nodeState, int rover, int targets, unsigned short hops[MAX_WAYPOINTS][ENERGY_LEVELS]) {
+    static int layer[MAX_WAYPOINTS * ENERGY_LEVELS], next_layer[MAX_WAYPOINTS * ENERGY_LEVELS];
+    int *cur = layer, *next = next_layer;
+    int count = 0;
+
+    for (int w = 0; w < num_waypoints; w++) {
+        for (int e = 0; e <= energy_cap; e++) {
+            hops[w][e] = ENERGY_UNREACHABLE;
+            if (targets & (1 << w)) {
+                hops[w][e] = 0;
+                cur[count++] = w * ENERGY_LEVELS + e;
+            }
+        }
+    }
+
+    for (int depth = 0; count > 0; depth++) {
+        // Free predecessors: (v, f + 1) spends energy, (v, e < 8) recharges to min(e + 20, cap) = f.
+        for (int i = 0; i < count; i++) {
+            int v = cur[i] / ENERGY_LEVELS, f = cur[i] % ENERGY_LEVELS;
+            if (f + 1 <= energy_cap && hops[v][f + 1] > depth) {
+                hops[v][f + 1] = depth;
+                cur[count++] = v * ENERGY_LEVELS + f + 1;
+            }
+            if (!nodeState->waypoints[v].in_sun) continue;
+            for (int e = 0; e < 8 && e <= energy_cap; e++) {
+                int after = e + 20 < energy_cap ? e + 20 : energy_cap;
+                if (after != f || hops[v][e] <= depth) continue;
+                hops[v][e] = depth;
+                cur[count++] = v * ENERGY_LEVELS + e;
+            }
+        }
+        // Predecessors one move away: (w, f + 8) with a move from w to v.
+        int next_count = 0;
+        for (int i = 0; i < count; i++) {
+            int v = cur[i] / ENERGY_LEVELS, f = cur[i] % ENERGY_LEVELS;
+            if (f + 8 > energy_cap) continue;
+            for (int w = 0; w < num_waypoints; w++) {
+                if (!nodeState->rovers[rover].can_traverse[w][v] || !(nodeState->waypoints[w].visible_waypoints & (1 << v))) continue;
+                if (hops[w][f + 8] <= depth + 1) continue;
+                hops[w][f + 8] = depth + 1;
+                next[next_count++] = w * ENERGY_LEVELS + f + 8;
+            }
+        }
+        int *swap = cur; cur = next; next = swap;
+        count = next_count;
+    }
+}
+
+/**
+ * @brief Precomputes energy_hops for every rover, every target waypoint and the lander.
+ * @param nodeState The initial state.
+ */
+void precompute_energy_paths(State *nodeState) {
+    int comm_points = 0;
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        if (nodeState->waypoints[wp].visible_waypoints & (1 << nodeState->lander.lander_position)) comm_points |= 1 << wp;
+    }
+    energy_cap = 8 * (num_waypoints - 1) > 27 ? 8 * (num_waypoints - 1) : 27;
+    if (energy_cap > ENERGY_LEVELS - 1) energy_cap = ENERGY_LEVELS - 1;
+
+    for (int rover = 0; rover < num_rovers; rover++) {
+        for (int target = 0; target < num_waypoints; target++) {
+            energy_search(nodeState, rover, 1 << target, energy_hops[rover][target]);
+        }
+        energy_search(nodeState, rover, comm_points, energy_hops[rover][COMM_TARGET]);
+    }
+}
+
+/**
+ * @brief The minimum energy a rover spends on travel to reach a target from its current position.
+ * @param state The current state (rover position and energy).
+ * @param rover The rover.
+ * @param target A waypoint, or COMM_TARGET for the nearest communication point.
+ * @return The energy, or INT_MAX if the target cannot be reached.
+ */
+int energy_dist(State *state, int rover, int target) {
+    int energy = state->rovers[rover].energy;
+    if (energy > energy_cap) energy = energy_cap;
+    if (energy < 0) energy = 0;
+    unsigned short hops = energy_hops[rover][target][state->rovers[rover].position][energy];
+    return hops == ENERGY_UNREACHABLE ? INT_MAX : 8 * hops;
+}
+
+/**
+ * @brief Precomputes all-pairs shortest paths using the Floyd-Warshall algorithm.
+ *
+ * This function is called once at the beginning of the search. It populates the global
+ * `dist` matrix with the minimum travel cost between any two waypoints for each rover,
+ * considering their specific traversal capabilities.
+ * @param nodeState The initial state, used to get rover traversal permissions.
+ */
+void precompute_shortest_paths(State *nodeState) {
+    for (int rover = 0; rover < num_rovers; rover++) {
+        for (int i = 0; i < num_waypoints; i++) {
+            for (int j = 0; j < num_waypoints; j++) {
+                if (i == j) dist[rover][i][j] = 0;
+                else if (nodeState->rovers[rover].can_traverse[i][j] && (nodeState->waypoints[i].visible_waypoints & (1 << j))) dist[rover][i][j] = 8;
+                else dist[rover][i][j] = INT_MAX;
+            }
+        }
+        for (int k = 0; k < num_waypoints; k++) {
+            for (int i = 0; i < num_waypoints; i++) {
+                for (int j = 0; j < num_waypoints; j++) {
+                    if (dist[rover][i][k] != INT_MAX && dist[rover][k][j] != INT_MAX) {
+                        int through_k = dist[rover][i][k] + dist[rover][k][j];
+                        if (through_k < dist[rover][i][j]) dist[rover][i][j] = through_k;
+                    }
+                }
+            }
+        }
+        // The lander never moves, so the distance to the nearest communication point is static too.
+        int lander_pos = nodeState->lander.lander_position;
+        for (int i = 0; i < num_waypoints; i++) {
+            comm_dist[rover][i] = INT_MAX;
+            for (int wp = 0; wp < num_waypoints; wp++) {
+                if ((nodeState->waypoints[wp].visible_waypoints & (1 << lander_pos)) && dist[rover][i][wp] < comm_dist[rover][i]) {
+                    comm_dist[rover][i] = dist[rover][i][wp];
+                }
+            }
+        }
+    }
+
+    // Calibration waypoints: those from which one of the camera's calibration targets is visible.
+    for (int c = 0; c < num_cameras; c++) {
+        int r = nodeState->cameras[c].rover_id;
+        int calib_wps = 0;
+        for (int o = 0; o < num_objectives; o++) {
+            if (nodeState->cameras[c].calibration_targets & (1 << o)) calib_wps |= nodeState->objectives[o].visible_waypoints;
+        }
+        for (int i = 0; i < num_waypoints; i++) {
+            for (int j = 0; j < num_waypoints; j++) {
+                calib_detour[c][i][j] = INT_MAX;
+                for (int wp = 0; wp < num_waypoints; wp++) {
+                    if (!(calib_wps & (1 << wp)) || dist[r][i][wp] == INT_MAX || dist[r][wp][j] == INT_MAX) continue;
+                    if (dist[r][i][wp] + dist[r][wp][j] < calib_detour[c][i][j]) calib_detour[c][i][j] = dist[r][i][wp] + dist[r][wp][j];
+                }
+            }
+        }
+    }
+
+    for (int r = 0; r < num_rovers; r++) rover_stores[r] = 0;
+    for (int st = 0; st < num_stores; st++) rover_stores[nodeState->stores[st].rover_id]++;
+
+    precompute_energy_paths(nodeState);
+    clear_h_cache();
+}
+
+/**
+ * @brief Finds the nearest waypoint to a given point that has line-of-sight to the lander.
+ *
+ * This is a crucial helper function for calculating communication costs.
+ * @param rover The rover for which to calculate paths.
+ * @param from_wp The starting waypoint.
+ * @param state The current state.
+ * @return The ID of the nearest communication-enabled waypoint.
+ */
+int find_nearest_comm_point(int rover, int from_wp, State *state) {
+    int lander_pos = state->lander.lander_position;
+    if (state->waypoints[from_wp].visible_waypoints & (1 << lander_pos)) return from_wp;
+    int min_dist = INT_MAX;
+    int best_wp = -1;
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        if (!(state->waypoints[wp].visible_waypoints & (1 << lander_pos))) continue;
+        int d = dist[rover][from_wp][wp];
+        if (d < min_dist) {
+            min_dist = d;
+            best_wp = wp;
+        }
+    }
+    return best_wp;
+}
+
+
+/**
+ * @brief Calculates one rover's relaxed cost for every goal of the problem.
+ *
+ * Goals are visited in a fixed order (soil, rock, then image goals) and every
+ * goal takes one slot of the row, whether it is still open or not, so that rows
+ * of different states line up.
+ * @param state The current state to evaluate.
+ * @param r The rover.
+ * @param row Output: the rover's cost for every goal slot (INT_MAX if it cannot achieve it).
+ */
+void rover_goal_costs(State *state, int r, int row[ROW_CACHE_GOALS]) {
+    int slot = 0;
+
+    // A rover that is not available (e.g. outside a subproblem of factored) takes no goal.
+    if (!state->rovers[r].available) {
+        for (int i = 0; i < ROW_CACHE_GOALS; i++) row[i] = INT_MAX;
+        return;
+    }
+
+    // --- Soil Goals ---
+    // Calculates travel + sample + travel_to_comm + communicate costs for the rover
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        if (!goal.communicated_soil_data[wp]) continue;
+        int current_rover_cost = INT_MAX;
+        if (state->waypoints[wp].communicated_soil) {
+            // Goal already achieved.
+        } else if (state->rovers[r].has_soil_analysis & (1 << wp)) {
+            int comm_point = find_nearest_comm_point(r, state->rovers[r].position, state);
+            if (comm_point != -1) current_rover_cost = dist[r][state->rovers[r].position][comm_point] + 4;
+        } else if (state->rovers[r].equipped_soil && state->waypoints[wp].has_soil_sample) {
+            int travel_to_sample = dist[r][state->rovers[r].position][wp];
+            if (travel_to_sample != INT_MAX) {
+                int comm_point = find_nearest_comm_point(r, wp, state);
+                if (comm_point != -1) current_rover_cost = travel_to_sample + 3 + dist[r][wp][comm_point] + 4;
+            }
+        }
+        row[slot++] = current_rover_cost;
+    }
+
+
+    // --- Rock Goals ---
+    // Similar calculation for rock goals
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        if (!goal.communicated_rock_data[wp]) continue;
+        int current_rover_cost = INT_MAX;
+        if (state->waypoints[wp].communicated_rock) {
+            // Goal already achieved.
+        } else if (state->rovers[r].has_rock_analysis & (1 << wp)) {
+            int comm_point = find_nearest_comm_point(r, state->rovers[r].position, state);
+            if (comm_point != -1) current_rover_cost = dist[r][state->rovers[r].position][comm_point] + 4;
+        } else if (state->rovers[r].equipped_rock && state->waypoints[wp].has_rock_sample) {
+            int travel_to_sample = dist[r][state->rovers[r].position][wp];
+            if (travel_to_sample != INT_MAX) {
+                int comm_point = find_nearest_comm_point(r, wp, state);
+                if (comm_point != -1) current_rover_cost = travel_to_sample + 5 + dist[r][wp][comm_point] + 4;
+            }
+        }
+        row[slot++] = current_rover_cost;
+    }
+
+
+    // --- Image Goals ---
+    // Similar calculation for image goals, including calibration cost
+    for (int obj = 0; obj < num_objectives; obj++) {
+        for (int mode = 0; mode < num_modes; mode++) {
+            if (!goal.communicated_image_data[obj][mode]) continue;
+            int current_rover_cost = INT_MAX;
+            if (state->objectives[obj].communicated_image & (1 << mode)) {
+                // Goal already achieved.
+            } else if (state->rovers[r].have_image[obj][mode]) {
+                int comm_point = find_nearest_comm_point(r, state->rovers[r].position, state);
+                if (comm_point != -1) current_rover_cost = dist[r][state->rovers[r].position][comm_point] + 6;
+            } else if (state->rovers[r].equipped_imaging) {
+                int has_camera = 0;
+                for (int c = 0; c < num_cameras; c++) if (state->cameras[c].rover_id == r && (state->cameras[c].modes_supported & (1 << mode))) { has_camera = 1; break; }
+                for (int shoot_wp = 0; has_camera && shoot_wp < num_waypoints; shoot_wp++) {
+                    if (!(state->objectives[obj].visible_waypoints & (1 << shoot_wp))) continue;
+                    int travel_cost = dist[r][state->rovers[r].position][shoot_wp];
+                    if (travel_cost == INT_MAX) continue;
+                    int comm_point = find_nearest_comm_point(r, shoot_wp, state);
+                    if (comm_point != -1) {
+                        int total = travel_cost + 2 + 1 + dist[r][shoot_wp][comm_point] + 6;
+                        if (total < current_rover_cost) current_rover_cost = total;
+                    }
+                }
+            }
+            row[slot++] = current_rover_cost;
+        }
+    }
+}
+
+
+/**
+ * @brief Calculates the minimum relaxed cost for every unfulfilled goal.
+ *
+ * This is the core cost estimation function. It iterates through all goals
+ * (soil, rock, image) and, for each one, calculates the minimum possible cost
+ * for any rover to achieve it, ignoring resource contention. These costs are
+ * the building blocks for all heuristics.
+ *
+ * A rover's costs only depend on its own position, analyses and images
+ * and on the samples and goals still open, so they are taken from the row cache
+ * (see hcache.h) when the rover's situation has been seen before.
+ * @param state The current state to evaluate.
+ * @param costs An output array to be filled with GoalCost structs.
+ * @param count An output parameter storing the number of unfulfilled goals found.
+ */void calculate_all_goal_costs(State *state, GoalCost costs[], int *count) {
+    int rows[MAX_ROVERS][ROW_CACHE_GOALS];
+    int slots = 0;
+    *count = 0;
+
+    if (h_cache_ready()) {
+        RowKey key;
+        memset(&key, 0, sizeof(RowKey));
+        for (int wp = 0; wp < num_waypoints; wp++) {
+            if (state->waypoints[wp].has_soil_sample) key.soil_samples |= 1U << wp;
+            if (state->waypoints[wp].has_rock_sample) key.rock_samples |= 1U << wp;
+            if (state->waypoints[wp].communicated_soil) key.communicated_soil |= 1U << wp;
+            if (state->waypoints[wp].communicated_rock) key.communicated_rock |= 1U << wp;
+        }
+        for (int o = 0; o < num_objectives; o++) {
+            key.communicated_image |= (unsigned int) state->objectives[o].communicated_image << (o * num_modes);
+        }
+
+        for (int r = 0; r < num_rovers; r++) {
+            key.rover = (unsigned char) r;
+            key.position = (unsigned char) state->rovers[r].position;
+            key.soil_analysis = (unsigned int) state->rovers[r].has_soil_analysis;
+            key.rock_analysis = (unsigned int) state->rovers[r].has_rock_analysis;
+            key.images = 0;
+            for (int o = 0; o < num_objectives; o++) {
+                for (int m = 0; m < num_modes; m++) {
+                    if (state->rovers[r].have_image[o][m]) key.images |= 1U << (o * num_modes + m);
+                }
+            }
+
+            int hit;
+            RowCacheEntry *e = row_cache_slot(&key, &hit);
+            if (!hit) rover_goal_costs(state, r, e->cost);
+            memcpy(rows[r], e->cost, sizeof(rows[r]));
+        }
+    } else {
+        for (int r = 0; r < num_rovers; r++) rover_goal_costs(state, r, rows[r]);
+    }
+
+    // Collect the (goal, rover) pairs goal by goal.
+    for (int wp = 0; wp < num_waypoints; wp++) if (goal.communicated_soil_data[wp]) slots++;
+    for (int wp = 0; wp < num_waypoints; wp++) if (goal.communicated_rock_data[wp]) slots++;
+    for (int obj = 0; obj < num_objectives; obj++) {
+        for (int mode = 0; mode < num_modes; mode++) if (goal.communicated_image_data[obj][mode]) slots++;
+    }
+    for (int slot = 0; slot < slots; slot++) {
+        for (int r = 0; r < num_rovers; r++) {
+            if (rows[r][slot] != INT_MAX) {
+                costs[*count] = (GoalCost){rows[r][slot], r};
+                (*count)++;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief An admissible heuristic for the additional energy cost due to recharges.
+ *
+ * Given a set of tasks assigned to rovers, this function calculates a lower bound
+ * on the extra energy needed for recharging. It's admissible because it only considers
+ * the cost to travel to the nearest recharge station, not the full cycle.
+ * @param state The current state.
+ * @param assigned_costs An array where assigned_costs[r] is the energy cost of the task assigned to rover r.
+ * @return The estimated additional energy cost for recharges.
+ */int calculate_energy_cost_for_assignment(State *state, int assigned_costs[MAX_ROVERS]) {
+    int total_recharge_cost = 0;
+    for (int r = 0; r < num_rovers; r++) {
+        if (assigned_costs[r] == 0) continue; // No task assigned to this rover
+
+
+        int work_cost = assigned_costs[r];
+        int available_energy = state->rovers[r].energy;
+
+
+        if (work_cost > available_energy) {
+
+            // Find cost to travel to the nearest recharge station
+            int min_recharge_dist = INT_MAX;
+            for (int wp = 0; wp < num_waypoints; wp++) {
+                if (state->waypoints[wp].in_sun) {
+                    int d = dist[r][state->rovers[r].position][wp];
+                    if (d < min_recharge_dist) min_recharge_dist = d;
+                }
+            }
+
+            if (min_recharge_dist != INT_MAX) {
+                total_recharge_cost += min_recharge_dist;
+            } else {
+                return INT_MAX; // Cannot solve energy deficit
+            }
+        }
+    }
+    return total_recharge_cost;
+}
+
+
+/**
+ * @brief A lower bound on the travel cost of one rover that has to visit a set of sites.
+ *
+ * The rover starts at its current waypoint, must visit every site in any order and, if it has
+ * something to communicate, end at a waypoint visible from the lander. Small sets
+ * are solved exactly with the Held-Karp dynamic program over subsets of sites;
+ * for larger sets the cost of any such path is bounded by the minimum spanning
+ * tree over the start and the sites (undirected edges take the cheaper direction),
+ * plus the shortest final leg from a site to a communication point. The first leg
+ * starts with the rover's current energy, so it is taken from energy_hops and
+ * includes any detour to a sun waypoint that the rover cannot avoid.
+ * @param state The current state.
+ * @param rover The rover.
+ * @param sites The waypoints the rover has to visit.
+ * @param n The number of sites.
+ * @param must_communicate 1 if the route has to end at a communication point.
+ * @return The bound, or INT_MAX if some site cannot be reached.
+ */
+int rover_route_bound(State *state, int rover, const int sites[], int n, int must_communicate) {
+    int from = state->rovers[rover].position;
+    if (n == 0) return must_communicate ? energy_dist(state, rover, COMM_TARGET) : 0;
+
+    int route = INT_MAX;
+    if (n <= HELD_KARP_MAX_SITES) {
+        // cost[mask][last]: cheapest path from `from` through the sites in mask, ending at site `last`.
+        int cost[1 << HELD_KARP_MAX_SITES][HELD_KARP_MAX_SITES];
+        int full = (1 << n) - 1;
+
+        for (int mask = 1; mask <= full; mask++) {
+            for (int last = 0; last < n; last++) {
+                cost[mask][last] = INT_MAX;
+                if (!(mask & (1 << last))) continue;
+                if (mask == (1 << last)) {
+                    cost[mask][last] = energy_dist(state, rover, sites[last]);
+                    continue;
+                }
+                int prev_mask = mask & ~(1 << last);
+                for (int prev = 0; prev < n; prev++) {
+                    if (!(prev_mask & (1 << prev)) || cost[prev_mask][prev] == INT_MAX) continue;
+                    int leg = dist[rover][sites[prev]][sites[last]];
+                    if (leg == INT_MAX) continue;
+                    if (cost[prev_mask][prev] + leg < cost[mask][last]) cost[mask][last] = cost[prev_mask][prev] + leg;
+                }
+            }
+        }
+        for (int last = 0; last < n; last++) {
+            if (cost[full][last] == INT_MAX) continue;
+            int end = must_communicate ? comm_dist[rover][sites[last]] : 0;
+            if (end == INT_MAX) continue;
+            if (cost[full][last] + end < route) route = cost[full][last] + end;
+        }
+        return route;
+    }
+
+    // Prim's algorithm over {from} + sites (vertex 0 is the start, vertex i + 1 is sites[i]).
+    int in_tree[MAX_WAYPOINTS + 1] = {0};
+    int link[MAX_WAYPOINTS + 1];
+    int tree = 0;
+    in_tree[0] = 1;
+    for (int i = 0; i < n; i++) {
+        int a = dist[rover][from][sites[i]], b = dist[rover][sites[i]][from];
+        link[i + 1] = a < b ? a : b;
+    }
+    for (int added = 0; added < n; added++) {
+        int next = -1;
+        for (int i = 1; i <= n; i++) {
+            if (!in_tree[i] && (next == -1 || link[i] < link[next])) next = i;
+        }
+        if (link[next] == INT_MAX) return INT_MAX;
+        in_tree[next] = 1;
+        tree += link[next];
+        for (int i = 1; i <= n; i++) {
+            if (in_tree[i]) continue;
+            int a = dist[rover][sites[next - 1]][sites[i - 1]], b = dist[rover][sites[i - 1]][sites[next - 1]];
+            if ((a < b ? a : b) < link[i]) link[i] = a < b ? a : b;
+        }
+    }
+    if (!must_communicate) return tree;
+    int end = INT_MAX;
+    for (int i = 0; i < n; i++) if (comm_dist[rover][sites[i]] < end) end = comm_dist[rover][sites[i]];
+    return end == INT_MAX ? INT_MAX : tree + end;
+}
+
+
+/**
+ * @brief Lower bound on the travel a rover needs to take an image and communicate it.
+ *
+ * The rover goes to a waypoint from which the objective is visible, through a
+ * calibration waypoint unless the camera is calibrated already, and then on to a
+ * waypoint with line-of-sight to the lander.
+ * @param state The state.
+ * @param rover The rover.
+ * @param obj The objective.
+ * @param mode The mode.
+ * @return The bound, or INT_MAX if no camera of the rover can take the image and have it communicated.
+ */
+int image_trip_bound(State *state, int rover, int obj, int mode) {
+    int from = state->rovers[rover].position, best = INT_MAX;
+    for (int c = 0; c < num_cameras; c++) {
+        if (state->cameras[c].rover_id != rover || !(state->cameras[c].modes_supported & (1 << mode))) continue;
+        for (int wp = 0; wp < num_waypoints; wp++) {
+            if (!(state->objectives[obj].visible_waypoints & (1 << wp)) || comm_dist[rover][wp] == INT_MAX) continue;
+            int to_shoot = state->cameras[c].calibrated ? dist[rover][from][wp] : calib_detour[c][from][wp];
+            if (to_shoot != INT_MAX && to_shoot + comm_dist[rover][wp] < best) best = to_shoot + comm_dist[rover][wp];
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief An admissible multi-task bound: per-goal action costs plus per-rover routes.
+ *
+ * Every open goal contributes the cheapest action cost it still needs (sampling and
+ * communicating, or taking and communicating the image), whichever rover does it.
+ * Goals that only one rover can still achieve also pin their travel to that rover:
+ * it has to visit all of its exclusive sample sites and then reach a communication
+ * point, which rover_route_bound bounds from below. An exclusive image the rover does
+ * not hold yet also needs its trip through a calibration waypoint (unless the camera
+ * is calibrated) and a shooting waypoint to a communication point (image_trip_bound).
+ * That trip may share its travel with the sample sites, so the rover's bound is the
+ * larger of its route and its longest such trip, not their sum. Since exclusive goals
+ * belong to exactly one rover, no travel is counted twice and the rover bounds can be
+ * summed.
+ * A rover only counts as able to achieve a goal if it can reach the sites with the
+ * energy it has and the recharges it can make (energy_hops), and a goal that no
+ * rover can achieve any more makes the state a dead end.
+ * @param state The state to evaluate.
+ * @return The bound, or INT_MAX if the goals can no longer be achieved.
+ */
+int routing_bound(State *state) {
+    int sites[MAX_ROVERS][MAX_WAYPOINTS * 2];
+    int site_count[MAX_ROVERS] = {0};
+    int must_communicate[MAX_ROVERS] = {0};
+    int image_trip[MAX_ROVERS] = {0};
+    int actions = 0;
+
+    // Soil (kind 0) and rock (kind 1) goals.
+    for (int kind = 0; kind < 2; kind++) {
+        for (int wp = 0; wp < num_waypoints; wp++) {
+            int open = kind == 0 ? goal.communicated_soil_data[wp] && !state->waypoints[wp].communicated_soil
+                                 : goal.communicated_rock_data[wp] && !state->waypoints[wp].communicated_rock;
+            if (!open) continue;
+            int sample_cost = kind == 0 ? 3 : 5;
+            int has_sample = kind == 0 ? state->waypoints[wp].has_soil_sample : state->waypoints[wp].has_rock_sample;
+            int candidates = 0, only = -1, holds = 0, any_holder = 0;
+
+            for (int r = 0; r < num_rovers; r++) {
+                if (!state->rovers[r].available) continue;
+                int analysis = kind == 0 ? state->rovers[r].has_soil_analysis : state->rovers[r].has_rock_analysis;
+                int equipped = kind == 0 ? state->rovers[r].equipped_soil : state->rovers[r].equipped_rock;
+                if (analysis & (1 << wp)) {
+                    if (energy_dist(state, r, COMM_TARGET) == INT_MAX) continue;
+                    any_holder = 1;
+                    candidates++; only = r; holds = 1;
+                } else if (equipped && rover_stores[r] > 0 && has_sample && energy_dist(state, r, wp) != INT_MAX
+                           && comm_dist[r][wp] != INT_MAX) {
+                    candidates++; only = r; holds = 0;
+                }
+            }
+            if (candidates == 0) return INT_MAX;
+            actions += any_holder ? 4 : sample_cost + 4;
+            if (candidates > 1) continue;
+            must_communicate[only] = 1;
+            if (!holds) sites[only][site_count[only]++] = wp;
+        }
+    }
+
+    // Image goals: the shooting waypoint is a choice, so they add trips rather than sites.
+    for (int obj = 0; obj < num_objectives; obj++) {
+        for (int mode = 0; mode < num_modes; mode++) {
+            if (!goal.communicated_image_data[obj][mode] || (state->objectives[obj].communicated_image & (1 << mode))) continue;
+            int candidates = 0, only = -1, any_holder = 0, any_calibrated = 0;
+            for (int r = 0; r < num_rovers; r++) {
+                if (!state->rovers[r].available) continue;
+                int able = state->rovers[r].have_image[obj][mode];
+                if (!able && state->rovers[r].equipped_imaging) {
+                    for (int c = 0; c < num_cameras; c++) {
+                        if (state->cameras[c].rover_id != r || !(state->cameras[c].modes_supported & (1 << mode))) continue;
+                        if (state->cameras[c].calibrated) {
+                            any_calibrated = 1;
+                            able = 1;
+                            continue;
+                        }
+                        // Otherwise the camera needs a calibration waypoint on the way to a shooting waypoint.
+                        for (int shoot_wp = 0; shoot_wp < num_waypoints && !able; shoot_wp++) {
+                            if ((state->objectives[obj].visible_waypoints & (1 << shoot_wp))
+                                && calib_detour[c][state->rovers[r].position][shoot_wp] != INT_MAX) able = 1;
+                        }
+                    }
+                }
+                if (!able || energy_dist(state, r, COMM_TARGET) == INT_MAX) continue;
+                candidates++; only = r;
+                if (state->rovers[r].have_image[obj][mode]) any_holder = 1;
+            }
+            if (candidates == 0) return INT_MAX;
+            // Taking an image uses up the calibration, so unless a suitable camera is
+            // calibrated already, this image needs its own calibrate action.
+            actions += any_holder ? 6 : 1 + 6 + (any_calibrated ? 0 : 2);
+            if (candidates > 1) continue;
+            must_communicate[only] = 1;
+            if (any_holder) continue;
+            int trip = image_trip_bound(state, only, obj, mode);
+            if (trip == INT_MAX) return INT_MAX;
+            if (trip > image_trip[only]) image_trip[only] = trip;
+        }
+    }
+
+    int travel = 0;
+    for (int r = 0; r < num_rovers; r++) {
+        int route = rover_route_bound(state, r, sites[r], site_count[r], must_communicate[r]);
+        if (route == INT_MAX) return INT_MAX;
+        travel += route > image_trip[r] ? route : image_trip[r];
+    }
+    return travel + actions;
+}
+
+
+
+
+/**
+ * @brief Comparison function for qsort.
+ *
+ * Used to sort the `GoalCost` array in descending order of cost, so that the
+ * most expensive goals can be considered first.
+ */int compareGoalCosts(const void *a, const void *b) {
+    GoalCost *costA = (GoalCost *)a;
+    GoalCost *costB = (GoalCost *)b;
+    return (costB->cost - costA->cost);
+}
+
+
+/**
+ * @brief The task assignment estimate of H4 (Optimal Assignment).
+ *
+ * It works as follows:
+ * 1. Calculate the relaxed cost for every possible rover-goal pairing.
+ * 2. Sort these potential tasks in descending order of cost.
+ * 3. Greedily assign the most expensive, non-conflicting tasks to each rover.
+ * (i.e., each rover can only be assigned one task).
+ * 4. Sum the costs of these assigned tasks.
+ * 5. Add an admissible estimate for any necessary recharging costs.
+ * @param nodeState The state for which to calculate the estimate (not modified).
+ * @return The estimate, 0 if no rover can work on any open goal, or INT_MAX if the
+ *         assigned tasks cannot be powered. The assignment is greedy, so INT_MAX
+ *         does not prove a dead end: another assignment may be feasible.
+ */
+int assignment_estimate(State *nodeState) {
+    // Array to hold all possible goal-rover pairings
+    GoalCost all_costs[ (MAX_WAYPOINTS * 2 + MAX_OBJECTIVES * MAX_MODES) * MAX_ROVERS ];
+    int goal_count = 0;
+
+    // 1. Calculate all individual goal costs
+    calculate_all_goal_costs(nodeState, all_costs, &goal_count);
+
+
+    // No rover can work on any open goal: the routing bound decides whether this is a dead end.
+    if (goal_count == 0) return 0;
+
+    // 2. Sort tasks by cost, descending
+    qsort(all_costs, goal_count, sizeof(GoalCost), compareGoalCosts);
+
+
+    int h_tasks = 0;
+    int rover_used[MAX_ROVERS] = {0};
+    int assigned_costs[MAX_ROVERS] = {0}; // Store cost of task assigned to each rover
+
+
+    // 3. Greedily assign the most expensive tasks to available rovers
+    for (int i = 0; i < goal_count; i++) {
+        int rover_id = all_costs[i].rover_id;
+        if (rover_id != -1 && !rover_used[rover_id]) {
+            h_tasks += all_costs[i].cost;
+            assigned_costs[rover_id] = all_costs[i].cost; // Store the cost for energy calculation
+            rover_used[rover_id] = 1;
+        }
+    }
+
+
+    // 4. Add the admissible energy cost for the assignment
+    int h_energy = calculate_energy_cost_for_assignment(nodeState, assigned_costs);
+
+
+    if (h_energy == INT_MAX) return INT_MAX;
+
+    return h_tasks + h_energy;
+}
+
+
+/**
+ * @brief The main heuristic function (implements H4 - Optimal Assignment).
+ *
+ * This is the function called by the search algorithm to get the h-value of a state.
+ * It is the task assignment estimate (assignment_estimate), raised to the routing
+ * bound (routing_bound) when that is larger: the bound accounts for rovers that
+ * must visit several task sites on their own.
+ * Only the routing bound reports dead ends. When the greedy assignment cannot be
+ * powered, the state is not a proven dead end and gets the routing bound alone.
+ * The result is a highly informed, admissible heuristic value.
+ * @param nodeState The state for which to calculate the heuristic value (not modified).
+ * @return The estimated cost to reach the goal, or INT_MAX if some goal can no longer be achieved.
+ */int evaluate_heuristic(State *nodeState) {
+    if (is_goal_state(nodeState)) return 0;
+
+    int h_route = routing_bound(nodeState);
+    if (h_route == INT_MAX) return INT_MAX;
+
+    // Take the multi-task routing bound if it is tighter.
+    int final_h = assignment_estimate(nodeState);
+    if (final_h == INT_MAX) final_h = h_route;
+    final_h = max(final_h, h_route);
+
+    // Ensure the heuristic value is non-negative and does not overflow
+    return (final_h < 0) ? 0 : ((final_h > INT_MAX) ? INT_MAX : final_h);
+}
+
+
+/**
+ * @var heuristic_function
+ * @brief The state evaluation used by heuristic(): evaluate_heuristic (H4, the default)
+ * or relaxed_plan_heuristic (--heuristic rp, see relaxed_plan.h).
+ */
+int (*heuristic_function)(State *nodeState) = evaluate_heuristic;
+
+/**
+ * @brief The heuristic function called by the search.
+ *
+ * Returns the value of heuristic_function, taken from the calling thread's h cache
+ * (see hcache.h) when the state, up to its recharge counter, was evaluated before.
+ * @param nodeState The state for which to calculate the heuristic value.
+ * @return The estimated cost to reach the goal.
+ */
+int heuristic(State nodeState) {
+    if (!h_cache_ready()) return heuristic_function(&nodeState);
+
+    unsigned long long hash = h_cache_hash(&nodeState);
+    int h;
+    if (h_cache_lookup(hash, &h)) return h;
+    h = heuristic_function(&nodeState);
+    h_cache_store(hash, h);
+    return h;
+}
+
+
+#endif // HEURISTIC_H
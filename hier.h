@@ -0,0 +1,405 @@
+/**
+ * @file hier.h
+ * @brief Assignment and routes of the hierarchical solver (hier).
+ *
+ * The solver works in two levels and needs no search in the common case:
+ *  1. The goals are assigned to the rovers. The assignment of factored.h (the
+ *     cheapest rover of every goal, by the costs of rover_goal_costs) is improved
+ *     by local search: a goal moves to another rover while that lowers the sum of
+ *     the rovers' tour estimates (hier_tour). A tour visits the goal sites of a
+ *     rover in the best order found, with a calibration detour before every
+ *     image, and ends at the nearest communication point.
+ *  2. Every rover's tour is executed with apply_action (hier_route): the rover
+ *     follows energy-feasible paths (energy_hops), recharging on the way when it
+ *     has to, samples (and drops right away, so that its stores stay free),
+ *     calibrates and takes the images, and communicates all its data at the end.
+ *
+ * A route that cannot be executed this way (typically because the rover runs out
+ * of energy away from the sun) is left to the per-rover search of the factored
+ * method, which also reassigns goals if that search fails.
+ */
+
+#ifndef HIER_H
+#define HIER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "auxiliary.h"
+#include "heuristic.h"
+#include "agenda.h"
+#include "factored.h"
+
+#define HIER_DP_SITES 8     // Tours with up to this many sites are ordered exactly (Held-Karp).
+#define HIER_PASSES   50    // Maximum passes of the assignment local search.
+
+int hier_wp[MAX_ROVERS][GOAL_SLOTS];  // Waypoint where the rover samples or takes the image of a goal.
+int hier_cam[MAX_ROVERS][GOAL_SLOTS]; // Camera the rover takes the image of a goal with.
+
+/**
+ * @brief Chooses, for every rover and goal, where (and with which camera) the rover works on it.
+ *
+ * An image is taken where the camera's calibration detour from the rover's position
+ * plus the way to a communication point is shortest, as in rover_goal_costs.
+ * @param init The initial state.
+ */
+void hier_choose_sites(State *init) {
+    for (int r = 0; r < num_rovers; r++) {
+        int pos = init->rovers[r].position;
+        for (int slot = 0; slot < GOAL_SLOTS; slot++) {
+            hier_wp[r][slot] = hier_cam[r][slot] = -1;
+            if (goal_cost[r][slot] == INT_MAX) continue;
+            if (slot < 2 * MAX_WAYPOINTS) {
+                hier_wp[r][slot] = slot % MAX_WAYPOINTS;
+                continue;
+            }
+            int obj = (slot - 2 * MAX_WAYPOINTS) / MAX_MODES, mode = (slot - 2 * MAX_WAYPOINTS) % MAX_MODES;
+            int best_cost = INT_MAX;
+            for (int c = 0; c < num_cameras; c++) {
+                if (init->cameras[c].rover_id != r || !(init->cameras[c].modes_supported & (1 << mode))) continue;
+                for (int wp = 0; wp < num_waypoints; wp++) {
+                    if (!(init->objectives[obj].visible_waypoints & (1 << wp))) continue;
+                    if (calib_detour[c][pos][wp] == INT_MAX || comm_dist[r][wp] == INT_MAX) continue;
+                    if (calib_detour[c][pos][wp] + comm_dist[r][wp] < best_cost) {
+                        best_cost = calib_detour[c][pos][wp] + comm_dist[r][wp];
+                        hier_wp[r][slot] = wp;
+                        hier_cam[r][slot] = c;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Travel of a rover from a waypoint to the site of a goal (through a calibration waypoint for images).
+ */
+int hier_leg(int r, int slot, int from) {
+    if (hier_wp[r][slot] < 0) return INT_MAX;
+    if (slot < 2 * MAX_WAYPOINTS) return dist[r][from][hier_wp[r][slot]];
+    return calib_detour[hier_cam[r][slot]][from][hier_wp[r][slot]];
+}
+
+/**
+ * @brief Energy a goal takes besides the travel: sampling or calibrating and imaging, and communicating.
+ */
+int hier_work(int slot) {
+    if (slot < MAX_WAYPOINTS) return 3 + 4;
+    if (slot < 2 * MAX_WAYPOINTS) return 5 + 4;
+    return 2 + 1 + 6;
+}
+
+/**
+ * @brief The tour cost of a rover for its goals in a given order.
+ * @return The cost, or INT_MAX if a site cannot be reached.
+ */
+int hier_tour_cost(int r, int from, const int *slots, int n) {
+    int cost = 0, at = from;
+    for (int i = 0; i < n; i++) {
+        int leg = hier_leg(r, slots[i], at);
+        if (leg == INT_MAX) return INT_MAX;
+        cost += leg + hier_work(slots[i]);
+        at = hier_wp[r][slots[i]];
+    }
+    if (comm_dist[r][at] == INT_MAX) return INT_MAX;
+    return cost + comm_dist[r][at];
+}
+
+/**
+ * @brief Orders the goals of a rover's tour and returns its cost.
+ *
+ * Up to HIER_DP_SITES goals are ordered exactly; larger tours start from the
+ * nearest neighbour order, which is improved by moving single goals to a better
+ * place of the tour while that pays off.
+ * @param r The rover.
+ * @param from The rover's position.
+ * @param slots In: the goals; out: the goals in tour order.
+ * @param n The number of goals.
+ * @return The cost of the tour, or INT_MAX if a site cannot be reached.
+ */
+int hier_tour(int r, int from, int *slots, int n) {
+    if (n == 0) return 0;
+
+    if (n <= HIER_DP_SITES) {
+        // cost[mask][last]: cheapest tour from `from` through the goals in mask, ending with goal `last`.
+        static int cost[1 << HIER_DP_SITES][HIER_DP_SITES], prev[1 << HIER_DP_SITES][HIER_DP_SITES];
+        int full = (1 << n) - 1, best = INT_MAX, best_last = -1;
+
+        for (int mask = 1; mask <= full; mask++) {
+            for (int last = 0; last < n; last++) {
+                cost[mask][last] = INT_MAX;
+                if (!(mask & (1 << last))) continue;
+                int prev_mask = mask & ~(1 << last);
+                if (prev_mask == 0) {
+                    int leg = hier_leg(r, slots[last], from);
+                    if (leg != INT_MAX) cost[mask][last] = leg + hier_work(slots[last]);
+                    prev[mask][last] = -1;
+                    continue;
+                }
+                for (int p = 0; p < n; p++) {
+                    if (!(prev_mask & (1 << p)) || cost[prev_mask][p] == INT_MAX) continue;
+                    int leg = hier_leg(r, slots[last], hier_wp[r][slots[p]]);
+                    if (leg == INT_MAX) continue;
+                    if (cost[prev_mask][p] + leg + hier_work(slots[last]) < cost[mask][last]) {
+                        cost[mask][last] = cost[prev_mask][p] + leg + hier_work(slots[last]);
+                        prev[mask][last] = p;
+                    }
+                }
+            }
+        }
+        for (int last = 0; last < n; last++) {
+            int end = comm_dist[r][hier_wp[r][slots[last]]];
+            if (cost[full][last] == INT_MAX || end == INT_MAX) continue;
+            if (cost[full][last] + end < best) {
+                best = cost[full][last] + end;
+                best_last = last;
+            }
+        }
+        if (best_last < 0) return INT_MAX;
+
+        int order[HIER_DP_SITES], mask = full;
+        for (int i = n - 1, last = best_last; i >= 0; i--) {
+            order[i] = slots[last];
+            int p = prev[mask][last];
+            mask &= ~(1 << last);
+            last = p;
+        }
+        memcpy(slots, order, n * sizeof(int));
+        return best;
+    }
+
+    // Nearest neighbour order.
+    for (int i = 0, at = from; i < n; i++) {
+        int next = i;
+        for (int j = i + 1; j < n; j++) {
+            if (hier_leg(r, slots[j], at) < hier_leg(r, slots[next], at)) next = j;
+        }
+        int swap = slots[i]; slots[i] = slots[next]; slots[next] = swap;
+        at = hier_wp[r][slots[i]];
+    }
+
+    // Move single goals to a better place.
+    int best = hier_tour_cost(r, from, slots, n), improved = 1;
+    while (improved && best != INT_MAX) {
+        improved = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (j == i) continue;
+                int moving = slots[i];
+                if (i < j) memmove(&slots[i], &slots[i + 1], (j - i) * sizeof(int));
+                else memmove(&slots[j + 1], &slots[j], (i - j) * sizeof(int));
+                slots[j] = moving;
+
+                int cost = hier_tour_cost(r, from, slots, n);
+                if (cost < best) {
+                    best = cost;
+                    improved = 1;
+                    break;
+                }
+                // Undo the move.
+                if (i < j) memmove(&slots[i + 1], &slots[i], (j - i) * sizeof(int));
+                else memmove(&slots[j], &slots[j + 1], (i - j) * sizeof(int));
+                slots[i] = moving;
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Collects the goals assigned to a rover, in slot order.
+ * @return The number of goals.
+ */
+int hier_rover_goals(int r, int *slots) {
+    int n = 0;
+    for (int slot = 0; slot < GOAL_SLOTS; slot++) if (goal_rover[slot] == r) slots[n++] = slot;
+    return n;
+}
+
+/**
+ * @brief Moves a goal to another rover.
+ */
+void hier_move_goal(int slot, int to) {
+    int from = goal_rover[slot];
+    *goal_slot(&rover_tasks[from].goal, slot) = 0;
+    rover_tasks[from].goals--;
+    *goal_slot(&rover_tasks[to].goal, slot) = 1;
+    rover_tasks[to].goals++;
+    goal_rover[slot] = to;
+}
+
+/**
+ * @brief Improves the assignment of factored_assign by local search (see the file comment).
+ * @param init The initial state.
+ * @return The sum of the tour estimates of the rovers (INT_MAX if some tour is impossible).
+ */
+int hier_improve(State *init) {
+    int tour[MAX_ROVERS], slots[GOAL_SLOTS], total = 0;
+
+    hier_choose_sites(init);
+    for (int r = 0; r < num_rovers; r++) {
+        int n = hier_rover_goals(r, slots);
+        tour[r] = hier_tour(r, init->rovers[r].position, slots, n);
+    }
+
+    for (int pass = 0, improved = 1; improved && pass < HIER_PASSES; pass++) {
+        improved = 0;
+        for (int slot = 0; slot < GOAL_SLOTS; slot++) {
+            int from = goal_rover[slot];
+            if (from < 0) continue;
+            for (int to = 0; to < num_rovers; to++) {
+                if (to == from || goal_cost[to][slot] == INT_MAX || hier_wp[to][slot] < 0) continue;
+
+                hier_move_goal(slot, to);
+                int n = hier_rover_goals(from, slots);
+                int from_tour = hier_tour(from, init->rovers[from].position, slots, n);
+                n = hier_rover_goals(to, slots);
+                int to_tour = hier_tour(to, init->rovers[to].position, slots, n);
+
+                // An impossible tour may become possible without the goal.
+                long long before = (long long) tour[from] + tour[to], after = (long long) from_tour + to_tour;
+                if (after < before) {
+                    tour[from] = from_tour;
+                    tour[to] = to_tour;
+                    improved = 1;
+                    break;
+                }
+                hier_move_goal(slot, from);
+            }
+        }
+    }
+
+    for (int r = 0; r < num_rovers; r++) {
+        if (tour[r] == INT_MAX) return INT_MAX;
+        total += tour[r];
+    }
+    return total;
+}
+
+/**
+ * @brief Applies an action of a route and appends it to the rover's plan.
+ * @return 1 on success, 0 if the action is not applicable.
+ */
+int hier_do(State *s, int action_type, int *params, RoverTask *t) {
+    State next;
+    int energy_spent;
+    if (!apply_action(s, action_type, params, &next, &energy_spent)) return 0;
+    *s = next;
+    t->plan[t->plan_len++] = compact_action_pack(action_type, params);
+    t->energy += energy_spent;
+    return 1;
+}
+
+/**
+ * @brief Recharges the rover if it has less energy than an action needs and it can.
+ * @return 1 if the rover has the energy now, 0 otherwise.
+ */
+int hier_energy(State *s, int r, int needed, RoverTask *t) {
+    if (s->rovers[r].energy >= needed) return 1;
+    int params[2] = {r, s->rovers[r].position};
+    return hier_do(s, 1, params, t) && s->rovers[r].energy >= needed;
+}
+
+/**
+ * @brief Moves the rover to a target along an energy-feasible shortest path (energy_hops).
+ * @param target A waypoint, or COMM_TARGET for the nearest communication point.
+ * @return 1 on success, 0 if the rover gets stuck.
+ */
+int hier_goto(State *s, int r, int target, RoverTask *t) {
+    for (int steps = 0; steps < 4 * MAX_WAYPOINTS; steps++) {
+        int pos = s->rovers[r].position, energy = s->rovers[r].energy;
+        int hops = energy_hops[r][target][pos][energy > energy_cap ? energy_cap : energy];
+        if (hops == 0) return 1;
+        if (hops == ENERGY_UNREACHABLE) return 0;
+
+        if (energy < 8) {
+            if (!hier_energy(s, r, 8, t)) return 0;
+            continue;
+        }
+        int next = -1, after = energy - 8 > energy_cap ? energy_cap : energy - 8;
+        for (int wp = 0; wp < num_waypoints && next < 0; wp++) {
+            if (!s->rovers[r].can_traverse[pos][wp] || !(s->waypoints[pos].visible_waypoints & (1 << wp))) continue;
+            if (energy_hops[r][target][wp][after] == hops - 1) next = wp;
+        }
+        int params[3] = {r, pos, next};
+        if (next < 0 || !hier_do(s, 0, params, t)) return 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Executes a rover's tour with apply_action (see the file comment).
+ * @param init The initial state.
+ * @param t The rover's task; its plan, length and energy are filled in.
+ * @return 1 on success, 0 if the tour could not be executed.
+ */
+int hier_route(State *init, RoverTask *t) {
+    static State s;
+    int slots[GOAL_SLOTS], r = t->rover, lander = init->lander.lander_position;
+    int n = hier_rover_goals(r, slots);
+
+    free(t->plan);
+    t->plan = (CompactAction*) malloc(64 * MAX_WAYPOINTS * (n + 1) * sizeof(CompactAction));
+    t->plan_len = t->energy = 0;
+    if (t->plan == NULL) return 0;
+
+    s = *init;
+    if (hier_tour(r, s.rovers[r].position, slots, n) == INT_MAX) return 0;
+
+    for (int i = 0; i < n; i++) {
+        int slot = slots[i], wp = hier_wp[r][slot];
+        if (slot < 2 * MAX_WAYPOINTS) {
+            int rock = slot >= MAX_WAYPOINTS, store = -1;
+            if (!hier_goto(&s, r, wp, t)) return 0;
+            for (int st = 0; st < num_stores; st++) {
+                if (s.stores[st].rover_id == r && (store < 0 || !s.stores[st].is_full)) store = st;
+            }
+            int params[3] = {r, store, wp};
+            if (store < 0) return 0;
+            if (s.stores[store].is_full && !hier_do(&s, 4, params, t)) return 0;
+            if (!hier_energy(&s, r, rock ? 5 : 3, t) || !hier_do(&s, rock ? 3 : 2, params, t)) return 0;
+            if (!hier_do(&s, 4, params, t)) return 0;
+            continue;
+        }
+
+        int obj = (slot - 2 * MAX_WAYPOINTS) / MAX_MODES, mode = (slot - 2 * MAX_WAYPOINTS) % MAX_MODES;
+        int cam = hier_cam[r][slot];
+        if (!s.cameras[cam].calibrated) {
+            // The calibration waypoint on the cheapest detour to the image.
+            int pos = s.rovers[r].position, cal = -1, target = -1;
+            for (int t_obj = 0; t_obj < num_objectives; t_obj++) {
+                if (!(s.cameras[cam].calibration_targets & (1 << t_obj))) continue;
+                for (int w = 0; w < num_waypoints; w++) {
+                    if (!(s.objectives[t_obj].visible_waypoints & (1 << w))) continue;
+                    if (dist[r][pos][w] == INT_MAX || dist[r][w][wp] == INT_MAX) continue;
+                    if (cal < 0 || dist[r][pos][w] + dist[r][w][wp] < dist[r][pos][cal] + dist[r][cal][wp]) {
+                        cal = w;
+                        target = t_obj;
+                    }
+                }
+            }
+            int params[4] = {r, cam, target, cal};
+            if (cal < 0 || !hier_goto(&s, r, cal, t)) return 0;
+            if (!hier_energy(&s, r, 2, t) || !hier_do(&s, 5, params, t)) return 0;
+        }
+        int params[5] = {r, wp, obj, cam, mode};
+        if (!hier_goto(&s, r, wp, t)) return 0;
+        if (!hier_energy(&s, r, 1, t) || !hier_do(&s, 6, params, t)) return 0;
+    }
+
+    if (n > 0 && !hier_goto(&s, r, COMM_TARGET, t)) return 0;
+    for (int i = 0; i < n; i++) {
+        int slot = slots[i], pos = s.rovers[r].position;
+        if (slot < 2 * MAX_WAYPOINTS) {
+            int params[4] = {r, slot % MAX_WAYPOINTS, pos, lander};
+            if (!hier_energy(&s, r, 4, t) || !hier_do(&s, slot < MAX_WAYPOINTS ? 7 : 8, params, t)) return 0;
+        } else {
+            int params[5] = {r, (slot - 2 * MAX_WAYPOINTS) / MAX_MODES, (slot - 2 * MAX_WAYPOINTS) % MAX_MODES, pos, lander};
+            if (!hier_energy(&s, r, 6, t) || !hier_do(&s, 9, params, t)) return 0;
+        }
+    }
+    return 1;
+}
+
+#endif // HIER_H
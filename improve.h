@@ -0,0 +1,380 @@
+/**
+ * @file improve.h
+ * @brief Large-neighbourhood improvement of a found plan (--improve).
+ *
+ * The actions of one rover never change what the actions of the other rovers
+ * need (see factored.h), so a window of consecutive actions of one rover can be
+ * replaced on its own. For every window, a bounded A* over the actions of that
+ * rover searches for a cheaper way from the state before the window to the state
+ * its actions lead to: the same position, data, images, calibrations, stores and
+ * samples, and at least as much energy. The new actions take the place of the
+ * first action of the window, and the whole plan is replayed with apply_action
+ * before the change is kept. A recharge that is no longer applicable because the
+ * rover saved energy is dropped during the replay.
+ *
+ * The windows of every rover are visited in order; when a whole sweep finds
+ * nothing, the window grows. The pass stops at the time budget, after a sweep
+ * with the largest window, or when every window has been tried.
+ */
+
+#ifndef IMPROVE_H
+#define IMPROVE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "auxiliary.h"
+#include "heuristic.h"
+#include "minheap.h"
+#include "statekey.h"
+#include "solution.h"
+#include "uthash.h"
+
+#define IMPROVE_WINDOW     6     // Actions of the first windows.
+#define IMPROVE_MAX_WINDOW 24    // Largest window.
+#define IMPROVE_NODES      20000 // Nodes the search of one window may generate.
+#define WINDOW_ACTIONS     (MAX_WAYPOINTS + 1 + 3 * MAX_STORES + MAX_CAMERAS * MAX_OBJECTIVES * (1 + MAX_MODES) \
+                            + 2 * MAX_WAYPOINTS + MAX_OBJECTIVES * MAX_MODES) // Most actions window_actions lists.
+
+double improve_seconds = 0; // Time budget of the improvement pass (--improve); 0 disables it.
+
+/**
+ * @struct WindowNode
+ * @brief A node of the search of one window.
+ */
+typedef struct {
+    StateKey key;         // The state.
+    int g;                // Energy spent since the start of the window.
+    int parent;           // Index of the parent node (-1 for the start).
+    CompactAction action; // The action that led here from the parent.
+} WindowNode;
+
+WindowNode *window_nodes = NULL; // Nodes of the current window search (IMPROVE_NODES entries).
+
+/**
+ * @brief Checks if a state reached by the window search can replace the end of the window.
+ * @param key The state reached.
+ * @param target The state after the original window.
+ * @param r The rover of the window.
+ */
+int window_reached(const StateKey *key, const StateKey *target, int r) {
+    StateKey a = *key, b = *target;
+    if (a.energy_levels[r] < b.energy_levels[r]) return 0;
+    a.energy_levels[r] = b.energy_levels[r] = 0;
+    a.recharges = b.recharges = 0;
+    return memcmp(&a, &b, sizeof(StateKey)) == 0;
+}
+
+/**
+ * @brief A lower bound on the energy from a state to the end of the window.
+ *
+ * The travel to the final position plus the energy of every sample, image,
+ * calibration and communication the state still lacks.
+ * @return The bound, or INT_MAX if the final position cannot be reached.
+ */
+int window_h(State *s, State *t, int r) {
+    int h = dist[r][s->rovers[r].position][t->rovers[r].position];
+    if (h == INT_MAX) return INT_MAX;
+
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        if (t->waypoints[wp].communicated_soil && !s->waypoints[wp].communicated_soil) h += 4;
+        if (t->waypoints[wp].communicated_rock && !s->waypoints[wp].communicated_rock) h += 4;
+        if (!t->waypoints[wp].has_soil_sample && s->waypoints[wp].has_soil_sample) h += 3;
+        if (!t->waypoints[wp].has_rock_sample && s->waypoints[wp].has_rock_sample) h += 5;
+    }
+    for (int o = 0; o < num_objectives; o++) {
+        for (int m = 0; m < num_modes; m++) {
+            if ((t->objectives[o].communicated_image & ~s->objectives[o].communicated_image) & (1 << m)) h += 6;
+            if (t->rovers[r].have_image[o][m] && !s->rovers[r].have_image[o][m]) h += 1;
+        }
+    }
+    for (int c = 0; c < num_cameras; c++) {
+        if (s->cameras[c].rover_id == r && t->cameras[c].calibrated && !s->cameras[c].calibrated) h += 2;
+    }
+    return h;
+}
+
+/**
+ * @brief Lists the actions of a rover that may be part of a replacement for the window.
+ *
+ * Samples, images and communications are only tried when the state after the
+ * window has their effect; apply_action decides whether an action is applicable.
+ * @param actions Output: the action type in element 0, then the parameters.
+ * @return The number of actions.
+ */
+int window_actions(State *s, State *t, int r, int actions[][6]) {
+    int n = 0, pos = s->rovers[r].position, lander = s->lander.lander_position;
+
+    for (int to = 0; to < num_waypoints; to++) {
+        if (to == pos || !s->rovers[r].can_traverse[pos][to]) continue;
+        int *a = actions[n++]; a[0] = 0; a[1] = r; a[2] = pos; a[3] = to;
+    }
+    { int *a = actions[n++]; a[0] = 1; a[1] = r; a[2] = pos; }
+
+    for (int st = 0; st < num_stores; st++) {
+        if (s->stores[st].rover_id != r) continue;
+        if (s->waypoints[pos].has_soil_sample && !t->waypoints[pos].has_soil_sample) {
+            int *a = actions[n++]; a[0] = 2; a[1] = r; a[2] = st; a[3] = pos;
+        }
+        if (s->waypoints[pos].has_rock_sample && !t->waypoints[pos].has_rock_sample) {
+            int *a = actions[n++]; a[0] = 3; a[1] = r; a[2] = st; a[3] = pos;
+        }
+        int *a = actions[n++]; a[0] = 4; a[1] = r; a[2] = st;
+    }
+
+    for (int c = 0; c < num_cameras; c++) {
+        if (s->cameras[c].rover_id != r) continue;
+        for (int o = 0; o < num_objectives; o++) {
+            if (s->cameras[c].calibration_targets & (1 << o)) {
+                int *a = actions[n++]; a[0] = 5; a[1] = r; a[2] = c; a[3] = o; a[4] = pos;
+            }
+            for (int m = 0; m < num_modes; m++) {
+                if (!t->rovers[r].have_image[o][m] || s->rovers[r].have_image[o][m]) continue;
+                int *a = actions[n++]; a[0] = 6; a[1] = r; a[2] = pos; a[3] = o; a[4] = c; a[5] = m;
+            }
+        }
+    }
+
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        if (t->waypoints[wp].communicated_soil && !s->waypoints[wp].communicated_soil) {
+            int *a = actions[n++]; a[0] = 7; a[1] = r; a[2] = wp; a[3] = pos; a[4] = lander;
+        }
+        if (t->waypoints[wp].communicated_rock && !s->waypoints[wp].communicated_rock) {
+            int *a = actions[n++]; a[0] = 8; a[1] = r; a[2] = wp; a[3] = pos; a[4] = lander;
+        }
+    }
+    for (int o = 0; o < num_objectives; o++) {
+        for (int m = 0; m < num_modes; m++) {
+            if (!((t->objectives[o].communicated_image & ~s->objectives[o].communicated_image) & (1 << m))) continue;
+            int *a = actions[n++]; a[0] = 9; a[1] = r; a[2] = o; a[3] = m; a[4] = pos; a[5] = lander;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Searches for a cheaper replacement of a window (bounded A*).
+ * @param start The state before the window.
+ * @param target The state after the window.
+ * @param r The rover of the window.
+ * @param bound The energy of the window; only cheaper replacements are returned.
+ * @param out Output: the actions of the replacement, in order.
+ * @param cost Output: the energy of the replacement.
+ * @return The number of actions of the replacement, or -1 if none was found.
+ */
+int window_search(State *start, State *target, int r, int bound, CompactAction *out, int *cost) {
+    static State s, next;
+    static int actions[WINDOW_ACTIONS][6];
+    StateKey target_key;
+    state_entry *closed = NULL, *entry, *tmp;
+    int count = 0, found = -1;
+
+    int h = window_h(start, target, r);
+    if (h == INT_MAX || h >= bound) return -1;
+
+    make_state_key(target, &target_key);
+    MinHeap *open = createMinHeap(256);
+    make_state_key(start, &window_nodes[0].key);
+    window_nodes[0].g = 0;
+    window_nodes[0].parent = -1;
+    insert_node(open, h, h, &window_nodes[count++]);
+
+    while (!is_empty_heap(open) && found < 0) {
+        HeapNode min = extract_min(open);
+        WindowNode *node = (WindowNode*) min.node;
+        if (min.f >= bound) break;
+
+        HASH_FIND(hh, closed, &node->key, sizeof(StateKey), entry);
+        if (entry != NULL && entry->g < node->g) continue; // Reached more cheaply since.
+
+        if (window_reached(&node->key, &target_key, r)) {
+            found = (int) (node - window_nodes);
+            break;
+        }
+
+        unpack_state_key(&node->key, start, &s);
+        int n = window_actions(&s, target, r, actions);
+        for (int i = 0; i < n && count < IMPROVE_NODES; i++) {
+            int energy_spent;
+            if (!apply_action(&s, actions[i][0], &actions[i][1], &next, &energy_spent)) continue;
+            int g = node->g + energy_spent, child_h = window_h(&next, target, r);
+            if (child_h == INT_MAX || g + child_h >= bound) continue;
+
+            WindowNode *child = &window_nodes[count];
+            make_state_key(&next, &child->key);
+            HASH_FIND(hh, closed, &child->key, sizeof(StateKey), entry);
+            if (entry != NULL && entry->g <= g) continue;
+            if (entry == NULL) {
+                entry = (state_entry*) malloc(sizeof(state_entry));
+                if (entry == NULL) break;
+                entry->key = child->key;
+                HASH_ADD(hh, closed, key, sizeof(StateKey), entry);
+            }
+            entry->g = g;
+            child->g = g;
+            child->parent = (int) (node - window_nodes);
+            child->action = compact_action_pack(actions[i][0], &actions[i][1]);
+            insert_node(open, g + child_h, child_h, child);
+            count++;
+        }
+    }
+
+    HASH_ITER(hh, closed, entry, tmp) {
+        HASH_DEL(closed, entry);
+        free(entry);
+    }
+    freeMinHeap(open);
+    if (found < 0) return -1;
+
+    int length = 0;
+    for (int i = found; window_nodes[i].parent >= 0; i = window_nodes[i].parent) length++;
+    for (int i = found, j = length; window_nodes[i].parent >= 0; i = window_nodes[i].parent) out[--j] = window_nodes[i].action;
+    *cost = window_nodes[found].g;
+    return length;
+}
+
+/**
+ * @brief Replays a plan, dropping the recharges that saved energy made inapplicable.
+ * @param init The initial state.
+ * @param codes The plan; recharges are removed from it in place.
+ * @param length In: the number of actions; out: the number left.
+ * @return The energy of the plan, or -1 if it is not applicable or does not reach the goal.
+ */
+int replay_plan(State *init, CompactAction *codes, int *length) {
+    static State current, next;
+    int params[5], energy_spent, energy = 0, kept = 0;
+
+    current = *init;
+    for (int i = 0; i < *length; i++) {
+        int action_type = compact_action_unpack(codes[i], params);
+        if (!apply_action(&current, action_type, params, &next, &energy_spent)) {
+            if (action_type == 1 && current.rovers[params[0]].energy >= 8) continue;
+            return -1;
+        }
+        energy += energy_spent;
+        codes[kept++] = codes[i];
+        current = next;
+    }
+    *length = kept;
+    return is_goal_state(&current) ? energy : -1;
+}
+
+/**
+ * @brief Tries to replace one window of a rover's actions.
+ * @param init The initial state.
+ * @param codes The plan; replaced in place when the window improves.
+ * @param length In/out: the number of actions of the plan.
+ * @param r The rover.
+ * @param first The position in the plan of the window's first action.
+ * @param size The number of actions of the rover in the window.
+ * @return The energy saved (0 if the window was kept).
+ */
+int improve_window(State *init, CompactAction *codes, int *length, int r, int first, int size) {
+    static State start, target, next;
+    static CompactAction replacement[IMPROVE_NODES], candidate[IMPROVE_NODES];
+    static int window[IMPROVE_MAX_WINDOW];
+    int params[5], energy_spent, window_energy = 0;
+
+    // The state before the window, and the state after the rover's actions of the window.
+    start = *init;
+    for (int i = 0; i < *length; i++) {
+        int action_type = compact_action_unpack(codes[i], params);
+        if (i == first) break;
+        apply_action(&start, action_type, params, &next, &energy_spent);
+        start = next;
+    }
+    target = start;
+    int taken = 0;
+    for (int i = first; i < *length && taken < size; i++) {
+        int action_type = compact_action_unpack(codes[i], params);
+        if (params[0] != r) continue;
+        if (!apply_action(&target, action_type, params, &next, &energy_spent)) return 0;
+        window_energy += energy_spent;
+        target = next;
+        window[taken++] = i;
+    }
+    if (taken < size) return 0;
+
+    int cost, n = window_search(&start, &target, r, window_energy, replacement, &cost);
+    if (n < 0) return 0;
+
+    // The replacement takes the place of the window's first action.
+    int candidate_length = 0;
+    for (int i = 0, w = 0; i < *length; i++) {
+        if (i == first) {
+            memcpy(candidate + candidate_length, replacement, n * sizeof(CompactAction));
+            candidate_length += n;
+        }
+        if (w < taken && i == window[w]) {
+            w++;
+            continue;
+        }
+        candidate[candidate_length++] = codes[i];
+    }
+
+    int old_energy = replay_plan(init, codes, length);
+    int new_energy = replay_plan(init, candidate, &candidate_length);
+    if (new_energy < 0 || new_energy >= old_energy) return 0;
+
+    memcpy(codes, candidate, candidate_length * sizeof(CompactAction));
+    *length = candidate_length;
+    return old_energy - new_energy;
+}
+
+/**
+ * @brief Improves the plan in `solution` within the time budget (see the file comment).
+ * @param init The initial state.
+ * @return 0 on success, -1 if memory is exhausted.
+ */
+int improve_plan(State *init) {
+    int length = solution_length, params[5], saved = 0, windows = 0, inserts = total_inserts;
+    clock_t started = clock();
+
+    if (length > IMPROVE_NODES / 2) {
+        printf("The plan is too long for the improvement pass.\n");
+        return 0;
+    }
+    CompactAction *codes = (CompactAction*) malloc((length > 0 ? length : 1) * sizeof(CompactAction));
+    window_nodes = (WindowNode*) malloc(IMPROVE_NODES * sizeof(WindowNode));
+    if (codes == NULL || window_nodes == NULL) {
+        printf("Memory allocation for the plan improvement failed!\n");
+        free(codes);
+        free(window_nodes);
+        return -1;
+    }
+    for (int i = 0; i < length; i++) codes[i] = solution[i].code;
+    int energy = replay_plan(init, codes, &length);
+
+    int out_of_time = 0;
+    for (int size = IMPROVE_WINDOW; size <= IMPROVE_MAX_WINDOW && !out_of_time; ) {
+        int sweep_saved = 0;
+        for (int r = 0; r < num_rovers && !out_of_time; r++) {
+            // The window starts at each action of the rover in turn.
+            for (int i = 0; i < length && !out_of_time; i++) {
+                if (compact_action_unpack(codes[i], params) < 0 || params[0] != r) continue;
+                sweep_saved += improve_window(init, codes, &length, r, i, size);
+                windows++;
+                out_of_time = (double) (clock() - started) / CLOCKS_PER_SEC > improve_seconds;
+            }
+        }
+        saved += sweep_saved;
+        if (sweep_saved == 0) size *= 2;
+    }
+
+    if (saved > 0) {
+        free(solution);
+        solution_from_codes(init, codes, length);
+    }
+    printf("Plan improvement: energy %d -> %d (saved %d) in %d windows, %.2f secs%s\n", energy, energy - saved, saved,
+           windows, (double) (clock() - started) / CLOCKS_PER_SEC, out_of_time ? " (time budget reached)" : "");
+
+    free(codes);
+    free(window_nodes);
+    window_nodes = NULL;
+    total_inserts = inserts;
+    return 0;
+}
+
+#endif // IMPROVE_H
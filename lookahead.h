@@ -0,0 +1,148 @@
+/**
+ * @file lookahead.h
+ * @brief Relaxed plan lookahead for the satisficing search (--lookahead).
+ *
+ * When a node is expanded, the actions of its relaxed plan (relaxed_plan.h) are
+ * executed one after another with apply_action, as in YAHSP. At every step the
+ * helpful actions of the current state are tried, communications first and
+ * moves last, and the first one that lowers the value of the relaxed plan is
+ * kept. This repairs the small conflicts the relaxation ignores: a rover with
+ * full stores drops one (the plan contains the drop), a rover that cannot move
+ * any more recharges, and a goal that another action already achieved is no
+ * longer in the plan. The lookahead stops at a goal state, when no helpful action
+ * lowers the value, or after LOOKAHEAD_MAX actions.
+ *
+ * The state it reaches is added to the frontier as one more child of the
+ * expanded node (see add_lookahead in planner.c), so the search can jump many
+ * steps ahead along the relaxed plan and still fall back on the normal children.
+ */
+
+#ifndef LOOKAHEAD_H
+#define LOOKAHEAD_H
+
+#include "auxiliary.h"
+#include "heuristic.h"
+#include "relaxed_plan.h"
+
+#define LOOKAHEAD_MAX 128 // Maximum number of actions of one lookahead.
+
+int lookahead = 0; // Add the lookahead state of every expanded node (--lookahead).
+
+/**
+ * @brief Applies an action if it lowers the value of the relaxed plan.
+ * @param cur The current state.
+ * @param action_type The integer ID of the action.
+ * @param params The integer parameters of the action.
+ * @param h In: the value of the current state; out: the value of the new state.
+ * @param next Output: the new state.
+ * @param action Output: the action.
+ * @return 1 if the action was kept, 0 otherwise.
+ */
+int lookahead_try(State *cur, int action_type, int *params, int *h, State *next, CompactAction *action) {
+    int energy_spent;
+    if (!apply_action(cur, action_type, params, next, &energy_spent)) return 0;
+
+    int value = relaxed_plan_heuristic(next);
+    if (value >= *h) return 0;
+    *h = value;
+    *action = compact_action_pack(action_type, params);
+    return 1;
+}
+
+/**
+ * @brief Finds the next action of the lookahead (see the file comment).
+ * @param cur The current state.
+ * @param h In: the value of the current state; out: the value of the new state.
+ * @param next Output: the state after the action.
+ * @param action Output: the action.
+ * @return 1 if an action was found, 0 if the lookahead ends here.
+ */
+int lookahead_step(State *cur, int *h, State *next, CompactAction *action) {
+    HelpfulActions helpful;
+    int lander = cur->lander.lander_position;
+
+    relaxed_plan(cur, &helpful);
+
+    for (int r = 0; r < num_rovers; r++) {
+        unsigned int types = helpful.types[r];
+        int pos = cur->rovers[r].position;
+
+        // COMMUNICATE_SOIL_DATA (7), COMMUNICATE_ROCK_DATA (8)
+        for (int wp = 0; wp < num_waypoints && (types & (3u << 7)); wp++) {
+            int params[4] = {r, wp, pos, lander};
+            if ((types & (1u << 7)) && lookahead_try(cur, 7, params, h, next, action)) return 1;
+            if ((types & (1u << 8)) && lookahead_try(cur, 8, params, h, next, action)) return 1;
+        }
+
+        // COMMUNICATE_IMAGE_DATA (9)
+        for (int obj = 0; obj < num_objectives && (types & (1u << 9)); obj++) {
+            for (int mode = 0; mode < num_modes; mode++) {
+                int params[5] = {r, obj, mode, pos, lander};
+                if (lookahead_try(cur, 9, params, h, next, action)) return 1;
+            }
+        }
+
+        for (int cam = 0; cam < num_cameras && (types & (3u << 5)); cam++) {
+            if (cur->cameras[cam].rover_id != r) continue;
+            for (int obj = 0; obj < num_objectives; obj++) {
+                // TAKE_IMAGE (6)
+                for (int mode = 0; mode < num_modes && (types & (1u << 6)); mode++) {
+                    int params[5] = {r, pos, obj, cam, mode};
+                    if (lookahead_try(cur, 6, params, h, next, action)) return 1;
+                }
+                // CALIBRATE (5)
+                int params[4] = {r, cam, obj, pos};
+                if ((types & (1u << 5)) && lookahead_try(cur, 5, params, h, next, action)) return 1;
+            }
+        }
+
+        // SAMPLE_SOIL (2), SAMPLE_ROCK (3), DROP (4)
+        for (int st = 0; st < num_stores && (types & (7u << 2)); st++) {
+            if (cur->stores[st].rover_id != r) continue;
+            int params[3] = {r, st, pos};
+            if ((types & (1u << 2)) && lookahead_try(cur, 2, params, h, next, action)) return 1;
+            if ((types & (1u << 3)) && lookahead_try(cur, 3, params, h, next, action)) return 1;
+            if ((types & (1u << 4)) && lookahead_try(cur, 4, params, h, next, action)) return 1;
+        }
+    }
+
+    // NAVIGATE (0)
+    for (int r = 0; r < num_rovers; r++) {
+        for (int to = 0; to < num_waypoints; to++) {
+            int params[3] = {r, cur->rovers[r].position, to};
+            if ((helpful.nav[r] & (1u << to)) && lookahead_try(cur, 0, params, h, next, action)) return 1;
+        }
+    }
+
+    // RECHARGE (1): a rover that has work but cannot move recharges, even though the
+    // relaxed plan already assumed it would.
+    for (int r = 0; r < num_rovers; r++) {
+        int params[2] = {r, cur->rovers[r].position}, energy_spent;
+        if (!(helpful.types[r] & (1u << 1)) || !apply_action(cur, 1, params, next, &energy_spent)) continue;
+        *h = relaxed_plan_heuristic(next);
+        *action = compact_action_pack(1, params);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Executes the relaxed plan of a state as far as it goes.
+ * @param s The state.
+ * @param plan Output: the actions executed (at most LOOKAHEAD_MAX).
+ * @return The number of actions executed.
+ */
+int lookahead_plan(State *s, CompactAction plan[LOOKAHEAD_MAX]) {
+    static _Thread_local State states[2];
+    State *cur = &states[0], *next = &states[1], *swap;
+    int h = relaxed_plan_heuristic(s), length = 0;
+
+    *cur = *s;
+    while (length < LOOKAHEAD_MAX && h != 0 && h != INT_MAX && lookahead_step(cur, &h, next, &plan[length])) {
+        swap = cur; cur = next; next = swap;
+        length++;
+    }
+    return length;
+}
+
+#endif // LOOKAHEAD_H
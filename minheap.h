@@ -1,168 +1,325 @@
-/**
- * @file minheap.h
- * @brief Implements a Min-Heap data structure for the planner's frontier.
- *
- * This file provides an efficient implementation of a priority queue using a
- * binary min-heap. The frontier of the search algorithm (the open set) is
- * stored in this data structure, which allows for logarithmic time complexity
- * for insertions and extractions of the node with the minimum f-value.
- * The heap is also dynamically resizable to handle a large number of nodes.
- */
-
-#ifndef MINHEAP_H
-#define MINHEAP_H
-
-#include <stdio.h>
-#include <stdlib.h>
-
-#include "auxiliary.h"
-
-/**
- * @struct HeapNode
- * @brief Represents a single element within the Min-Heap.
- */
-typedef struct {
-    int f;          // The f-value (priority) of the search tree node.
-    void *node;     // A void pointer to the actual search tree node (struct tree_node).
-} HeapNode;
-
-/**
- * @struct MinHeap
- * @brief The main Min-Heap data structure.
- */
-typedef struct {
-    HeapNode *nodeArray; // A dynamic array to store the heap elements.
-    int nodeSize;        // The current number of elements in the heap.
-    int capacity;        // The current allocated capacity of the array.
-} MinHeap;
-
-/**
- * @brief Creates and initializes a new Min-Heap.
- * @param capacity The initial capacity of the heap.
- * @return A pointer to the newly created MinHeap.
- */
-MinHeap* createMinHeap(int capacity) {
-    MinHeap *heap = (MinHeap*) malloc(sizeof(MinHeap));
-    heap->nodeArray = (HeapNode*) malloc(capacity * sizeof(HeapNode));
-    heap->nodeSize = 0;
-    heap->capacity = capacity;
-    return heap;
-}
-
-/**
- * @brief Doubles the capacity of the heap's internal array when it's full.
- * @param heap The heap to resize.
- */
-void resizeMinHeap(MinHeap *heap) {
-    heap->capacity *= 2;
-    heap->nodeArray = (HeapNode*) realloc(heap->nodeArray, heap->capacity * sizeof(HeapNode));
-    if (!heap->nodeArray) {
-        printf("[ERROR] Memory allocation failed during heap resize!\n");
-        exit(1);
-    }
-}
-
-/**
- * @brief Swaps two HeapNode elements. A helper function for heap operations.
- * @param a Pointer to the first node.
- * @param b Pointer to the second node.
- */
-void swapNodes(HeapNode *a, HeapNode *b) {
-    HeapNode temp = *a;
-    *a = *b;
-    *b = temp;
-}
-
-/**
- * @brief Maintains the min-heap property starting from a given index.
- *
- * This function assumes the subtrees are already min-heaps. It lets the value
- * at index `i` "float down" the heap to its correct position.
- * @param heap The heap to be heapified.
- * @param i The index to start the heapify process from.
- */
-void minHeapify(MinHeap *heap, int i) {
-    int smallest;
-    while (1) {
-        int left = 2 * i + 1;
-        int right = 2 * i + 2;
-        smallest = i;
-
-        if (left < heap->nodeSize && heap->nodeArray[left].f < heap->nodeArray[smallest].f)
-            smallest = left;
-        if (right < heap->nodeSize && heap->nodeArray[right].f < heap->nodeArray[smallest].f)
-            smallest = right;
-        if (smallest == i) break; // The node is in its correct position.
-
-        swapNodes(&heap->nodeArray[i], &heap->nodeArray[smallest]);
-        i = smallest; // Move down to the next level.
-    }
-}
-
-/**
- * @brief Inserts a new search node into the Min-Heap.
- *
- * Adds the node to the end of the array and then lets it "bubble up" to maintain
- * the min-heap property. Resizes the heap if necessary.
- * @param heap The heap to insert into.
- * @param f The f-value (priority) of the node.
- * @param node A void pointer to the search tree node.
- */
-void insert_node(MinHeap *heap, int f, void *node) {
-    if (heap->nodeSize == heap->capacity) {
-        resizeMinHeap(heap);
-    }
-
-    // Insert the new node at the end.
-    int i = heap->nodeSize;
-    heap->nodeArray[i].f = f;
-    heap->nodeArray[i].node = node;
-    heap->nodeSize++;
-
-    // Fix the min-heap property by bubbling the new node up.
-    while (i > 0 && heap->nodeArray[(i - 1) / 2].f > heap->nodeArray[i].f) {
-        swapNodes(&heap->nodeArray[i], &heap->nodeArray[(i - 1) / 2]);
-        i = (i - 1) / 2;
-    }
-
-    total_inserts++; // For statistics.
-}
-
-/**
- * @brief Extracts the node with the minimum f-value from the heap.
- *
- * The root of the min-heap always contains the element with the highest priority
- * (lowest f-value). This function returns the root, replaces it with the last
- * element, and then calls minHeapify to restore the heap property.
- * @param heap The heap from which to extract the minimum element.
- * @return The HeapNode with the minimum f-value.
- */
-HeapNode extract_min(MinHeap *heap) {
-    if (heap->nodeSize == 0) {
-        HeapNode empty_heap = {-1, NULL}; // Return an empty node if heap is empty.
-        return empty_heap;
-    }
-
-    // The root is the minimum element.
-    HeapNode root = heap->nodeArray[0];
-
-    // Replace the root with the last element.
-    heap->nodeArray[0] = heap->nodeArray[heap->nodeSize - 1];
-    heap->nodeSize--;
-
-    // Restore the min-heap property.
-    minHeapify(heap, 0);
-
-    return root;
-}
-
-/**
- * @brief Checks if the heap is empty.
- * @param heap The heap to check.
- * @return 1 if empty, 0 otherwise.
- */
-int is_empty_heap(MinHeap *heap) {
-    return heap->nodeSize == 0;
-}
-
-#endif // MINHEAP_H
+/**
+ * @file minheap.h
+ * @brief Implements a Min-Heap data structure for the planner's frontier.
+ *
+ * This file provides an efficient implementation of a priority queue using a
+ * 4-ary min-heap. The frontier of the search algorithm (the open set) is
+ * stored in this data structure, which allows for logarithmic time complexity
+ * for insertions and extractions of the node with the minimum f-value.
+ * The heap is also dynamically resizable to handle a large number of nodes.
+ *
+ * Large frontiers make heap operations memory-bound, so the layout is chosen to
+ * touch as few cache lines as possible:
+ *  - every element is 16 bytes: one 64-bit priority key (f, h and insertion
+ *    order, see heap_key) and the node pointer, so a single integer comparison
+ *    orders two elements;
+ *  - each element has four children, which halves the depth of the heap, and
+ *    the array is shifted so that the four children of an element always fill
+ *    exactly one 64-byte cache line;
+ *  - elements are moved into a "hole" instead of being swapped, and the child
+ *    blocks of the next level are prefetched while the current level is compared.
+ */
+
+#ifndef MINHEAP_H
+#define MINHEAP_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "auxiliary.h"
+
+#define HEAP_ARITY 4               // Children per element (4 x 16 bytes = one cache line).
+#define HEAP_PAD   (HEAP_ARITY - 1) // Unused slots before the root, so that child blocks are line-aligned.
+
+// Layout of the priority key, from the most significant bits down.
+#define KEY_F_BITS       24  // f-values up to 16777215 are kept exactly.
+#define KEY_H_BITS       20  // h-values up to 1048575 are kept exactly; larger values saturate.
+#define KEY_COUNTER_BITS 20  // Insertion order among equal f and h; wraps around.
+#define KEY_F_MAX        ((1ULL << KEY_F_BITS) - 1)
+#define KEY_H_MAX        ((1ULL << KEY_H_BITS) - 1)
+#define KEY_COUNTER_MASK ((1ULL << KEY_COUNTER_BITS) - 1)
+#define KEY_ORDER_F      (KEY_F_MAX << (KEY_H_BITS + KEY_COUNTER_BITS)) // Compare f only.
+#define KEY_ORDER_ALL    (~0ULL)                                         // Compare f, h, then insertion order.
+
+// The bits of the key that order two elements (--tie-break). By default the whole
+// key is compared, so equal f-values always come out in the same order: lower h
+// first, then the node inserted first. KEY_ORDER_F compares f only and takes equal
+// f-values in the order the heap happens to hold them, as the original binary heap did.
+unsigned long long heap_order = KEY_ORDER_ALL;
+int heap_lifo = 0; // Among equal f and h, take the node inserted last instead of first (--tie-break lifo).
+
+/**
+ * @struct HeapNode
+ * @brief A node together with its priority, as inserted into and extracted from the Min-Heap.
+ */
+typedef struct {
+    int f;          // The f-value (priority) of the search tree node.
+    int h;          // The h-value (tie-break with --tie-break h); saturated at KEY_H_MAX when extracted.
+    void *node;     // A void pointer to the actual search tree node (struct tree_node).
+} HeapNode;
+
+/**
+ * @struct HeapEntry
+ * @brief Represents a single element within the Min-Heap.
+ */
+typedef struct {
+    unsigned long long key; // Packed priority (see heap_key).
+    void *node;             // The search tree node.
+} HeapEntry;
+
+/**
+ * @struct MinHeap
+ * @brief The main Min-Heap data structure.
+ */
+typedef struct {
+    HeapEntry *block;    // Allocated array (cache-line aligned); element i is block[HEAP_PAD + i].
+    HeapEntry *nodeArray; // The heap elements (block + HEAP_PAD).
+    int nodeSize;        // The current number of elements in the heap.
+    int capacity;        // The current allocated capacity of the array.
+    unsigned int counter; // Insertion counter for the last tie-break.
+} MinHeap;
+
+/**
+ * @brief Allocates a cache-line aligned element array for `capacity` elements.
+ */
+HeapEntry *allocHeapBlock(int capacity) {
+    size_t bytes = (size_t) (capacity + HEAP_PAD) * sizeof(HeapEntry);
+    bytes = (bytes + 63) & ~(size_t) 63; // aligned_alloc needs a multiple of the alignment.
+    return (HeapEntry*) aligned_alloc(64, bytes);
+}
+
+/**
+ * @brief Creates and initializes a new Min-Heap.
+ * @param capacity The initial capacity of the heap.
+ * @return A pointer to the newly created MinHeap, or NULL if memory could not be allocated.
+ */
+MinHeap* createMinHeap(int capacity) {
+    MinHeap *heap = (MinHeap*) malloc(sizeof(MinHeap));
+    if (heap == NULL) return NULL;
+    heap->block = allocHeapBlock(capacity);
+    if (heap->block == NULL) {
+        free(heap);
+        return NULL;
+    }
+    heap->nodeArray = heap->block + HEAP_PAD;
+    heap->nodeSize = 0;
+    heap->capacity = capacity;
+    heap->counter = 0;
+    return heap;
+}
+
+/**
+ * @brief Frees a Min-Heap (but not the nodes it still holds).
+ * @param heap The heap to free.
+ */
+void freeMinHeap(MinHeap *heap) {
+    free(heap->block);
+    free(heap);
+}
+
+/**
+ * @brief Grows the heap's internal array so that it can hold at least `needed` elements.
+ *
+ * The capacity is doubled until it is large enough. realloc would not keep the
+ * cache-line alignment, so the elements are copied into a new aligned block.
+ * @param heap The heap to resize.
+ * @param needed The number of elements the heap must be able to hold.
+ */
+void resizeMinHeap(MinHeap *heap, int needed) {
+    int capacity = heap->capacity;
+    while (capacity < needed) capacity *= 2;
+
+    HeapEntry *block = allocHeapBlock(capacity);
+    if (!block) {
+        printf("[ERROR] Memory allocation failed during heap resize!\n");
+        exit(1);
+    }
+    memcpy(block + HEAP_PAD, heap->nodeArray, (size_t) heap->nodeSize * sizeof(HeapEntry));
+    free(heap->block);
+    heap->block = block;
+    heap->nodeArray = block + HEAP_PAD;
+    heap->capacity = capacity;
+}
+
+/**
+ * @brief Packs f, h and the insertion order into one priority key.
+ *
+ * Under the default heap_order KEY_ORDER_ALL, keys compare like the tuple (f, h,
+ * insertion order): lower f first, then lower h (the node that looks closer to the
+ * goal), then the node inserted first, or with heap_lifo the node inserted last.
+ * Under KEY_ORDER_F only f is compared, and h is only kept for extract_min.
+ */
+unsigned long long heap_key(MinHeap *heap, int f, int h) {
+    unsigned long long kf = f < 0 ? 0 : ((unsigned long long) f > KEY_F_MAX ? KEY_F_MAX : (unsigned long long) f);
+    unsigned long long kh = h < 0 ? 0 : ((unsigned long long) h > KEY_H_MAX ? KEY_H_MAX : (unsigned long long) h);
+    unsigned long long order = heap->counter++ & KEY_COUNTER_MASK;
+    if (heap_lifo) order = KEY_COUNTER_MASK - order;
+    return (kf << (KEY_H_BITS + KEY_COUNTER_BITS)) | (kh << KEY_COUNTER_BITS) | order;
+}
+
+/**
+ * @brief Returns the f-value stored in a priority key.
+ */
+int key_f(unsigned long long key) {
+    return (int) (key >> (KEY_H_BITS + KEY_COUNTER_BITS));
+}
+
+/**
+ * @brief Returns the (saturated) h-value stored in a priority key.
+ */
+int key_h(unsigned long long key) {
+    return (int) ((key >> KEY_COUNTER_BITS) & KEY_H_MAX);
+}
+
+/**
+ * @brief Moves an element up from position `i` to its place and stores it there.
+ *
+ * Parents with a larger key are shifted down into the hole left by the element,
+ * so every level costs one copy instead of a swap.
+ */
+void siftUp(MinHeap *heap, int i, HeapEntry entry) {
+    HeapEntry *a = heap->nodeArray;
+    while (i > 0) {
+        int parent = (i - 1) / HEAP_ARITY;
+        if ((a[parent].key & heap_order) <= (entry.key & heap_order)) break;
+        a[i] = a[parent];
+        i = parent;
+    }
+    a[i] = entry;
+}
+
+/**
+ * @brief Moves an element down from position `i` to its place and stores it there.
+ *
+ * At every level the smallest of the (up to four, line-aligned) children moves
+ * up into the hole. The child blocks of the next level are prefetched before the
+ * current block is compared, which hides most of the memory latency on large heaps.
+ * @param heap The heap.
+ * @param i The position of the hole.
+ * @param entry The element that has to be placed.
+ */
+void minHeapify(MinHeap *heap, int i, HeapEntry entry) {
+    HeapEntry *a = heap->nodeArray;
+    int n = heap->nodeSize;
+
+    while (1) {
+        int first = HEAP_ARITY * i + 1;
+        if (first >= n) break;
+
+        int grandchildren = HEAP_ARITY * first + 1;
+        for (int k = 0; k < HEAP_ARITY && grandchildren + HEAP_ARITY * k < n; k++) {
+            __builtin_prefetch(&a[grandchildren + HEAP_ARITY * k]);
+        }
+
+        int last = first + HEAP_ARITY < n ? first + HEAP_ARITY : n;
+        int smallest = first;
+        for (int c = first + 1; c < last; c++) {
+            if ((a[c].key & heap_order) < (a[smallest].key & heap_order)) smallest = c;
+        }
+        if ((a[smallest].key & heap_order) >= (entry.key & heap_order)) break; // The element belongs in the hole.
+
+        a[i] = a[smallest];
+        i = smallest; // Move down to the next level.
+    }
+    a[i] = entry;
+}
+
+/**
+ * @brief Inserts a new search node into the Min-Heap.
+ *
+ * Adds the node to the end of the array and then lets it "bubble up" to maintain
+ * the min-heap property. Resizes the heap if necessary.
+ * @param heap The heap to insert into.
+ * @param f The f-value (priority) of the node.
+ * @param h The h-value of the node (tie-break).
+ * @param node A void pointer to the search tree node.
+ */
+void insert_node(MinHeap *heap, int f, int h, void *node) {
+    if (heap->nodeSize == heap->capacity) {
+        resizeMinHeap(heap, heap->nodeSize + 1);
+    }
+
+    HeapEntry entry = {heap_key(heap, f, h), node};
+    siftUp(heap, heap->nodeSize++, entry);
+
+    total_inserts++; // For statistics.
+}
+
+/**
+ * @brief Inserts several search nodes at once (e.g. all children of one expansion).
+ *
+ * The array is resized at most once, and the new elements are sifted up one
+ * after the other; their paths to the root share most of their cache lines.
+ * @param heap The heap to insert into.
+ * @param batch The nodes with their priorities.
+ * @param count The number of nodes.
+ */
+void insert_nodes(MinHeap *heap, HeapNode *batch, int count) {
+    if (heap->nodeSize + count > heap->capacity) {
+        resizeMinHeap(heap, heap->nodeSize + count);
+    }
+
+    for (int i = 0; i < count; i++) {
+        HeapEntry entry = {heap_key(heap, batch[i].f, batch[i].h), batch[i].node};
+        siftUp(heap, heap->nodeSize++, entry);
+    }
+
+    total_inserts += count; // For statistics.
+}
+
+/**
+ * @brief Extracts the node with the minimum f-value from the heap.
+ *
+ * The root of the min-heap always contains the element with the highest priority
+ * (lowest f-value). This function returns the root, takes the last element out,
+ * and then calls minHeapify to place it starting from the now empty root.
+ * @param heap The heap from which to extract the minimum element.
+ * @return The HeapNode with the minimum f-value.
+ */
+HeapNode extract_min(MinHeap *heap) {
+    if (heap->nodeSize == 0) {
+        HeapNode empty_heap = {-1, 0, NULL}; // Return an empty node if heap is empty.
+        return empty_heap;
+    }
+
+    // The root is the minimum element.
+    HeapEntry root = heap->nodeArray[0];
+    HeapNode min = {key_f(root.key), key_h(root.key), root.node};
+
+    // Restore the min-heap property with the last element.
+    heap->nodeSize--;
+    if (heap->nodeSize > 0) {
+        minHeapify(heap, 0, heap->nodeArray[heap->nodeSize]);
+    }
+
+    return min;
+}
+
+/**
+ * @brief Returns the f-value of the minimum element without removing it.
+ * @param heap The heap (must not be empty).
+ */
+int peek_min_f(MinHeap *heap) {
+    return key_f(heap->nodeArray[0].key);
+}
+
+/**
+ * @brief Returns the node stored at position `i` of the heap array (0 <= i < nodeSize).
+ *
+ * Used to visit all nodes of the heap, in no particular order.
+ */
+void *heap_node_at(MinHeap *heap, int i) {
+    return heap->nodeArray[i].node;
+}
+
+/**
+ * @brief Checks if the heap is empty.
+ * @param heap The heap to check.
+ * @return 1 if empty, 0 otherwise.
+ */
+int is_empty_heap(MinHeap *heap) {
+    return heap->nodeSize == 0;
+}
+
+#endif // MINHEAP_H
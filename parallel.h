@@ -0,0 +1,239 @@
+/**
+ * @file parallel.h
+ * @brief Worker queues for the multi-threaded (work-stealing) search.
+ *
+ * In multi-threaded mode every search thread owns a Worker: a local Min-Heap
+ * protected by its own mutex, plus the f-value of its best node, published so
+ * that other threads can decide whom to steal from without taking any lock.
+ * A worker normally pops from its own heap. When the heap runs dry, or when its
+ * best node lags far behind the best node of some other worker, it steals a
+ * small batch of that worker's best nodes instead. Duplicate detection is shared
+ * between all workers through a ConcurrentSet (see concurrent_set.h).
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "auxiliary.h"
+#include "minheap.h"
+#include "concurrent_set.h"
+#include "hcache.h"
+
+#define MAX_THREADS CSET_MAX_THREADS // Maximum number of search threads.
+#define STEAL_LAG   16   // A worker steals when its best f is this much worse than the global best.
+#define STEAL_BATCH 8    // Maximum number of nodes moved by a single steal.
+#define EMPTY_F     1000000000 // Published f-value of a worker with an empty heap.
+
+/**
+ * @struct Worker
+ * @brief Per-thread search state in multi-threaded mode.
+ */
+typedef struct {
+    pthread_mutex_t lock;   // Protects heap.
+    MinHeap *heap;          // The worker's local frontier.
+    _Atomic int top_f;      // f-value of the heap's minimum (EMPTY_F when empty).
+    int id;                 // Thread index, also used for the closed set statistics.
+    pthread_t thread;       // The thread running this worker.
+    long long steals;       // Successful steals.
+    long long stolen_nodes; // Nodes obtained by stealing.
+    int inserts, extracts;  // Copies of the thread-local heap statistics at exit.
+    HCacheStats h_stats;    // Copy of the thread-local heuristic cache statistics at exit.
+} Worker;
+
+Worker workers[MAX_THREADS];     // The worker pool.
+int num_workers = 0;             // Number of workers in the pool.
+_Atomic int idle_workers;        // Workers that found no node to expand.
+_Atomic int search_done;         // Set when a solution is found or the search is exhausted.
+_Atomic(struct tree_node *) parallel_solution; // The first solution found by any worker.
+
+/**
+ * @brief Publishes the f-value of the heap's minimum. Called with the lock held.
+ */
+void worker_publish_top(Worker *w) {
+    int f = is_empty_heap(w->heap) ? EMPTY_F : peek_min_f(w->heap);
+    atomic_store_explicit(&w->top_f, f, memory_order_relaxed);
+}
+
+/**
+ * @brief Initializes the worker pool.
+ * @param count The number of workers.
+ * @return 0 on success, -1 if memory could not be allocated.
+ */
+int init_workers(int count) {
+    num_workers = count;
+    atomic_init(&idle_workers, 0);
+    atomic_init(&search_done, 0);
+    atomic_init(&parallel_solution, NULL);
+    for (int i = 0; i < count; i++) {
+        Worker *w = &workers[i];
+        memset(w, 0, sizeof(Worker));
+        pthread_mutex_init(&w->lock, NULL);
+        w->heap = createMinHeap(1000);
+        if (w->heap == NULL) return -1;
+        w->id = i;
+        atomic_init(&w->top_f, EMPTY_F);
+    }
+    return 0;
+}
+
+/**
+ * @brief Releases the heaps and locks of the worker pool.
+ */
+void free_workers() {
+    for (int i = 0; i < num_workers; i++) {
+        pthread_mutex_destroy(&workers[i].lock);
+        freeMinHeap(workers[i].heap);
+    }
+    num_workers = 0;
+}
+
+/**
+ * @brief Pushes a node into a worker's heap.
+ */
+void worker_push(Worker *w, int f, int h, void *node) {
+    pthread_mutex_lock(&w->lock);
+    insert_node(w->heap, f, h, node);
+    worker_publish_top(w);
+    pthread_mutex_unlock(&w->lock);
+}
+
+/**
+ * @brief Pushes several nodes into a worker's heap under a single lock acquisition.
+ */
+void worker_push_batch(Worker *w, HeapNode *batch, int count) {
+    pthread_mutex_lock(&w->lock);
+    insert_nodes(w->heap, batch, count);
+    worker_publish_top(w);
+    pthread_mutex_unlock(&w->lock);
+}
+
+/**
+ * @brief Pops the best node of a worker's own heap.
+ * @return The node, or NULL if the heap is empty.
+ */
+void *worker_pop(Worker *w) {
+    void *node = NULL;
+    pthread_mutex_lock(&w->lock);
+    if (!is_empty_heap(w->heap)) {
+        node = extract_min(w->heap).node;
+        worker_publish_top(w);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return node;
+}
+
+/**
+ * @brief Finds the worker (other than `self`) whose best node has the lowest f.
+ * @param best_f Output parameter for that f-value.
+ * @return The worker, or NULL if all other heaps look empty.
+ */
+Worker *find_victim(Worker *self, int *best_f) {
+    Worker *victim = NULL;
+    *best_f = EMPTY_F;
+    for (int i = 0; i < num_workers; i++) {
+        if (&workers[i] == self) continue;
+        int f = atomic_load_explicit(&workers[i].top_f, memory_order_relaxed);
+        if (f < *best_f) {
+            *best_f = f;
+            victim = &workers[i];
+        }
+    }
+    return victim;
+}
+
+/**
+ * @brief Moves up to STEAL_BATCH of the victim's best nodes into the thief's heap.
+ *
+ * The nodes are first taken out under the victim's lock and then inserted under
+ * the thief's lock, so the two locks are never held together.
+ * @return The number of nodes stolen.
+ */
+int worker_steal(Worker *thief, Worker *victim) {
+    HeapNode batch[STEAL_BATCH];
+    int count = 0;
+
+    pthread_mutex_lock(&victim->lock);
+    // Leave the victim at least half of its nodes.
+    int limit = victim->heap->nodeSize / 2;
+    if (limit < 1) limit = victim->heap->nodeSize;
+    if (limit > STEAL_BATCH) limit = STEAL_BATCH;
+    while (count < limit) batch[count++] = extract_min(victim->heap);
+    worker_publish_top(victim);
+    pthread_mutex_unlock(&victim->lock);
+
+    if (count == 0) return 0;
+
+    pthread_mutex_lock(&thief->lock);
+    insert_nodes(thief->heap, batch, count);
+    worker_publish_top(thief);
+    pthread_mutex_unlock(&thief->lock);
+
+    thief->steals++;
+    thief->stolen_nodes += count;
+    return count;
+}
+
+/**
+ * @brief Selects the next node for a worker to expand.
+ *
+ * Pops from the worker's own heap unless it is empty or its best f lags more
+ * than STEAL_LAG behind the best f published by another worker, in which case
+ * it steals first. When no node can be found anywhere, the worker counts itself
+ * as idle; once every worker is idle, the search space is exhausted.
+ * @param w The calling worker.
+ * @return The node to expand, or NULL when the search is over.
+ */
+void *worker_next(Worker *w) {
+    int idle = 0;
+
+    while (!atomic_load_explicit(&search_done, memory_order_acquire)) {
+        int own_f = atomic_load_explicit(&w->top_f, memory_order_relaxed);
+        int victim_f;
+        Worker *victim = find_victim(w, &victim_f);
+
+        if (victim != NULL && (own_f == EMPTY_F || victim_f + STEAL_LAG < own_f)) {
+            // An idle worker stops counting as idle before it takes any node, so
+            // "all workers idle" always implies that no node is in transit.
+            if (idle) {
+                atomic_fetch_sub(&idle_workers, 1);
+                idle = 0;
+            }
+            worker_steal(w, victim);
+        }
+
+        void *node = worker_pop(w);
+        if (node != NULL) {
+            if (idle) atomic_fetch_sub(&idle_workers, 1);
+            return node;
+        }
+
+        if (!idle) {
+            idle = 1;
+            atomic_fetch_add(&idle_workers, 1);
+        }
+        if (atomic_load(&idle_workers) == num_workers) {
+            atomic_store_explicit(&search_done, 1, memory_order_release);
+            break;
+        }
+        sched_yield();
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Records a solution found by a worker and stops all workers.
+ *
+ * Only the first solution is kept; later ones are ignored.
+ */
+void report_parallel_solution(struct tree_node *node) {
+    struct tree_node *expected = NULL;
+    atomic_compare_exchange_strong(&parallel_solution, &expected, node);
+    atomic_store_explicit(&search_done, 1, memory_order_release);
+}
+
+#endif // PARALLEL_H
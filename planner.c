@@ -1,728 +1,1923 @@
-/**
- * @file planner.c
- * @brief Main file for the domain-dependent planner.
- *
- * This file contains the core implementation of the search algorithm (A* and Best-First Search),
- * the duplicate detection mechanism using a Hash Table, the node expansion logic,
- * and the main program flow management.
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-
-// --- Include custom header files ---
-#include "parser.h"       // Logic for parsing the PDDL problem file.
-#include "auxiliary.h"    // Auxiliary data structures (State, Rover, Waypoint, etc.).
-#include "minheap.h"      // Min-Heap implementation for the frontier.
-#include "heuristic.h"    // Heuristic function implementations.
-#include "solution.h"     // Functions for extracting and writing the solution.
-#include "uthash.h"       // External library for Hash Table management.
-#include "bloom.h"        // Library for Bloom Filter management.
-
-// --- Constants for algorithm selection ---
-#define best	1   // Represents the Best-First Search algorithm.
-#define astar	2   // Represents the A* algorithm.
-
-#define TIMEOUT	 600	// Maximum execution time in seconds.
-
-/**
- * @struct StateKey
- * @brief A compact, "flat" representation of a State.
- *
- * This structure is used as the key for the Hash Table. It converts the complex
- * data from the main State struct into a combination of simple integers and bitmaps,
- * enabling efficient comparison and storage of visited states.
- */
-typedef struct {
-    int rover_positions[MAX_ROVERS];
-    int energy_levels[MAX_ROVERS];
-    int has_soil_analysis;          // Bitmap
-    int has_rock_analysis;          // Bitmap
-    unsigned int have_image_bm[MAX_ROVERS]; // Bitmap for images
-    int has_soil_sample;            // Bitmap
-    int has_rock_sample;            // Bitmap
-    int communicated_soil_sample;   // Bitmap
-    int communicated_rock_sample;   // Bitmap
-    int cameras_calibrated;         // Bitmap
-    int full_stores;                // Bitmap
-    int communicated_image;         // Bitmap
-    int recharges;
-} StateKey;
-
-/**
- * @struct state_entry
- * @brief Entry structure for the Hash Table (using uthash).
- *
- * Contains the state key (StateKey) and the necessary handle (hh)
- * required by the uthash library to manage hash entries.
- */
-typedef struct  {
-    StateKey key;
-    UT_hash_handle hh; // Handle used by uthash
-} state_entry;
-
-// --- Global Variables ---
-state_entry *state_set = NULL; // The Hash Table storing the closed set of states.
-BloomFilter *bf;               // Pointer to the Bloom Filter (optional mechanism).
-MinHeap *frontier;             // The search frontier (open set), implemented as a Min-Heap.
-time_t t1;                     // Search start time for timeout checking.
-clock_t c1, c2;                // Variables for measuring CPU time.
-
-/**
- * @brief Creates a compact StateKey from a full State struct.
- * @param s The full State to be converted.
- * @param key The resulting StateKey.
- */
-void make_state_key(State *s, StateKey *key) {
-    memset(key, 0, sizeof(StateKey));
-
-    // Convert dynamic information into bitmaps for a compact representation.
-    for (int r = 0; r < num_rovers; r++) {
-        key->rover_positions[r] = s->rovers[r].position;
-        key->energy_levels[r] = s->rovers[r].energy;
-        if (s->rovers[r].has_soil_analysis) key->has_soil_analysis |= (1 << r);
-        if (s->rovers[r].has_rock_analysis) key->has_rock_analysis |= (1 << r);
-        for (int o = 0; o < num_objectives; o++) {
-            for (int m = 0; m < num_modes; m++) {
-                if (s->rovers[r].have_image[o][m]) {
-                    key->have_image_bm[r] |= (1U << (o * num_modes + m));
-                }
-            }
-        }
-    }
-
-    for (int w = 0; w < num_waypoints; w++) {
-        if (s->waypoints[w].has_soil_sample) key->has_soil_sample |= (1 << w);
-        if (s->waypoints[w].has_rock_sample) key->has_rock_sample |= (1 << w);
-        if (s->waypoints[w].communicated_soil) key->communicated_soil_sample |= (1 << w);
-        if (s->waypoints[w].communicated_rock) key->communicated_rock_sample |= (1 << w);
-    }
-
-    for (int c = 0; c < num_cameras; c++) {
-        if (s->cameras[c].calibrated) key->cameras_calibrated |= (1 << c);
-    }
-
-    for (int st = 0; st < num_stores; st++) {
-        if (s->stores[st].is_full) key->full_stores |= (1 << st);
-    }
-
-    for (int o = 0; o < num_objectives; o++) {
-        if (s->objectives[o].communicated_image) key->communicated_image |= (1 << o);
-    }
-
-    key->recharges = s->recharges;
-}
-
-/**
- * @brief Adds a new state key to the Hash Table (closed set).
- * @param key The key to be added.
- */
-void add_to_state_set(StateKey *key) {
-    state_entry *entry = malloc(sizeof(state_entry));
-    entry->key = *key;
-    HASH_ADD(hh, state_set, key, sizeof(StateKey), entry);
-}
-
-/**
- * @brief Checks if a state key already exists in the Hash Table.
- * @param key The key to check.
- * @return 1 if the state exists, 0 otherwise.
- */
-int state_exists(StateKey *key) {
-    state_entry *entry;
-    HASH_FIND(hh, state_set, key, sizeof(StateKey), entry);
-    return (entry != NULL);
-}
-
-/**
- * @brief Initializes the Bloom Filter.
- */
-void initialize_bloom() {
-    bf = bloom_create(2000000, 0.01);
-    if (!bf) {
-        printf("Failed to initialize bloom filter\n");
-        exit(1);
-    }
-}
-
-/**
- * @brief Checks a new node for duplicate states to detect loops.
- *
- * This function creates a key for the node's state and checks if it exists
- * in the closed set (Hash Table). We can use additionaly a bloom filter check, for more security.
- * If not, it adds it.
- * @param node The search tree node to check.
- * @return 1 if the state is new (no loop), 0 if a loop is detected.
- */
-int check_with_parents(struct tree_node *node) {
-    StateKey sk;
-    make_state_key(&node->currState, &sk);
-
-    // Using the key directly now
-    //if (bloom_check(bf, &sk, sizeof(StateKey))) {
-        if (state_exists(&sk)) {
-            return 0; // Loop detected
-        }
-    //}
-
-    //bloom_add(bf, &sk, sizeof(StateKey));
-    add_to_state_set(&sk);
-    return 1; // No loop
-}
-
-/**
- * @brief Checks if the search has exceeded the predefined timeout.
- */
-void check_timeout() {
-    if (difftime(time(NULL), t1) > TIMEOUT) {
-        printf("Timeout reached. Aborting...\n");
-        printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
-        exit(1);
-    }
-}
-
-/**
- * @brief Displays a syntax message for incorrect command-line arguments.
- */
-void syntax_message() {
-	printf("planner <method> <input-file> <output-file>\n\n");
-	printf("where: ");
-	printf("<method> = best|astar\n");
-	printf("<input-file> is a file containing a PDDL problem description.\n");
-	printf("<output-file> is the file where the solution will be written.\n");
-}
-
-/**
- * @brief Parses the search method from command-line arguments.
- * @param s The string argument representing the method.
- * @return The integer constant for the method, or -1 if invalid.
- */
-int get_method(char* s) {
-    if (strcmp(s,"best")==0) return best;
-    if (strcmp(s,"astar")==0) return astar;
-    return -1;
-}
-
-/**
- * @brief Adds a new search tree node to the frontier (Min-Heap).
- * @param node The node to be added.
- * @return 0 on success.
- */
-int add_frontier_in_order(struct tree_node *node) {
-    insert_node(frontier, node->f, node);
-    return 0;
-}
-
-/**
- * @brief Generates the PDDL parameter name for a given action parameter index.
- * @param child The child node being created.
- * @param param The integer value of the parameter (e.g., waypoint ID).
- * @param index The position of the parameter in the action's signature.
- */
-void get_param_name(struct tree_node *child, int param, int index) {
-    switch(child->action_taken.action_type){
-        case 0:
-        case 1:
-        {
-            sprintf(child->action_taken.param_names[index], "waypoint%d", param);
-            break;
-        }
-        case 2:
-        case 3:
-        {
-            switch(index) {
-               case 1:
-               {
-                    sprintf(child->action_taken.param_names[index], "store%d", param);
-                    break;
-               }
-               default:
-               {
-                   sprintf(child->action_taken.param_names[index], "waypoint%d", param);
-                   break;
-               }
-
-            }
-            break;
-        }
-        case 4:
-        {
-            sprintf(child->action_taken.param_names[index], "store%d", param);
-            break;
-        }
-        case 5:
-        {
-            switch(index) {
-               case 1:
-               {
-                    sprintf(child->action_taken.param_names[index], "camera%d", param);
-                    break;
-               }
-               case 2:
-               {
-                   sprintf(child->action_taken.param_names[index], "objective%d", param);
-                   break;
-               }
-               default:
-               {
-                   sprintf(child->action_taken.param_names[index], "waypoint%d", param);
-                   break;
-               }
-            }
-            break;
-        }
-        case 6:
-        {
-            switch(index) {
-               case 1:
-               {
-                    sprintf(child->action_taken.param_names[index], "waypoint%d", param);
-                    break;
-               }
-               case 2:
-               {
-                   sprintf(child->action_taken.param_names[index], "objective%d", param);
-                   break;
-               }
-               case 3:
-               {
-                   sprintf(child->action_taken.param_names[index], "camera%d", param);
-                   break;
-               }
-               default:
-               {
-                   switch (param){
-                       case 0:
-                       {
-                           sprintf(child->action_taken.param_names[index], "colour");
-                           break;
-                       }
-                       case 1:
-                       {
-                           sprintf(child->action_taken.param_names[index], "high_res");
-                           break;
-                       }
-                       default:
-                       {
-                           sprintf(child->action_taken.param_names[index], "low_res");
-                           break;
-                       }
-                   }
-                   break;
-               }
-            }
-            break;
-        }
-        case 7:
-        case 8:
-        {
-            sprintf(child->action_taken.param_names[index], "waypoint%d", param);
-            break;
-        }
-        default:
-        {
-            switch(index) {
-               case 1:
-               {
-                   sprintf(child->action_taken.param_names[index], "objective%d", param);
-                   break;
-               }
-               case 2:
-               {
-                   switch (param){
-                       case 0:
-                       {
-                           sprintf(child->action_taken.param_names[index], "colour");
-                           break;
-                       }
-                       case 1:
-                       {
-                           sprintf(child->action_taken.param_names[index], "high_res");
-                           break;
-                       }
-                       default:
-                       {
-                           sprintf(child->action_taken.param_names[index], "low_res");
-                           break;
-                       }
-                   }
-                   break;
-               }
-               default:
-               {
-                   sprintf(child->action_taken.param_names[index], "waypoint%d", param);
-                   break;
-               }
-            }
-            break;
-        }
-
-    }
-}
-/**
- * @brief Adds a new child node to the search tree.
- *
- * This function sets the child's properties (parent, depth, g-cost),
- * checks for loops, calculates its heuristic and f-values, and adds it to the frontier.
- * @return 0 on success, -1 on memory error.
- */
-int add_child(struct tree_node *current_node, int action_type, struct tree_node *child, int method, int *params, int param_count, int energy_spent){
-    int err = 0;
-
-    child->parent = current_node;
-    child->depth = current_node->depth + 1;
-    child->g = current_node->g + energy_spent;
-    child->action_taken.action_type = action_type;
-    child->action_taken.num_params = param_count;
-    sprintf(child->action_taken.param_names[0], "rover%d", params[0]);
-    for (int i=1; i<param_count; i++){
-        get_param_name(child, params[i], i);
-    }
-    switch (action_type) {
-       case 7:
-       case 8:
-       case 9:
-       {
-            sprintf(child->action_taken.param_names[5], "general");
-            child->action_taken.num_params++;
-            break;
-       }
-    }
-
-    if(!check_with_parents(child)){
-        free(child);
-        child = NULL;
-    }
-    else {
-        child->h=heuristic(child->currState);
-        if (method==best) {
-            child->f = child->h;
-        }
-        else {
-            child->f = child->h + child->g;
-        }
-
-        err = add_frontier_in_order(child);
-    }
-
-    return err;
-}
-
-// Helper function to safely create and try to add a child node
-int try_add_child(struct tree_node *parent_node, int action_type, int *params, int param_count, int method) {
-    step_count++;
-    if (step_count % 1000 == 0) {
-        check_timeout();
-    }
-
-    struct tree_node *child = malloc(sizeof(struct tree_node));
-    if (child == NULL) return -1;
-
-    int energy_spent;
-
-    if (apply_action(&parent_node->currState, action_type, params, &child->currState, &energy_spent)) {
-        int err = add_child(parent_node, action_type, child, method, params, param_count, energy_spent);
-        if (err < 0) return -1;
-    } else {
-        free(child);
-    }
-
-    return 0;
-}
-
-// Helper function to try actions that require 2 parameters
-int try_two_param_action(struct tree_node *node, int rover, int param2, int action_type, int method) {
-    int params[2] = {rover, param2};
-    return try_add_child(node, action_type, params, 2, method);
-}
-
-// Helper function to try actions that require 3 parameters
-int try_three_param_action(struct tree_node *node, int rover, int param2, int param3, int action_type, int method) {
-    int params[3] = {rover, param2, param3};
-    return try_add_child(node, action_type, params, 3, method);
-}
-
-// Helper function to try actions that require 4 parameters
-int try_four_param_action(struct tree_node *node, int rover, int param2, int param3, int param4,
-                         int action_type, int method) {
-    int params[4] = {rover, param2, param3, param4};
-    return try_add_child(node, action_type, params, 4, method);
-}
-
-// Helper function to try actions that require 5 parameters
-int try_five_param_action(struct tree_node *node, int rover, int param2, int param3, int param4,
-                         int param5, int action_type, int method) {
-    int params[5] = {rover, param2, param3, param4, param5};
-    return try_add_child(node, action_type, params, 5, method);
-}
-/**
- * @brief Expands a node by generating all its possible successor states (children).
- *
- * This is the core function for generating the search tree. It iterates through all
- * possible actions for all rovers and creates new child nodes for each valid action.
- * Extensive pruning is used to avoid generating obviously invalid or unhelpful states.
- * @param current_node The node to expand.
- * @param method The search algorithm being used (astar or best).
- * @return 1 on success, -1 on memory error.
- */
-int find_children(struct tree_node *current_node, int method) {
-    State *s = &current_node->currState;
-    int rover, store, cam, wp, wp2, obj, mode, pos;
-    int lander_pos = s->lander.lander_position;
-
-    for (rover = 0; rover < num_rovers; rover++) {
-        if (!s->rovers[rover].available) {
-            continue;
-        }
-
-        pos = s->rovers[rover].position;
-
-        // RECHARGE (1)
-        if (s->waypoints[pos].in_sun && s->rovers[rover].energy < 8) {
-            if (try_two_param_action(current_node, rover, pos, 1, method) < 0) return -1;
-        }
-
-        // SAMPLE_SOIL (2)
-        if (s->rovers[rover].equipped_soil && s->rovers[rover].energy >= 3 &&
-            goal.communicated_soil_data[pos] && !s->waypoints[pos].communicated_soil &&
-            s->waypoints[pos].has_soil_sample) {
-            for (store = 0; store < num_stores; store++) {
-                if (s->stores[store].rover_id == rover && !s->stores[store].is_full) {
-                    if (try_three_param_action(current_node, rover, store, pos, 2, method) < 0) return -1;
-                }
-            }
-        }
-
-        // SAMPLE_ROCK (3)
-        if (s->rovers[rover].equipped_rock && s->rovers[rover].energy >= 5 &&
-            goal.communicated_rock_data[pos] && !s->waypoints[pos].communicated_rock &&
-            s->waypoints[pos].has_rock_sample) {
-            for (store = 0; store < num_stores; store++) {
-                // ΚΛΑΔΕΜΑ: Το store πρέπει να ανήκει στο rover και να είναι άδειο.
-                if (s->stores[store].rover_id == rover && !s->stores[store].is_full) {
-                    if (try_three_param_action(current_node, rover, store, pos, 3, method) < 0) return -1;
-                }
-            }
-        }
-
-        if (s->rovers[rover].equipped_imaging) {
-            for (cam = 0; cam < num_cameras; cam++) {
-                if (s->cameras[cam].rover_id != rover) continue;
-
-                for (obj = 0; obj < num_objectives; obj++) {
-                    // CALIBRATE (5)
-                    if (s->rovers[rover].energy >= 2 &&
-                        (s->objectives[obj].visible_waypoints & (1 << pos)) &&
-                        (s->cameras[cam].calibration_targets & (1 << obj))) {
-                        if (try_four_param_action(current_node, rover, cam, obj, pos, 5, method) < 0) return -1;
-                    }
-
-                    // TAKE_IMAGE (6)
-                    for (mode = 0; mode < num_modes; mode++) {
-                        if (s->cameras[cam].calibrated &&
-                            s->rovers[rover].energy >= 1 &&
-                            (s->cameras[cam].modes_supported & (1 << mode)) &&
-                            (s->objectives[obj].visible_waypoints & (1 << pos)) &&
-                            goal.communicated_image_data[obj][mode] &&
-                            !(s->objectives[obj].communicated_image & (1 << mode))) {
-                            if (try_five_param_action(current_node, rover, pos, obj, cam, mode, 6, method) < 0) return -1;
-                        }
-                    }
-                }
-            }
-        }
-
-        if (s->lander.channel_free && (s->waypoints[pos].visible_waypoints & (1 << lander_pos))) {
-            // COMMUNICATE_SOIL_DATA (7)
-            if (s->rovers[rover].energy >= 4) {
-                for (wp = 0; wp < num_waypoints; wp++) {
-                    if (goal.communicated_soil_data[wp] &&
-                        !s->waypoints[wp].communicated_soil &&
-                        (s->rovers[rover].has_soil_analysis & (1 << wp))) {
-                        if (try_four_param_action(current_node, rover, wp, pos, lander_pos, 7, method) < 0) return -1;
-                    }
-                }
-            }
-
-            // COMMUNICATE_ROCK_DATA (8)
-            if (s->rovers[rover].energy >= 4) {
-                for (wp = 0; wp < num_waypoints; wp++) {
-                    if (goal.communicated_rock_data[wp] &&
-                        !s->waypoints[wp].communicated_rock &&
-                        (s->rovers[rover].has_rock_analysis & (1 << wp))) {
-                        if (try_four_param_action(current_node, rover, wp, pos, lander_pos, 8, method) < 0) return -1;
-                    }
-                }
-            }
-
-            // COMMUNICATE_IMAGE_DATA (9)
-            if (s->rovers[rover].energy >= 6) {
-                for (obj = 0; obj < num_objectives; obj++) {
-                    for (mode = 0; mode < num_modes; mode++) {
-                        if (goal.communicated_image_data[obj][mode] &&
-                            !(s->objectives[obj].communicated_image & (1 << mode)) &&
-                            s->rovers[rover].have_image[obj][mode]) {
-                            if (try_five_param_action(current_node, rover, obj, mode, pos, lander_pos, 9, method) < 0) return -1;
-                        }
-                    }
-                }
-            }
-        }
-
-        // DROP (4)
-        for (store = 0; store < num_stores; store++) {
-            if (s->stores[store].rover_id == rover && s->stores[store].is_full) {
-                if (try_two_param_action(current_node, rover, store, 4, method) < 0) return -1;
-            }
-        }
-
-        // NAVIGATE (0)
-        for (wp2 = 0; wp2 < num_waypoints; wp2++) {
-            if (pos != wp2 &&
-                s->rovers[rover].energy >= 8 &&
-                (s->waypoints[pos].visible_waypoints & (1 << wp2)) &&
-                s->rovers[rover].can_traverse[pos][wp2]) {
-                if (try_three_param_action(current_node, rover, pos, wp2, 0, method) < 0) return -1;
-            }
-        }
-    }
-
-    return 1; // Process completed!
-}
-
-
-/**
- * @brief Initializes the search process.
- *
- * Creates the root node of the search tree from the initial state,
- * initializes the frontier (Min-Heap), and adds the root node to it.
- * Also precomputes shortest paths.
- * @param initState The initial state of the problem.
- * @param method The search algorithm to be used.
- */
-void initialize_search(State initState, int method)
-{
-	struct tree_node *root=NULL;	// the root of the search tree.
-
-	precompute_shortest_paths(&initState);
-
-	//initialize_bloom();
-
-	//Initialize frontier
-	frontier = createMinHeap(1000);
-
-	// Initialize search tree
-	root=(struct tree_node*) malloc(sizeof(struct tree_node));
-	root->parent=NULL;
-	root->action_taken.action_type=-1;
-    root->currState=initState;
-    root->depth = 0;
-
-	root->g=0;
-	root->h=heuristic(root->currState);
-	if (method==best)
-		root->f=root->h;
-	else
-		root->f=root->g+root->h;
-
-	// Add the initial root to the frontier
-	add_frontier_in_order(root);
-}
-
-/**
- * @brief The main search loop.
- *
- * Implements the Search algorithms framework. It repeatedly extracts
- * the most promising node from the frontier, checks if it's a solution,
- * and expands it to generate its children.
- * @param method The search algorithm (astar or best).
- * @return A pointer to the solution node, or NULL if no solution is found.
- */
-struct tree_node *search(int method) {
-	struct tree_node *current_node;
-
-	while (!is_empty_heap(frontier))
-	{
-		// Extract the best node from the frontier
-		HeapNode minNode = extract_min(frontier);
-		total_extracts++;
-        current_node = (struct tree_node*) minNode.node;
-
-		if (is_solution(current_node->currState)){
-            printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
-		    free(frontier->nodeArray);
-            free(frontier);
-            return current_node;
-		}
-
-		// Expand the current node to find its children
-		int err=find_children(current_node, method);
-
-		if (err<0){
-            printf("Memory exhausted while creating new frontier node. Search is terminated...\n");
-            return NULL;
-        }
-	}
-
-	return NULL;
-}
-
-/**
- * @brief Main entry point of the program.
- *
- * Handles command-line argument parsing, calls the PDDL parser,
- * initiates the search, and prints the final solution and statistics.
- */
-int main(int argc, char** argv) {
-    if (argc!=4) {
-		printf("Wrong number of arguments. Use correct syntax:\n");
-		syntax_message();
-		return -1;
-	}
-
-	int method=get_method(argv[1]); // The search algorithm that will be used to solve the problem.
-	if (method<0) {
-		printf("Wrong method. Use correct syntax:\n");
-		syntax_message();
-		return -1;
-	}
-
-	// Parse the PDDL problem file to get the initial state
-	State *initial_state = parse_pddl_file(argv[2]);
-	if (initial_state == NULL) {
-        return -1;
-	}
-
-	printf("Solving %s using %s...\n",argv[2],argv[1]);
-	c1 = clock();
-	t1 = time(NULL);
-
-	// Set up the initial data structures for the search
-	initialize_search(*initial_state, method);
-
-	// Start the main search loop
-	struct tree_node *solution_node = search(method);
-
-	c2 = clock();
-
-	// Clean up memory
-	//bloom_free(bf);
-	HASH_CLEAR(hh, state_set);
-
-	// If a solution was found, reconstruct and print the plan
-	if (solution_node!=NULL)
-		extract_solution(solution_node);
-	else
-		printf("No solution found.\n");
-
-    if (solution_node!=NULL) {
-		printf("Solution found! (%d steps) (Total recharges: %d)\n",solution_length,total_recharges);
-		printf("(Total energy spent: %d)\n", total_energy);
-		printf("Time spent: %f secs\n",((float) c2-c1)/CLOCKS_PER_SEC);
-		write_solution_to_file(argv[3]);
-	}
-
-    return 0;
-}
+/**
+ * @file planner.c
+ * @brief Main file for the domain-dependent planner.
+ *
+ * This file contains the core implementation of the search algorithm (A* and Best-First Search),
+ * the duplicate detection mechanism using a Hash Table, the node expansion logic,
+ * and the main program flow management.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// --- Include custom header files ---
+#include "parser.h"       // Logic for parsing the PDDL problem file.
+#include "auxiliary.h"    // Auxiliary data structures (State, Rover, Waypoint, etc.).
+#include "minheap.h"      // Min-Heap implementation for the frontier.
+#include "heuristic.h"    // Heuristic function implementations.
+#include "solution.h"     // Functions for extracting and writing the solution.
+#include "statekey.h"     // Packed state keys for duplicate detection.
+#include "concurrent_set.h" // Lock-free closed set shared by search threads.
+#include "parallel.h"     // Worker queues for the multi-threaded search.
+#include "distributed.h"  // Message passing for the multi-process search.
+#include "checkpoint.h"   // Saving and restoring the search state.
+#include "analysis.h"     // Heuristic accuracy along the solved plan (--analyze).
+#include "trace.h"        // Binary trace of expansions and generations (--trace).
+#include "relaxed_plan.h" // Relaxed plan heuristic and helpful actions.
+#include "lookahead.h"    // Relaxed plan lookahead (--lookahead).
+#include "agenda.h"       // Goal agenda of the incremental search (agenda).
+#include "factored.h"     // Goal assignment of the per-rover search (factored).
+#include "hier.h"         // Assignment and routes of the hierarchical solver (hier).
+#include "eliminate.h"    // Action elimination over the plan found (--eliminate).
+#include "improve.h"      // Window improvement of the plan found (--improve).
+#include "regression.h"   // Regression search from the goal (regression).
+#include "problem_features.h" // Instance features of the method selection (auto).
+#include "estimate.h"     // Remaining effort of the A* search (--estimate, --predict-abort).
+#include "uthash.h"       // External library for Hash Table management.
+
+// --- Constants for algorithm selection ---
+#define best	1   // Represents the Best-First Search algorithm.
+#define astar	2   // Represents the A* algorithm.
+#define agenda	3   // Represents the goal agenda search (one goal at a time).
+#define factored 4  // Represents the factored search (one subproblem per rover).
+#define hier	5   // Represents the hierarchical solver (assign the goals, then route every rover).
+#define regression 6 // Represents the regression search (backwards from the goal).
+#define automatic 7  // Represents the automatic choice of the method from the features of the problem (auto).
+
+#define TIMEOUT	 600	// Maximum execution time in seconds.
+#define POTENTIAL_SCALE 4096 // f of best with an energy budget: h / (budget - g), times this, at most 16 times this.
+#define AUTO_METHODS 3                // auto: most methods tried in turn.
+#define AUTO_REGRESSION_GOALS 6       // auto: problems with at most this many goals ...
+#define AUTO_REGRESSION_DIAMETER 5    // ... whose maps have at least this diameter ...
+#define AUTO_TIGHT 100                // ... and h within this share of the energy (percent) go to regression first.
+
+// --- Global Variables ---
+_Thread_local state_entry *state_set = NULL; // The Hash Table storing the closed set of states.
+_Thread_local MinHeap *frontier; // The search frontier (open set), implemented as a Min-Heap.
+time_t t1;                     // Search start time for timeout checking.
+clock_t c1, c2;                // Variables for measuring CPU time.
+State *problem_state;          // The initial state of the problem (used by checkpoints).
+_Thread_local State *root_state = NULL; // State of the frontier entries without a parent (NULL: problem_state).
+int compact_frontier = 0;      // Store frontier entries as parent plus action (--compact-frontier).
+_Thread_local struct tree_node scratch_child; // Child being generated, in compact frontier mode.
+_Thread_local HeapNode *child_batch = NULL;   // Children of the node being expanded, inserted together.
+_Thread_local int child_batch_len = 0, child_batch_cap = 0;
+_Thread_local struct tree_node *generated_goal = NULL; // Goal found when generated (satisficing methods).
+_Thread_local int adding_lookahead = 0;       // Set while add_lookahead adds its node.
+int max_energy = -1;                          // Energy budget (--max-energy); -1 when unbounded.
+_Thread_local int search_quiet = 0;           // Set when the caller of search() prints the statistics.
+_Thread_local int search_limit = 0;           // Extractions after which search() gives up (0: no limit).
+_Thread_local int keep_expanded = 0;          // Set when search() records the nodes it extracts, to free the tree later.
+_Thread_local struct tree_node **expanded_nodes = NULL; // Nodes extracted by search() (with keep_expanded).
+_Thread_local int expanded_len = 0, expanded_cap = 0;
+
+// --- Multi-threaded search ---
+int num_threads = 1;                        // Number of search threads (--threads).
+unsigned long long closed_capacity = 1 << 20; // Slots of the shared closed set (--closed-capacity).
+ConcurrentSet *shared_closed = NULL;        // Closed set shared by all threads (NULL when single-threaded).
+_Thread_local Worker *current_worker = NULL; // The calling thread's worker (NULL when single-threaded).
+
+// --- Multi-process search ---
+/**
+ * @struct path_entry
+ * @brief Plan prefix of a node received from another process (using uthash).
+ *
+ * Nodes received from other processes have no parent in this process; the plan
+ * that reaches them is kept here, keyed by the node pointer.
+ */
+typedef struct {
+    struct tree_node *node;
+    CompactAction *path;
+    int path_len;
+    UT_hash_handle hh;
+} path_entry;
+
+path_entry *remote_paths = NULL; // Plan prefixes of the nodes received from other processes.
+State dist_template;             // Initial state; provides the static fields of received states.
+
+/**
+ * @brief Adds a new state key to the Hash Table (closed set).
+ * @param key The key to be added.
+ * @param g The g-value with which the state has been reached.
+ */
+void add_to_state_set(StateKey *key, int g) {
+    state_entry *entry = malloc(sizeof(state_entry));
+    entry->key = *key;
+    entry->g = g;
+    HASH_ADD(hh, state_set, key, sizeof(StateKey), entry);
+}
+
+/**
+ * @brief Looks up a state key in the Hash Table.
+ * @param key The key to find.
+ * @return The entry of the state, or NULL if it is not in the closed set.
+ */
+state_entry *find_state(StateKey *key) {
+    state_entry *entry;
+    HASH_FIND(hh, state_set, key, sizeof(StateKey), entry);
+    return entry;
+}
+
+/**
+ * @brief Empties the Hash Table (closed set) and frees its entries.
+ */
+void free_state_set() {
+    state_entry *entry, *tmp;
+    HASH_ITER(hh, state_set, entry, tmp) {
+        HASH_DEL(state_set, entry);
+        free(entry);
+    }
+}
+
+/**
+ * @brief Checks a new node for duplicate states to detect loops.
+ *
+ * This function creates a key for the node's state and checks if it exists
+ * in the closed set (Hash Table).
+ * If not, it adds it.
+ *
+ * With an energy budget (--max-energy), a state reached again with a lower g
+ * is treated as new: the cheaper path may fit the budget where the first one
+ * did not.
+ * @param node The search tree node to check.
+ * @return 1 if the state is new (no loop), 0 if a loop is detected.
+ */
+int check_with_parents(struct tree_node *node) {
+    StateKey sk;
+    make_state_key(&node->currState, &sk);
+
+    if (shared_closed != NULL) {
+        int res = cset_insert(shared_closed, &sk, state_key_hash(&sk), node->g, current_worker->id);
+        if (res == CSET_FULL) {
+            printf("Shared closed set is full. Use a larger --closed-capacity. Search is terminated...\n");
+            exit(1);
+        }
+        return res == CSET_INSERTED || (res == CSET_IMPROVED && max_energy >= 0);
+    }
+
+    // Using the key directly now
+    state_entry *entry = find_state(&sk);
+    if (entry != NULL) {
+        if (max_energy < 0 || node->g >= entry->g) return 0; // Loop detected
+        entry->g = node->g;
+        return 1;
+    }
+
+    add_to_state_set(&sk, node->g);
+    return 1; // No loop
+}
+
+/**
+ * @brief Checks if the search has exceeded the predefined timeout.
+ */
+void check_timeout() {
+    if (difftime(time(NULL), t1) > TIMEOUT) {
+        printf("Timeout reached. Aborting...\n");
+        printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
+        print_h_cache_stats(&h_stats);
+        exit(1);
+    }
+}
+
+/**
+ * @brief Displays a syntax message for incorrect command-line arguments.
+ */
+void syntax_message() {
+	printf("planner <method> <input-file> <output-file> [options]\n\n");
+	printf("where: ");
+	printf("<method> = best|astar|agenda|factored|hier|regression|auto\n");
+	printf("<input-file> is a file containing a PDDL problem description.\n");
+	printf("<output-file> is the file where the solution will be written.\n");
+	printf("\noptions:\n");
+	printf("--threads <n>            Number of search threads (best only, default 1).\n");
+	printf("--closed-capacity <n>    Slots of the shared closed set in multi-threaded mode.\n");
+	printf("--procs <n>              Number of cooperating processes (best only, default 1).\n");
+	printf("--rank <i>               Index of this process (0 .. procs-1); process 0 writes the solution.\n");
+	printf("--peers <spec>           Process endpoints: unix:<prefix> | tcp:<host>:<port> | tcp:<h0>:<p0>,<h1>:<p1>,...\n");
+	printf("--checkpoint <file>      Periodically save the search state to <file> (single process and thread only).\n");
+	printf("--checkpoint-interval <s> Seconds between checkpoints (default %d).\n", CHECKPOINT_INTERVAL);
+	printf("--resume <file>          Continue the search saved in checkpoint <file>.\n");
+	printf("--compact-frontier       Keep states only for expanded nodes; regenerate the others on extraction.\n");
+	printf("--no-h-cache             Evaluate the heuristic for every node, without the heuristic caches.\n");
+	printf("--analyze <prefix>       Compare h with the cost-to-go along the plan; write <prefix>.csv and <prefix>.json.\n");
+	printf("--trace <file>           Record every expansion and generated node in a binary trace (see rover_trace).\n");
+	printf("--heuristic h4|rp        The heuristic: optimal assignment (h4, default) or relaxed plan (rp, inadmissible).\n");
+	printf("--tie-break h|lifo|f     Order of frontier nodes with equal f: lower h, then oldest (h, default) or newest (lifo); or as stored (f).\n");
+	printf("--helpful-actions        Try the children of helpful actions first (best, agenda, factored).\n");
+	printf("--lookahead              Also add the state reached by executing the relaxed plan (best, agenda, factored).\n");
+	printf("--max-energy <E>         Only search for plans that spend at most E energy.\n");
+	printf("--agenda-fallback        Search the whole problem if an increment of the agenda method fails.\n");
+	printf("--bidirectional          With regression, also search forward from the initial state and meet in the middle.\n");
+	printf("--regression-nodes <n>   Partial states the regression may generate (default %d).\n", REGRESSION_NODES);
+	printf("--forward-nodes <n>      States the forward search of --bidirectional may generate (default %d).\n", FORWARD_NODES);
+	printf("--eliminate              Remove the actions the plan found does not need.\n");
+	printf("--improve <secs>         Spend up to <secs> seconds replacing windows of the plan with cheaper ones.\n");
+	printf("--estimate <secs>        With astar, print the predicted remaining extractions and time every <secs> seconds.\n");
+	printf("--predict-abort stop|best With astar, stop or switch to best when the prediction exceeds the time left.\n");
+}
+
+/**
+ * @brief Parses the search method from command-line arguments.
+ * @param s The string argument representing the method.
+ * @return The integer constant for the method, or -1 if invalid.
+ */
+int get_method(char* s) {
+    if (strcmp(s,"best")==0) return best;
+    if (strcmp(s,"astar")==0) return astar;
+    if (strcmp(s,"agenda")==0) return agenda;
+    if (strcmp(s,"factored")==0) return factored;
+    if (strcmp(s,"hier")==0) return hier;
+    if (strcmp(s,"regression")==0) return regression;
+    if (strcmp(s,"auto")==0) return automatic;
+    return -1;
+}
+
+const char *method_names[] = {"", "best", "astar", "agenda", "factored", "hier", "regression", "auto"};
+
+/**
+ * @brief Parses the optional command-line arguments that follow the output file.
+ * @param argc The argument count.
+ * @param argv The argument vector.
+ * @return 0 on success, -1 if an option is unknown or malformed.
+ */
+int parse_options(int argc, char** argv) {
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+            if (num_threads < 1 || num_threads > MAX_THREADS) return -1;
+        }
+        else if (strcmp(argv[i], "--closed-capacity") == 0 && i + 1 < argc) {
+            closed_capacity = strtoull(argv[++i], NULL, 10);
+            if (closed_capacity == 0) return -1;
+        }
+        else if (strcmp(argv[i], "--procs") == 0 && i + 1 < argc) {
+            dist_procs = atoi(argv[++i]);
+            if (dist_procs < 1 || dist_procs > DIST_MAX_PROCS) return -1;
+        }
+        else if (strcmp(argv[i], "--rank") == 0 && i + 1 < argc) {
+            dist_rank = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--peers") == 0 && i + 1 < argc) {
+            strncpy(dist_spec, argv[++i], MAX_LINE - 1);
+        }
+        else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            strncpy(checkpoint_file, argv[++i], MAX_LINE - 1);
+        }
+        else if (strcmp(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc) {
+            checkpoint_interval = atoi(argv[++i]);
+            if (checkpoint_interval < 1) return -1;
+        }
+        else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+            strncpy(resume_file, argv[++i], MAX_LINE - 1);
+        }
+        else if (strcmp(argv[i], "--compact-frontier") == 0) {
+            compact_frontier = 1;
+        }
+        else if (strcmp(argv[i], "--no-h-cache") == 0) {
+            h_cache_enabled = 0;
+        }
+        else if (strcmp(argv[i], "--analyze") == 0 && i + 1 < argc) {
+            strncpy(analysis_prefix, argv[++i], MAX_LINE - 1);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            strncpy(trace_file, argv[++i], MAX_LINE - 1);
+        }
+        else if (strcmp(argv[i], "--heuristic") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "rp") == 0) heuristic_function = relaxed_plan_heuristic;
+            else if (strcmp(argv[i], "h4") == 0) heuristic_function = evaluate_heuristic;
+            else return -1;
+        }
+        else if (strcmp(argv[i], "--tie-break") == 0 && i + 1 < argc) {
+            i++;
+            heap_order = KEY_ORDER_ALL;
+            heap_lifo = 0;
+            if (strcmp(argv[i], "f") == 0) heap_order = KEY_ORDER_F;
+            else if (strcmp(argv[i], "lifo") == 0) heap_lifo = 1;
+            else if (strcmp(argv[i], "h") != 0) return -1;
+        }
+        else if (strcmp(argv[i], "--helpful-actions") == 0) {
+            helpful_actions = 1;
+        }
+        else if (strcmp(argv[i], "--lookahead") == 0) {
+            lookahead = 1;
+        }
+        else if (strcmp(argv[i], "--max-energy") == 0 && i + 1 < argc) {
+            max_energy = atoi(argv[++i]);
+            if (max_energy < 0) return -1;
+        }
+        else if (strcmp(argv[i], "--agenda-fallback") == 0) {
+            agenda_fallback = 1;
+        }
+        else if (strcmp(argv[i], "--bidirectional") == 0) {
+            bidirectional = 1;
+        }
+        else if (strcmp(argv[i], "--regression-nodes") == 0 && i + 1 < argc) {
+            regression_nodes = atoi(argv[++i]);
+            if (regression_nodes <= 0) return -1;
+        }
+        else if (strcmp(argv[i], "--forward-nodes") == 0 && i + 1 < argc) {
+            forward_nodes = atoi(argv[++i]);
+            if (forward_nodes <= 0) return -1;
+        }
+        else if (strcmp(argv[i], "--eliminate") == 0) {
+            eliminate = 1;
+        }
+        else if (strcmp(argv[i], "--improve") == 0 && i + 1 < argc) {
+            improve_seconds = atof(argv[++i]);
+            if (improve_seconds <= 0) return -1;
+        }
+        else if (strcmp(argv[i], "--estimate") == 0 && i + 1 < argc) {
+            estimate_interval = atoi(argv[++i]);
+            if (estimate_interval < 1) return -1;
+        }
+        else if (strcmp(argv[i], "--predict-abort") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "stop") == 0) predict_abort = PREDICT_STOP;
+            else if (strcmp(argv[i], "best") == 0) predict_abort = PREDICT_BEST;
+            else return -1;
+            if (estimate_interval == 0) estimate_interval = ESTIMATE_INTERVAL;
+        }
+        else return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns what the frontier stores for a node.
+ *
+ * Normally this is the node itself. With --compact-frontier it is a new
+ * open_entry holding only the parent, the action and the cost values.
+ * @param node The node.
+ * @return The frontier entry, or NULL if memory is exhausted.
+ */
+void *frontier_entry(struct tree_node *node) {
+    if (!compact_frontier) return node;
+
+    open_entry *entry = (open_entry*) malloc(sizeof(open_entry));
+    if (entry == NULL) return NULL;
+    entry->parent = node->parent;
+    entry->code = node->parent != NULL ? node->action_taken.code : 0;
+    entry->g = node->g;
+    entry->h = node->h;
+    entry->f = node->f;
+    entry->id = node->id;
+    return entry;
+}
+
+/**
+ * @brief Turns an entry extracted from the frontier back into a search tree node.
+ *
+ * With --compact-frontier the node's state is regenerated by applying the stored
+ * action to the parent's state; the entry is freed.
+ * @param entry The frontier entry.
+ * @return The node.
+ */
+struct tree_node *frontier_node(void *entry) {
+    if (!compact_frontier) return (struct tree_node*) entry;
+
+    open_entry *e = (open_entry*) entry;
+    struct tree_node *node = (struct tree_node*) malloc(sizeof(struct tree_node));
+    if (node == NULL) {
+        printf("Memory exhausted while regenerating a frontier node. Search is terminated...\n");
+        exit(1);
+    }
+
+    node->parent = e->parent;
+    if (e->parent == NULL) {
+        node->currState = root_state != NULL ? *root_state : *problem_state;
+        node->action_taken.action_type = -1;
+        node->depth = 0;
+    }
+    else {
+        int params[5], energy_spent;
+        int action_type = compact_action_unpack(e->code, params);
+        apply_action(&e->parent->currState, action_type, params, &node->currState, &energy_spent);
+        set_action(&node->action_taken, action_type, params, action_param_count(action_type));
+        node->depth = e->parent->depth + 1;
+    }
+    node->g = e->g;
+    node->h = e->h;
+    node->f = e->f;
+    node->id = e->id;
+    free(e);
+    return node;
+}
+
+/**
+ * @brief Adds a new search tree node to the frontier (Min-Heap).
+ * @param node The node to be added.
+ * @return 0 on success, -1 on memory error.
+ */
+int add_frontier_in_order(struct tree_node *node) {
+    void *entry = frontier_entry(node);
+    if (entry == NULL) return -1;
+
+    if (current_worker != NULL)
+        worker_push(current_worker, node->f, node->h, entry);
+    else
+        insert_node(frontier, node->f, node->h, entry);
+    return 0;
+}
+
+/**
+ * @brief Queues a generated child for the frontier.
+ *
+ * The children of one expansion are collected and inserted together by
+ * flush_children, which resizes the heap (and, in multi-threaded mode, takes
+ * the worker's lock) only once per expansion.
+ * @param node The child.
+ * @return 0 on success, -1 on memory error.
+ */
+int queue_child(struct tree_node *node) {
+    void *entry = frontier_entry(node);
+    if (entry == NULL) return -1;
+
+    if (child_batch_len == child_batch_cap) {
+        child_batch_cap = child_batch_cap ? 2 * child_batch_cap : 64;
+        child_batch = (HeapNode*) realloc(child_batch, child_batch_cap * sizeof(HeapNode));
+        if (child_batch == NULL) return -1;
+    }
+    child_batch[child_batch_len].f = node->f;
+    child_batch[child_batch_len].h = node->h;
+    child_batch[child_batch_len].node = entry;
+    child_batch_len++;
+    return 0;
+}
+
+/**
+ * @brief Inserts the children queued by queue_child into the frontier.
+ */
+void flush_children() {
+    if (child_batch_len == 0) return;
+    if (current_worker != NULL)
+        worker_push_batch(current_worker, child_batch, child_batch_len);
+    else
+        insert_nodes(frontier, child_batch, child_batch_len);
+    child_batch_len = 0;
+}
+
+/**
+ * @brief Frees a generated child that is not added to the frontier.
+ */
+void release_child(struct tree_node *child) {
+    if (child != &scratch_child) free(child);
+}
+
+/**
+ * @brief Records a node extracted from the frontier, so that free_search_tree can free it.
+ * @return 0 on success, -1 on memory error.
+ */
+int remember_expanded(struct tree_node *node) {
+    if (expanded_len == expanded_cap) {
+        expanded_cap = expanded_cap ? 2 * expanded_cap : 1024;
+        struct tree_node **grown = (struct tree_node**) realloc(expanded_nodes, expanded_cap * sizeof(struct tree_node*));
+        if (grown == NULL) return -1;
+        expanded_nodes = grown;
+    }
+    expanded_nodes[expanded_len++] = node;
+    return 0;
+}
+
+/**
+ * @brief Frees the frontier; with keep_expanded, the entries still in it as well.
+ */
+void release_frontier() {
+    if (keep_expanded) {
+        for (int i = 0; i < frontier->nodeSize; i++) free(frontier->nodeArray[i].node);
+    }
+    freeMinHeap(frontier);
+}
+
+/**
+ * @brief Forgets the nodes recorded by remember_expanded, e.g. when they make up a plan.
+ */
+void forget_expanded() {
+    free(expanded_nodes);
+    expanded_nodes = NULL;
+    expanded_len = expanded_cap = 0;
+}
+
+/**
+ * @brief Frees the nodes recorded by remember_expanded.
+ *
+ * Together with release_frontier this frees the whole search tree of a search
+ * run with keep_expanded: every node of the tree was either extracted or is
+ * still in the frontier. Plans must be taken from the tree (node_path) first.
+ * @param keep A node that outlives the search, e.g. its root (NULL: none).
+ */
+void free_search_tree(struct tree_node *keep) {
+    for (int i = 0; i < expanded_len; i++) {
+        if (expanded_nodes[i] != keep) free(expanded_nodes[i]);
+    }
+    forget_expanded();
+}
+
+/**
+ * @brief Returns the plan that reaches a node, as compact actions.
+ *
+ * Follows the parent pointers up to the local root of the node's branch; if that
+ * root was received from another process, its plan prefix is prepended.
+ * @param node The node.
+ * @param path_len Output parameter for the length of the plan.
+ * @return The plan (malloc'ed), or NULL if memory is exhausted.
+ */
+CompactAction *node_path(struct tree_node *node, int *path_len) {
+    CompactAction *path = (CompactAction*) malloc((node->depth > 0 ? node->depth : 1) * sizeof(CompactAction));
+    if (path == NULL) return NULL;
+
+    int i = node->depth;
+    struct tree_node *n = node;
+    while (n->parent != NULL) {
+        path[--i] = n->action_taken.code;
+        n = n->parent;
+    }
+
+    path_entry *entry;
+    HASH_FIND_PTR(remote_paths, &n, entry);
+    if (entry != NULL) memcpy(path, entry->path, entry->path_len * sizeof(CompactAction));
+
+    *path_len = node->depth;
+    return path;
+}
+
+/**
+ * @brief In distributed mode, hands a generated node to the process owning its state.
+ * @param child The generated node.
+ * @return 1 if the node belongs to another process and has been queued for it, 0 otherwise.
+ */
+int send_to_owner(struct tree_node *child) {
+    StateKey sk;
+    make_state_key(&child->currState, &sk);
+
+    int owner = dist_owner(state_key_hash(&sk));
+    if (owner == dist_rank) return 0;
+
+    int path_len;
+    CompactAction *path = node_path(child, &path_len);
+    if (path == NULL) {
+        printf("Memory exhausted while sending a node. Search is terminated...\n");
+        exit(1);
+    }
+    dist_queue_node(owner, &sk, child->g, path, path_len);
+    free(path);
+    return 1;
+}
+
+/**
+ * @brief Returns the f value of a node.
+ *
+ * A* orders nodes by g + h and best by h. With an energy budget, best orders them
+ * by h / (budget - g) instead, as in potential search: the node most likely to
+ * lead to a plan within the budget is the one whose estimated cost to go is
+ * smallest compared to the energy it has left, which favours cheap plans.
+ * @param method The search algorithm.
+ * @param g The energy spent to reach the node.
+ * @param h The node's heuristic value.
+ */
+int node_f(int method, int g, int h) {
+    if (method != best) return g + h;
+    if (max_energy < 0) return h;
+    long long f = (long long) h * POTENTIAL_SCALE / (max_energy - g + 1);
+    return f < 16 * POTENTIAL_SCALE ? (int) f : 16 * POTENTIAL_SCALE;
+}
+
+/**
+ * @brief Evaluates a node and checks it against the energy budget (--max-energy).
+ *
+ * Called before the duplicate check, so that states outside the budget never
+ * enter the closed set. The check uses the routing bound, which never
+ * overestimates the energy still needed; h itself can (the task assignment
+ * estimate does on some problems, see --analyze), and pruning with it would
+ * lose plans that fit the budget. Dead ends count as outside the budget.
+ * @param node The node; its h is set when it is within the budget.
+ * @return 1 if g plus the routing bound exceeds the budget, 0 otherwise.
+ */
+int over_budget(struct tree_node *node) {
+    if (node->g > max_energy) return 1;
+    if (!is_goal_state(&node->currState)) {
+        int bound = routing_bound(&node->currState);
+        if (bound == INT_MAX || node->g + bound > max_energy) return 1;
+    }
+    node->h = heuristic(node->currState);
+    return node->h == INT_MAX;
+}
+
+/**
+ * @brief Adds a new child node to the search tree.
+ *
+ * This function sets the child's properties (parent, depth, g-cost),
+ * checks for loops, calculates its heuristic and f-values, and adds it to the frontier
+ * unless the heuristic reports a dead end (INT_MAX) or, with --max-energy, g + h
+ * exceeds the energy budget.
+ *
+ * The satisficing methods test for the goal here, when a node is generated,
+ * instead of when it is extracted: a goal child is kept in `generated_goal` and
+ * the rest of the expansion is skipped. Only communicate actions can complete a
+ * goal, so other children are not tested. A* keeps the test at extraction, which
+ * its optimality depends on.
+ * @return 1 if the child was kept (queued for the frontier or as the goal), 0 if it
+ * was dropped, -1 on memory error.
+ */
+int add_child(struct tree_node *current_node, int action_type, struct tree_node *child, int method, int *params, int param_count, int energy_spent){
+    int err = 0;
+
+    child->parent = current_node;
+    child->depth = current_node->depth + 1;
+    child->g = current_node->g + energy_spent;
+    set_action(&child->action_taken, action_type, params, param_count);
+
+    if (dist_procs > 1 && send_to_owner(child)) {
+        release_child(child);
+        child = NULL;
+    }
+    else if (max_energy >= 0 && over_budget(child)) {
+        if (trace_fp != NULL) trace_child(child, TRACE_DEAD_END);
+        release_child(child);
+        child = NULL;
+    }
+    else if(!check_with_parents(child)){
+        if (trace_fp != NULL) trace_child(child, TRACE_DUPLICATE);
+        release_child(child);
+        child = NULL;
+    }
+    else if((child->h = max_energy >= 0 ? child->h : heuristic(child->currState)) == INT_MAX ||
+            (agenda_active && agenda_dead_end(&child->currState))){
+        // Dead end: some goal can no longer be achieved from this state.
+        if (trace_fp != NULL) trace_child(child, TRACE_DEAD_END);
+        release_child(child);
+        child = NULL;
+    }
+    else {
+        child->f = node_f(method, child->g, child->h);
+        if (helpful_actions && !adding_lookahead && !is_helpful(action_type, params)) child->f += HELPFUL_PENALTY;
+
+        if (trace_fp != NULL) trace_child(child, TRACE_GENERATED);
+
+        if (method != astar && action_type >= 7 && is_goal_state(&child->currState)) {
+            if (child == &scratch_child) {
+                child = (struct tree_node*) malloc(sizeof(struct tree_node));
+                if (child == NULL) return -1;
+                *child = scratch_child;
+            }
+            generated_goal = child;
+        }
+        else err = queue_child(child);
+        if (err == 0) err = 1;
+    }
+
+    return err;
+}
+
+// Helper function to safely create and try to add a child node
+int try_add_child(struct tree_node *parent_node, int action_type, int *params, int param_count, int method) {
+    if (generated_goal != NULL) return 0; // A goal child ends the expansion.
+
+    step_count++;
+    if (step_count % 1000 == 0) {
+        check_timeout();
+    }
+
+    // In compact frontier mode the child only lives until its frontier entry is made.
+    struct tree_node *child = compact_frontier ? &scratch_child : malloc(sizeof(struct tree_node));
+    if (child == NULL) return -1;
+
+    int energy_spent;
+
+    if (apply_action(&parent_node->currState, action_type, params, &child->currState, &energy_spent)) {
+        int err = add_child(parent_node, action_type, child, method, params, param_count, energy_spent);
+        if (err < 0) return -1;
+    } else {
+        release_child(child);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Adds the state reached by the relaxed plan lookahead from a node (--lookahead).
+ *
+ * Every action of the lookahead but the last gets a node of its own, linked to
+ * the previous one, so that the plan can be followed back through them; only
+ * the last node goes through add_child and into the frontier. If add_child drops
+ * it, the intermediate nodes are freed again.
+ * @param current_node The node being expanded.
+ * @param method The search algorithm (best).
+ * @return 0 on success, -1 on memory error.
+ */
+int add_lookahead(struct tree_node *current_node, int method) {
+    CompactAction plan[LOOKAHEAD_MAX];
+    int length = lookahead_plan(&current_node->currState, plan);
+    if (length < 2) return 0; // A single action is already one of the children.
+
+    struct tree_node *parent = current_node;
+    int params[5], energy_spent, action_type;
+    for (int i = 0; i < length - 1; i++) {
+        struct tree_node *node = (struct tree_node*) malloc(sizeof(struct tree_node));
+        if (node == NULL) return -1;
+        action_type = compact_action_unpack(plan[i], params);
+        apply_action(&parent->currState, action_type, params, &node->currState, &energy_spent);
+        node->parent = parent;
+        node->depth = parent->depth + 1;
+        node->g = parent->g + energy_spent;
+        node->h = heuristic(node->currState); // Shown in the solution file.
+        node->f = node_f(method, node->g, node->h);
+        node->id = 0;
+        set_action(&node->action_taken, action_type, params, action_param_count(action_type));
+        parent = node;
+    }
+
+    struct tree_node *child = compact_frontier ? &scratch_child : malloc(sizeof(struct tree_node));
+    if (child == NULL) return -1;
+    action_type = compact_action_unpack(plan[length - 1], params);
+    apply_action(&parent->currState, action_type, params, &child->currState, &energy_spent);
+
+    adding_lookahead = 1;
+    int kept = add_child(parent, action_type, child, method, params, action_param_count(action_type), energy_spent);
+    adding_lookahead = 0;
+    if (kept < 0) return -1;
+    if (kept == 0) {
+        while (parent != current_node) {
+            struct tree_node *prev = parent->parent;
+            free(parent);
+            parent = prev;
+        }
+    }
+    return 0;
+}
+
+// Helper function to try actions that require 2 parameters
+int try_two_param_action(struct tree_node *node, int rover, int param2, int action_type, int method) {
+    int params[2] = {rover, param2};
+    return try_add_child(node, action_type, params, 2, method);
+}
+
+// Helper function to try actions that require 3 parameters
+int try_three_param_action(struct tree_node *node, int rover, int param2, int param3, int action_type, int method) {
+    int params[3] = {rover, param2, param3};
+    return try_add_child(node, action_type, params, 3, method);
+}
+
+// Helper function to try actions that require 4 parameters
+int try_four_param_action(struct tree_node *node, int rover, int param2, int param3, int param4,
+                         int action_type, int method) {
+    int params[4] = {rover, param2, param3, param4};
+    return try_add_child(node, action_type, params, 4, method);
+}
+
+// Helper function to try actions that require 5 parameters
+int try_five_param_action(struct tree_node *node, int rover, int param2, int param3, int param4,
+                         int param5, int action_type, int method) {
+    int params[5] = {rover, param2, param3, param4, param5};
+    return try_add_child(node, action_type, params, 5, method);
+}
+/**
+ * @brief Expands a node by generating all its possible successor states (children).
+ *
+ * This is the core function for generating the search tree. It iterates through all
+ * possible actions for all rovers and creates new child nodes for each valid action.
+ * Extensive pruning is used to avoid generating obviously invalid or unhelpful states.
+ * @param current_node The node to expand.
+ * @param method The search algorithm being used (astar or best).
+ * @return 1 on success, -1 on memory error.
+ */
+int find_children(struct tree_node *current_node, int method) {
+    State *s = &current_node->currState;
+    int rover, store, cam, wp, wp2, obj, mode, pos;
+    int lander_pos = s->lander.lander_position;
+
+    if (helpful_actions) find_helpful_actions(s);
+
+    for (rover = 0; rover < num_rovers; rover++) {
+        if (!s->rovers[rover].available) {
+            continue;
+        }
+
+        pos = s->rovers[rover].position;
+
+        // RECHARGE (1)
+        if (s->waypoints[pos].in_sun && s->rovers[rover].energy < 8) {
+            if (try_two_param_action(current_node, rover, pos, 1, method) < 0) return -1;
+        }
+
+        // SAMPLE_SOIL (2)
+        if (s->rovers[rover].equipped_soil && s->rovers[rover].energy >= 3 &&
+            goal.communicated_soil_data[pos] && !s->waypoints[pos].communicated_soil &&
+            s->waypoints[pos].has_soil_sample) {
+            for (store = 0; store < num_stores; store++) {
+                if (s->stores[store].rover_id == rover && !s->stores[store].is_full) {
+                    if (try_three_param_action(current_node, rover, store, pos, 2, method) < 0) return -1;
+                }
+            }
+        }
+
+        // SAMPLE_ROCK (3)
+        if (s->rovers[rover].equipped_rock && s->rovers[rover].energy >= 5 &&
+            goal.communicated_rock_data[pos] && !s->waypoints[pos].communicated_rock &&
+            s->waypoints[pos].has_rock_sample) {
+            for (store = 0; store < num_stores; store++) {
+                // ΚΛΑΔΕΜΑ: Το store πρέπει να ανήκει στο rover και να είναι άδειο.
+                if (s->stores[store].rover_id == rover && !s->stores[store].is_full) {
+                    if (try_three_param_action(current_node, rover, store, pos, 3, method) < 0) return -1;
+                }
+            }
+        }
+
+        if (s->rovers[rover].equipped_imaging) {
+            for (cam = 0; cam < num_cameras; cam++) {
+                if (s->cameras[cam].rover_id != rover) continue;
+
+                for (obj = 0; obj < num_objectives; obj++) {
+                    // CALIBRATE (5)
+                    if (s->rovers[rover].energy >= 2 &&
+                        (s->objectives[obj].visible_waypoints & (1 << pos)) &&
+                        (s->cameras[cam].calibration_targets & (1 << obj))) {
+                        if (try_four_param_action(current_node, rover, cam, obj, pos, 5, method) < 0) return -1;
+                    }
+
+                    // TAKE_IMAGE (6)
+                    for (mode = 0; mode < num_modes; mode++) {
+                        if (s->cameras[cam].calibrated &&
+                            s->rovers[rover].energy >= 1 &&
+                            (s->cameras[cam].modes_supported & (1 << mode)) &&
+                            (s->objectives[obj].visible_waypoints & (1 << pos)) &&
+                            goal.communicated_image_data[obj][mode] &&
+                            !(s->objectives[obj].communicated_image & (1 << mode))) {
+                            if (try_five_param_action(current_node, rover, pos, obj, cam, mode, 6, method) < 0) return -1;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (s->lander.channel_free && (s->waypoints[pos].visible_waypoints & (1 << lander_pos))) {
+            // COMMUNICATE_SOIL_DATA (7)
+            if (s->rovers[rover].energy >= 4) {
+                for (wp = 0; wp < num_waypoints; wp++) {
+                    if (goal.communicated_soil_data[wp] &&
+                        !s->waypoints[wp].communicated_soil &&
+                        (s->rovers[rover].has_soil_analysis & (1 << wp))) {
+                        if (try_four_param_action(current_node, rover, wp, pos, lander_pos, 7, method) < 0) return -1;
+                    }
+                }
+            }
+
+            // COMMUNICATE_ROCK_DATA (8)
+            if (s->rovers[rover].energy >= 4) {
+                for (wp = 0; wp < num_waypoints; wp++) {
+                    if (goal.communicated_rock_data[wp] &&
+                        !s->waypoints[wp].communicated_rock &&
+                        (s->rovers[rover].has_rock_analysis & (1 << wp))) {
+                        if (try_four_param_action(current_node, rover, wp, pos, lander_pos, 8, method) < 0) return -1;
+                    }
+                }
+            }
+
+            // COMMUNICATE_IMAGE_DATA (9)
+            if (s->rovers[rover].energy >= 6) {
+                for (obj = 0; obj < num_objectives; obj++) {
+                    for (mode = 0; mode < num_modes; mode++) {
+                        if (goal.communicated_image_data[obj][mode] &&
+                            !(s->objectives[obj].communicated_image & (1 << mode)) &&
+                            s->rovers[rover].have_image[obj][mode]) {
+                            if (try_five_param_action(current_node, rover, obj, mode, pos, lander_pos, 9, method) < 0) return -1;
+                        }
+                    }
+                }
+            }
+        }
+
+        // DROP (4)
+        for (store = 0; store < num_stores; store++) {
+            if (s->stores[store].rover_id == rover && s->stores[store].is_full) {
+                if (try_two_param_action(current_node, rover, store, 4, method) < 0) return -1;
+            }
+        }
+
+        // NAVIGATE (0)
+        for (wp2 = 0; wp2 < num_waypoints; wp2++) {
+            if (pos != wp2 &&
+                s->rovers[rover].energy >= 8 &&
+                (s->waypoints[pos].visible_waypoints & (1 << wp2)) &&
+                s->rovers[rover].can_traverse[pos][wp2]) {
+                if (try_three_param_action(current_node, rover, pos, wp2, 0, method) < 0) return -1;
+            }
+        }
+    }
+
+    if (lookahead && generated_goal == NULL && add_lookahead(current_node, method) < 0) return -1;
+
+    flush_children();
+    return 1; // Process completed!
+}
+
+
+/**
+ * @brief Initializes the search process.
+ *
+ * Creates the root node of the search tree from the initial state,
+ * initializes the frontier (Min-Heap), and adds the root node to it.
+ * Also precomputes shortest paths.
+ * @param initState The initial state of the problem.
+ * @param method The search algorithm to be used.
+ */
+void initialize_search(State initState, int method)
+{
+	struct tree_node *root=NULL;	// the root of the search tree.
+
+	precompute_shortest_paths(&initState);
+
+	//Initialize frontier
+	frontier = createMinHeap(1000);
+	if (frontier == NULL) {
+		printf("Memory exhausted while creating the frontier. Search is terminated...\n");
+		exit(1);
+	}
+
+	// Initialize search tree
+	root=(struct tree_node*) malloc(sizeof(struct tree_node));
+	if (root == NULL) {
+		printf("Memory exhausted while creating the root node. Search is terminated...\n");
+		exit(1);
+	}
+	root->parent=NULL;
+	root->action_taken.action_type=-1;
+    root->currState=initState;
+    root->depth = 0;
+
+	root->g=0;
+	root->h=heuristic(root->currState);
+	root->f=node_f(method, root->g, root->h);
+	root->id=0;
+	if (trace_fp != NULL)
+		trace_root(root);
+
+	// Add the initial root to the frontier
+	add_frontier_in_order(root);
+	if (compact_frontier)
+		free(root);
+}
+
+/**
+ * @brief Initializes the search from a checkpoint instead of the initial state.
+ *
+ * Precomputes shortest paths, then rebuilds the search tree, the frontier and the
+ * closed set saved in the checkpoint given with --resume. The CPU time spent
+ * before the checkpoint is added to the time reported at the end.
+ * @param method The search algorithm to be used.
+ */
+void resume_search(int method)
+{
+	int inserts, extracts;
+	long long cpu_ms;
+
+	precompute_shortest_paths(problem_state);
+
+	frontier = createMinHeap(1000);
+	long long open_count = load_checkpoint(resume_file, problem_state, method, frontier, compact_frontier,
+	                                       &state_set, &inserts, &extracts, &cpu_ms);
+	total_inserts = inserts;
+	total_extracts = extracts;
+	c1 -= (clock_t) (cpu_ms * CLOCKS_PER_SEC / 1000);
+
+	printf("Resumed from %s: %lld frontier nodes, %u closed states.\n",
+	       resume_file, open_count, HASH_COUNT(state_set));
+}
+
+/**
+ * @brief Starts a background checkpoint if one is due.
+ *
+ * Called between two node expansions, when the frontier and the closed set are
+ * consistent with each other.
+ */
+void maybe_checkpoint(int method) {
+	if (checkpoint_file[0] == '\0' || total_extracts % 256 != 0) return;
+	if (difftime(time(NULL), last_checkpoint) < checkpoint_interval) return;
+	start_checkpoint(problem_state, method, frontier, compact_frontier, state_set, total_inserts, total_extracts,
+	                 (long long) (clock() - c1) * 1000 / CLOCKS_PER_SEC);
+}
+
+/**
+ * @brief Turns the A* frontier into the frontier of another method.
+ *
+ * Every entry is inserted again with the f-value of the method, computed from
+ * the g and h stored in the entry (the h of the heap key saturates). Moving the
+ * entries does not count as inserting them.
+ * @param method The new method.
+ */
+void rekey_frontier(int method) {
+	MinHeap *old = frontier;
+	int inserts = total_inserts;
+
+	frontier = createMinHeap(old->nodeSize + 1);
+	while (!is_empty_heap(old)) {
+		HeapNode entry = extract_min(old);
+		if (compact_frontier) {
+			open_entry *e = (open_entry*) entry.node;
+			e->f = node_f(method, e->g, e->h);
+			insert_node(frontier, e->f, e->h, e);
+		}
+		else {
+			struct tree_node *node = (struct tree_node*) entry.node;
+			node->f = node_f(method, node->g, node->h);
+			insert_node(frontier, node->f, node->h, node);
+		}
+	}
+	freeMinHeap(old);
+	total_inserts = inserts;
+}
+
+/**
+ * @brief The main search loop.
+ *
+ * Implements the Search algorithms framework. It repeatedly extracts
+ * the most promising node from the frontier, checks if it's a solution,
+ * and expands it to generate its children.
+ * @param method The search algorithm (astar or best).
+ * @return A pointer to the solution node, or NULL if no solution is found.
+ */
+struct tree_node *search(int method) {
+	struct tree_node *current_node;
+
+	while (!is_empty_heap(frontier))
+	{
+		maybe_checkpoint(method);
+
+		// Predict whether A* can finish before the timeout (--estimate, --predict-abort)
+		if (estimate_interval > 0 && method == astar && total_extracts % 256 == 0
+		    && estimate_check(TIMEOUT - difftime(time(NULL), t1))) {
+			if (predict_abort == PREDICT_STOP) {
+				printf("The search is predicted not to finish within %d secs. Aborting...\n", TIMEOUT);
+				printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
+				print_h_cache_stats(&h_stats);
+				return NULL;
+			}
+			printf("The search is predicted not to finish within %d secs. Switching to Greedy Best-First Search...\n", TIMEOUT);
+			method = best;
+			rekey_frontier(method);
+		}
+
+		// Extract the best node from the frontier
+		HeapNode minNode = extract_min(frontier);
+		total_extracts++;
+		if (search_limit > 0 && total_extracts > search_limit) {
+            free(minNode.node); // Neither expanded nor in the frontier any more.
+            return NULL;
+        }
+		if (estimate_interval > 0 && method == astar) estimate_record(minNode.f, minNode.h);
+		if (analysis_prefix[0] != '\0') analysis_record_extract(minNode.f, minNode.h);
+        current_node = frontier_node(minNode.node);
+		if (keep_expanded && remember_expanded(current_node) < 0) {
+            printf("Memory exhausted while recording an expanded node. Search is terminated...\n");
+            return NULL;
+        }
+
+		if (is_goal_state(&current_node->currState)){
+            if (!search_quiet) {
+                printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
+                print_h_cache_stats(&h_stats);
+            }
+            if (trace_fp != NULL) trace_solution(current_node);
+            release_frontier();
+            return current_node;
+		}
+
+		// Expand the current node to find its children
+		if (trace_fp != NULL) trace_expand(current_node);
+		int err=find_children(current_node, method);
+
+		if (err<0){
+            printf("Memory exhausted while creating new frontier node. Search is terminated...\n");
+            return NULL;
+        }
+
+		if (generated_goal != NULL) {
+            if (!search_quiet) {
+                printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
+                print_h_cache_stats(&h_stats);
+            }
+            if (trace_fp != NULL) trace_solution(generated_goal);
+            freeMinHeap(frontier);
+            return generated_goal;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Body of a search thread in multi-threaded mode.
+ *
+ * Repeatedly takes a node from the worker's queue (stealing from other workers
+ * when needed), checks it for the goal and expands it with find_children. The
+ * children go to the worker's own queue through add_frontier_in_order.
+ * @param arg The Worker owned by this thread.
+ */
+void *worker_main(void *arg) {
+    Worker *w = (Worker*) arg;
+    struct tree_node *current_node;
+    void *entry;
+
+    current_worker = w;
+    goal = problem_goal;
+    goal_changed();
+
+    while ((entry = worker_next(w)) != NULL) {
+        current_node = frontier_node(entry);
+        total_extracts++;
+
+        if (is_goal_state(&current_node->currState)) {
+            report_parallel_solution(current_node);
+            break;
+        }
+
+        if (find_children(current_node, best) < 0) {
+            printf("Memory exhausted while creating new frontier node. Search is terminated...\n");
+            atomic_store(&search_done, 1);
+            break;
+        }
+
+        if (generated_goal != NULL) {
+            report_parallel_solution(generated_goal);
+            break;
+        }
+    }
+
+    w->inserts = total_inserts;
+    w->extracts = total_extracts;
+    w->h_stats = h_stats;
+    free_h_cache();
+    return NULL;
+}
+
+/**
+ * @brief The multi-threaded Best-First Search.
+ *
+ * Every thread runs worker_main over its own local queue; duplicate detection
+ * goes through the shared lock-free closed set. The root node, placed in the
+ * frontier by initialize_search, is handed to the first worker.
+ * @return A pointer to the solution node, or NULL if no solution is found.
+ */
+struct tree_node *parallel_search() {
+    shared_closed = cset_create(closed_capacity);
+    if (shared_closed == NULL || init_workers(num_threads) < 0) {
+        printf("Memory exhausted while creating the worker queues. Search is terminated...\n");
+        return NULL;
+    }
+
+    // Register the root in the shared closed set and give it to the first worker.
+    struct tree_node *root = frontier_node(extract_min(frontier).node);
+    freeMinHeap(frontier);
+    current_worker = &workers[0];
+    check_with_parents(root);
+    add_frontier_in_order(root);
+    current_worker = NULL;
+
+    for (int i = 0; i < num_workers; i++) {
+        if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+            printf("Cannot create search thread %d. Search is terminated...\n", i);
+            exit(1);
+        }
+    }
+
+    long long steals = 0, stolen = 0;
+    for (int i = 0; i < num_workers; i++) {
+        pthread_join(workers[i].thread, NULL);
+        total_inserts += workers[i].inserts;
+        total_extracts += workers[i].extracts;
+        h_stats.lookups += workers[i].h_stats.lookups;
+        h_stats.hits += workers[i].h_stats.hits;
+        h_stats.row_lookups += workers[i].h_stats.row_lookups;
+        h_stats.row_hits += workers[i].h_stats.row_hits;
+        steals += workers[i].steals;
+        stolen += workers[i].stolen_nodes;
+    }
+
+    printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
+    printf("Work stealing: threads=%d, steals=%lld, stolen nodes=%lld\n", num_workers, steals, stolen);
+    print_h_cache_stats(&h_stats);
+    cset_print_stats(shared_closed, num_workers);
+
+    free_workers();
+    cset_free(shared_closed);
+    shared_closed = NULL;
+
+    return atomic_load(&parallel_solution);
+}
+
+/**
+ * @brief Searches for all goals from one of the states the agenda reached (--agenda-fallback).
+ *
+ * The node is kept as the root, so the plan found still goes through the
+ * increments that led to it.
+ * @param node The state reached by the first increments (the root for none).
+ * @param limit The extractions the search may take (0: no limit).
+ * @return A pointer to the solution node, or NULL if no solution is found.
+ */
+struct tree_node *agenda_resume(struct tree_node *node, int limit) {
+    free_state_set();
+    generated_goal = NULL;
+    node->h = heuristic(node->currState);
+    if (node->h == INT_MAX)
+        return NULL;
+    node->f = node_f(best, node->g, node->h);
+    frontier = createMinHeap(1000);
+    add_frontier_in_order(node);
+
+    search_limit = limit > 0 ? total_extracts + limit : 0;
+    keep_expanded = 1; // A failed attempt frees its tree, so that the next one starts with free memory.
+    struct tree_node *reached = search(best);
+    search_limit = 0;
+    if (reached == NULL) {
+        release_frontier();
+        free_search_tree(node);
+    }
+    else
+        forget_expanded();
+    keep_expanded = 0;
+    return reached;
+}
+
+/**
+ * @brief The goal agenda search (agenda).
+ *
+ * Adds the goals to the agenda one by one (see agenda.h) and searches for every
+ * increment from the goal node of the previous one: the increment's root keeps
+ * its parent, so extract_solution follows the plan back through all of them.
+ * The closed set and the frontier start empty for every increment. Increments
+ * are ordered by g + h, as in A*: with a single new goal the search stays small
+ * either way, and a greedy increment would spend energy that later goals need.
+ * --helpful-actions and --lookahead apply to the increments as well.
+ *
+ * Children from which the whole problem can no longer be solved are dropped
+ * (agenda_dead_end), but an increment can still fail when the heuristic does not
+ * see the dead end the earlier increments led to, e.g. when a rover has the
+ * energy for each of its goals but not for all of them. Every increment is
+ * therefore given up when it takes too long (agenda_extract_limit), and no
+ * solution is reported. With --agenda-fallback, all goals are then searched for
+ * with best, first from the state the last good increment reached, with the same
+ * extraction limit, then from states reached 2, 4, 8... increments before it,
+ * and at last from the initial state without a limit.
+ * @return A pointer to the solution node, or NULL if no solution is found.
+ */
+struct tree_node *agenda_search() {
+    struct tree_node *node = frontier_node(extract_min(frontier).node);
+    struct tree_node *roots[GOAL_SLOTS + 1]; // The root of every increment.
+    int slot, steps = 0, goals = count_goals(&goal), budget = 0;
+    char name[MAX_LINE];
+
+    freeMinHeap(frontier);
+    agenda_begin();
+    agenda_first_extract = total_extracts;
+    search_quiet = 1;
+    while ((slot = agenda_next_goal(&node->currState)) >= 0) {
+        goal_slot_name(slot, name);
+        roots[steps++] = node;
+
+        free_state_set();
+        generated_goal = NULL;
+        frontier = createMinHeap(1000);
+        node->h = heuristic(node->currState);
+        node->f = node_f(astar, node->g, node->h);
+        add_frontier_in_order(node); // The node is kept as a root even with --compact-frontier.
+
+        int first = total_extracts, limit = agenda_extract_limit(total_extracts);
+        search_limit = limit;
+        struct tree_node *reached = search(astar);
+        search_limit = 0;
+        if (reached == NULL) {
+            if (total_extracts > limit)
+                printf("Agenda goal %d/%d (%s) not reached within %d extractions.\n", steps, goals, name, limit - first);
+            else
+                printf("Agenda goal %d/%d (%s) could not be reached.\n", steps, goals, name);
+            budget = limit - first;
+            freeMinHeap(frontier);
+            break;
+        }
+        printf("Agenda goal %d/%d: %s (energy %d, %d extracts)\n", steps, goals, name, reached->g,
+               total_extracts - first);
+        node = reached;
+    }
+    agenda_end();
+    search_quiet = 0;
+
+    if (slot < 0) {
+        printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
+        print_h_cache_stats(&h_stats);
+        return node;
+    }
+    if (!agenda_fallback)
+        return NULL;
+
+    // steps - 1 increments succeeded; roots[steps - 1] is the state they reached.
+    for (int back = 1; steps - back > 0; back *= 2) {
+        printf("Falling back to the search for all goals after agenda goal %d/%d...\n", steps - back, goals);
+        struct tree_node *reached = agenda_resume(roots[steps - back], budget);
+        if (reached != NULL)
+            return reached;
+    }
+    printf("Falling back to the search for all goals from the initial state...\n");
+    return agenda_resume(roots[0], 0);
+}
+
+/**
+ * @brief Body of a thread of the factored search: solves the subproblem of one rover.
+ *
+ * The root is the initial state with every other rover unavailable, so that only
+ * the rover's own actions are generated, and the thread's goal is the rover's set
+ * of goals. The subproblem is searched with A* ordering, which keeps the rover's
+ * plan short, and fails after the task's limit of extractions.
+ * @param arg The RoverTask of the rover.
+ */
+void *rover_task_main(void *arg) {
+    RoverTask *t = (RoverTask*) arg;
+
+    goal = t->goal;
+    goal_changed();
+    search_quiet = 1;
+    search_limit = t->limit;
+    keep_expanded = 1; // The tree is freed when the thread ends, so that later rounds start with free memory.
+
+    struct tree_node *root = (struct tree_node*) malloc(sizeof(struct tree_node));
+    if (root == NULL) {
+        printf("Memory exhausted while creating the root of rover %d. Search is terminated...\n", t->rover);
+        return NULL;
+    }
+    root->parent = NULL;
+    root->action_taken.action_type = -1;
+    root->currState = *problem_state;
+    for (int r = 0; r < num_rovers; r++) {
+        if (r != t->rover) root->currState.rovers[r].available = 0;
+    }
+    root->depth = 0;
+    root->g = 0;
+    root->h = heuristic(root->currState);
+    root->f = node_f(astar, root->g, root->h);
+    root->id = 0;
+    root_state = &root->currState; // Kept for the compact frontier.
+
+    frontier = createMinHeap(1000);
+    if (frontier == NULL || add_frontier_in_order(root) < 0) {
+        printf("Memory exhausted while creating the frontier of rover %d. Search is terminated...\n", t->rover);
+        free(root);
+        if (frontier != NULL) freeMinHeap(frontier);
+        return NULL;
+    }
+
+    struct tree_node *reached = search(astar);
+    if (reached != NULL) {
+        t->plan = node_path(reached, &t->plan_len);
+        t->energy = reached->g;
+    } else {
+        release_frontier();
+    }
+
+    free_search_tree(NULL);
+    if (compact_frontier) free(root); // Otherwise the root was extracted and freed with the tree.
+    root_state = NULL;
+    free(child_batch);
+    child_batch = NULL;
+    child_batch_len = child_batch_cap = 0;
+    free_state_set();
+    t->inserts = total_inserts;
+    t->extracts = total_extracts;
+    t->h_stats = h_stats;
+    free_h_cache();
+    return NULL;
+}
+
+/**
+ * @brief Solves the subproblems of the rovers whose goals changed (marked dirty), one thread per rover.
+ *
+ * When a subproblem fails, its rover hands the more expensive half of its goals
+ * over to other rovers (factored_reassign) and the changed subproblems are solved
+ * again. A rover that cannot hand over any goal searches again with more
+ * extractions (factored_retry). The rounds end when all subproblems succeed or
+ * a rover is left that can do neither.
+ * @return 1 if every rover has a plan for its goals, 0 otherwise.
+ */
+int factored_rounds() {
+    for (int round = 1; ; round++) {
+        for (int r = 0; r < num_rovers; r++) {
+            RoverTask *t = &rover_tasks[r];
+            if (!t->dirty) continue;
+            free(t->plan);
+            t->plan = NULL;
+            t->plan_len = t->energy = 0;
+            if (t->goals > 0 && pthread_create(&t->thread, NULL, rover_task_main, t) != 0) {
+                printf("Cannot create the search thread of rover %d. Search is terminated...\n", r);
+                exit(1);
+            }
+        }
+
+        int failed = 0;
+        for (int r = 0; r < num_rovers; r++) {
+            RoverTask *t = &rover_tasks[r];
+            if (!t->dirty) continue;
+            t->dirty = 0;
+            if (t->goals == 0) continue;
+            pthread_join(t->thread, NULL);
+            total_inserts += t->inserts;
+            total_extracts += t->extracts;
+            h_stats.lookups += t->h_stats.lookups;
+            h_stats.hits += t->h_stats.hits;
+            h_stats.row_lookups += t->h_stats.row_lookups;
+            h_stats.row_hits += t->h_stats.row_hits;
+            if (t->plan != NULL)
+                printf("Round %d, rover %d: %d goals, %d actions (energy %d, %d extracts)\n", round, r, t->goals,
+                       t->plan_len, t->energy, t->extracts);
+            else
+                printf("Round %d, rover %d: %d goals, no plan found (%d extracts)\n", round, r, t->goals, t->extracts);
+        }
+
+        // Reassigning marks the rovers whose goals change for the next round.
+        for (int r = 0; r < num_rovers; r++) {
+            RoverTask *t = &rover_tasks[r];
+            if (t->goals == 0 || t->plan != NULL || t->dirty) continue; // Dirty: took goals of an earlier rover.
+            failed = 1;
+            if (factored_reassign(t) == 0) continue;
+            if (factored_retry(t) < 0) {
+                printf("No goal of rover %d can be given to another rover.\n", r);
+                return 0;
+            }
+            printf("No goal of rover %d can be given to another rover, searching again with %d extractions.\n",
+                   r, t->limit);
+        }
+        if (!failed) break;
+    }
+
+    printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
+    print_h_cache_stats(&h_stats);
+    return 1;
+}
+
+/**
+ * @brief Interleaves the plans of the rovers and replays the result from the initial state.
+ *
+ * The rovers take turns, one action each. Since no rover's actions change what
+ * the actions of another rover need, any interleaving is valid; solution_from_codes
+ * checks this with apply_action.
+ * @param init The initial state.
+ * @return 1 if the merged plan reaches the goal within the energy budget (it is then
+ *         stored in the global solution), 0 otherwise.
+ */
+int merge_rover_plans(State *init) {
+    int length = 0, longest = 0;
+    for (int r = 0; r < num_rovers; r++) {
+        length += rover_tasks[r].plan_len;
+        if (rover_tasks[r].plan_len > longest) longest = rover_tasks[r].plan_len;
+    }
+    CompactAction *plan = (CompactAction*) malloc((length > 0 ? length : 1) * sizeof(CompactAction));
+    if (plan == NULL) {
+        printf("Memory allocation for the merged plan failed!\n");
+        return 0;
+    }
+    length = 0;
+    for (int i = 0; i < longest; i++) {
+        for (int r = 0; r < num_rovers; r++) {
+            if (i < rover_tasks[r].plan_len) plan[length++] = rover_tasks[r].plan[i];
+        }
+    }
+
+    int found = solution_from_codes(init, plan, length);
+    free(plan);
+    if (!found) {
+        printf("The plans of the rovers could not be merged.\n");
+        return 0;
+    }
+    return max_energy < 0 || total_energy <= max_energy;
+}
+
+/**
+ * @brief The factored search (factored).
+ *
+ * Assigns the goals to the rovers (see factored.h), solves the subproblems of all
+ * rovers (factored_rounds) and merges their plans. When the subproblems cannot
+ * all be solved, or the merged plan exceeds --max-energy, all rovers search for
+ * all goals together with the agenda search and its fallback, so that a goal set
+ * that no single rover can achieve is still split between rovers.
+ * @param init The initial state.
+ * @param solution_node Output: the goal node of the joint search (NULL otherwise).
+ * @return 1 if a plan was found (the plan of the rovers is then stored in the
+ *         global solution, unless the joint search found it), 0 otherwise.
+ */
+int factored_search(State *init, struct tree_node **solution_node) {
+    if (factored_assign(init) < 0) {
+        printf("Some goal cannot be achieved by any rover.\n");
+        return 0;
+    }
+    if (factored_rounds() && merge_rover_plans(init))
+        return 1;
+
+    printf("Falling back to the agenda search for all goals...\n");
+    int fallback = agenda_fallback;
+    agenda_fallback = 1;
+    initialize_search(*init, best);
+    *solution_node = agenda_search();
+    agenda_fallback = fallback;
+    return *solution_node != NULL;
+}
+
+/**
+ * @brief The hierarchical solver (hier).
+ *
+ * Assigns the goals to the rovers and improves the assignment by local search,
+ * then executes every rover's tour (see hier.h). The rovers whose tour could not
+ * be executed are left dirty for the per-rover search of factored_rounds, and the
+ * plans are merged as in the factored search.
+ * @param init The initial state.
+ * @return 1 if a plan was found (it is then stored in the global solution), 0 otherwise.
+ */
+int hier_search(State *init) {
+    if (factored_assign(init) < 0) {
+        printf("Some goal cannot be achieved by any rover.\n");
+        return 0;
+    }
+
+    int estimate = hier_improve(init);
+    if (estimate != INT_MAX)
+        printf("Assignment: estimated energy %d\n", estimate);
+
+    for (int r = 0; r < num_rovers; r++) {
+        RoverTask *t = &rover_tasks[r];
+        if (t->goals == 0) continue;
+        t->dirty = !hier_route(init, t);
+        if (t->dirty)
+            printf("Rover %d: %d goals, the tour could not be executed\n", r, t->goals);
+        else
+            printf("Rover %d: %d goals, %d actions (energy %d)\n", r, t->goals, t->plan_len, t->energy);
+    }
+    return factored_rounds() && merge_rover_plans(init);
+}
+
+/**
+ * @brief Chooses the methods for a problem from its features (auto).
+ *
+ * The rules follow where the methods did best on the benchmark problems:
+ * - When some goal is unreachable, A* stops at once (the routing bound of the root
+ *   is infinite; the task assignment estimate alone proves nothing).
+ * - Few goals far apart, with enough energy, suit the regression search, whose
+ *   states only hold what the rest of the plan needs.
+ * - Otherwise the hierarchical solver, which scales to the largest problems, with
+ *   the action elimination on the plan it finds.
+ * The methods are tried in turn until one finds a plan: the regression search is
+ * followed by hier, and hier, whose per-rover tours may fail when the rovers must
+ * recharge, by the agenda search.
+ * @param f The features of the problem.
+ * @param methods Output: the methods to try, in order.
+ * @return The number of methods.
+ */
+int select_methods(const InstanceFeatures *f, int methods[AUTO_METHODS]) {
+    int count = 0;
+    const char *reason;
+
+    if (f->unreachable) {
+        methods[count++] = astar;
+        reason = "some goal is unreachable";
+    }
+    else {
+        if (f->goals <= AUTO_REGRESSION_GOALS && f->diameter >= AUTO_REGRESSION_DIAMETER && f->tightness <= AUTO_TIGHT) {
+            methods[count++] = regression;
+            reason = "few goals far apart";
+        }
+        else
+            reason = f->tightness > AUTO_TIGHT ? "tight energy" : "many goals or a small map";
+        methods[count++] = hier;
+        methods[count++] = agenda;
+        eliminate = 1;
+    }
+
+    printf("Methods: ");
+    for (int i = 0; i < count; i++) printf("%s%s", i > 0 ? ", then " : "", method_names[methods[i]]);
+    printf("%s (%s)\n", eliminate ? ", with --eliminate" : "", reason);
+    return count;
+}
+
+/**
+ * @brief The multi-process Best-First Search (one call per process).
+ *
+ * Every process runs this loop on the states it owns: it receives the nodes that
+ * other processes generated for it, keeps the new ones in its frontier, expands
+ * its best node and sends the children owned by others in batches. A process that
+ * reaches a goal sends the plan to process 0, which ends the search for everybody;
+ * when no process has any work left, Safra's token algorithm detects it.
+ * @param root_state The initial state.
+ * @return 1 if a plan was found (it is then stored in the global solution on process 0), 0 otherwise.
+ */
+int distributed_search(State *root_state) {
+    long long expansions = 0;
+    int reported = 0;
+
+    dist_template = *root_state;
+    if (dist_setup(root_state) < 0) {
+        printf("Cannot set up the connections between the processes. Search is terminated...\n");
+        return 0;
+    }
+
+    // The root belongs to exactly one process; the others start with an empty frontier.
+    struct tree_node *root = (struct tree_node*) heap_node_at(frontier, 0);
+    StateKey sk;
+    make_state_key(&root->currState, &sk);
+    if (dist_owner(state_key_hash(&sk)) != dist_rank) {
+        extract_min(frontier);
+        free(root);
+    }
+
+    while (!dist_stop) {
+        dist_poll(0);
+
+        // Take in the nodes received from other processes.
+        for (int i = 0; i < dist_inbox_len; i++) {
+            DistNode *in = &dist_inbox[i];
+            struct tree_node *node = (struct tree_node*) malloc(sizeof(struct tree_node));
+            if (node == NULL) {
+                printf("Memory exhausted while receiving a node. Search is terminated...\n");
+                exit(1);
+            }
+            unpack_state_key(&in->key, &dist_template, &node->currState);
+            node->parent = NULL;
+            node->depth = in->path_len;
+            node->g = in->g;
+            node->action_taken.action_type = -1;
+            if (in->path_len > 0) node->action_taken.code = in->path[in->path_len - 1];
+
+            if ((max_energy >= 0 && over_budget(node)) || !check_with_parents(node)) {
+                free(node);
+                free(in->path);
+                continue;
+            }
+            if (max_energy < 0) node->h = heuristic(node->currState);
+            node->f = node_f(best, node->g, node->h);
+
+            path_entry *entry = (path_entry*) malloc(sizeof(path_entry));
+            entry->node = node;
+            entry->path = in->path;
+            entry->path_len = in->path_len;
+            HASH_ADD_PTR(remote_paths, node, entry);
+
+            add_frontier_in_order(node);
+        }
+        dist_inbox_len = 0;
+
+        if (dist_rank == 0 && dist_plan_len >= 0) {
+            dist_broadcast_stop();
+            break;
+        }
+
+        if (!reported && !is_empty_heap(frontier)) {
+            struct tree_node *current_node = (struct tree_node*) extract_min(frontier).node;
+            total_extracts++;
+
+            if (is_goal_state(&current_node->currState)) {
+                int path_len;
+                CompactAction *path = node_path(current_node, &path_len);
+                dist_report_plan(path, path_len);
+                free(path);
+                reported = 1;
+                continue;
+            }
+
+            if (find_children(current_node, best) < 0) {
+                printf("Memory exhausted while creating new frontier node. Search is terminated...\n");
+                exit(1);
+            }
+            if (generated_goal != NULL) {
+                int path_len;
+                CompactAction *path = node_path(generated_goal, &path_len);
+                dist_report_plan(path, path_len);
+                free(path);
+                reported = 1;
+                continue;
+            }
+            if (++expansions % DIST_FLUSH_INTERVAL == 0) dist_flush_all();
+        }
+        else {
+            // Passive: send everything out and take part in termination detection.
+            dist_flush_all();
+            if (dist_passive()) {
+                dist_broadcast_stop();
+                break;
+            }
+            dist_poll(10);
+        }
+    }
+
+    printf("Process %d: inserts=%d, extracts=%d, nodes sent=%lld, nodes received=%lld, messages=%lld, bytes=%lld\n",
+           dist_rank, total_inserts, total_extracts, dist_nodes_sent, dist_nodes_received,
+           dist_messages_sent, dist_bytes_sent);
+    print_h_cache_stats(&h_stats);
+
+    dist_finish();
+
+    if (dist_rank == 0 && dist_plan_len >= 0)
+        return solution_from_codes(&dist_template, dist_plan, dist_plan_len);
+    return 0;
+}
+
+/**
+ * @brief Sets up the search of a method and runs it.
+ * @param init The initial state.
+ * @param method The method.
+ * @param solution_node Output: the goal node of the tree searches (NULL otherwise).
+ * @return 1 if a plan was found, 0 otherwise.
+ */
+int run_method(State *init, int method, struct tree_node **solution_node) {
+	// Set up the initial data structures for the search
+	if (resume_file[0] != '\0')
+		resume_search(method);
+	else if (method == factored || method == hier || method == regression)
+		precompute_shortest_paths(init);
+	else
+		initialize_search(*init, method == agenda ? best : method);
+
+	// Start the main search loop
+	*solution_node = NULL;
+	if (dist_procs > 1)
+		return distributed_search(init);
+	if (method == factored)
+		return factored_search(init, solution_node);
+	if (method == hier)
+		return hier_search(init);
+	if (method == regression)
+		return regression_search(init, max_energy);
+	if (method == agenda)
+		*solution_node = agenda_search();
+	else
+		*solution_node = (num_threads > 1) ? parallel_search() : search(method);
+	return *solution_node != NULL;
+}
+
+/**
+ * @brief Main entry point of the program.
+ *
+ * Handles command-line argument parsing, calls the PDDL parser,
+ * initiates the search, and prints the final solution and statistics.
+ */
+int main(int argc, char** argv) {
+    if (argc<4) {
+		printf("Wrong number of arguments. Use correct syntax:\n");
+		syntax_message();
+		return -1;
+	}
+
+	int method=get_method(argv[1]); // The search algorithm that will be used to solve the problem.
+	if (method<0) {
+		printf("Wrong method. Use correct syntax:\n");
+		syntax_message();
+		return -1;
+	}
+
+	if (parse_options(argc, argv) < 0) {
+		printf("Wrong options. Use correct syntax:\n");
+		syntax_message();
+		return -1;
+	}
+
+	if (num_threads > 1 && method != best) {
+		printf("Multi-threaded search is only available for the best method.\n");
+		return -1;
+	}
+
+	if (helpful_actions && method == astar) {
+		printf("Helpful actions are only available for the best, agenda and factored methods.\n");
+		return -1;
+	}
+
+	if (lookahead && (method == astar || trace_file[0] != '\0')) {
+		printf("The lookahead is only available for the best, agenda and factored methods, without --trace.\n");
+		return -1;
+	}
+
+	if (dist_procs > 1 && (method != best || num_threads > 1 || dist_rank < 0 || dist_rank >= dist_procs || dist_spec[0] == '\0')) {
+		printf("Multi-process search needs the best method, one thread per process, --rank and --peers.\n");
+		return -1;
+	}
+
+	if (method == agenda && (num_threads > 1 || dist_procs > 1 || checkpoint_file[0] != '\0' || resume_file[0] != '\0' || trace_file[0] != '\0')) {
+		printf("The agenda method runs in a single thread and process, without checkpoints or --trace.\n");
+		return -1;
+	}
+
+	if ((method == factored || method == hier) && (num_threads > 1 || dist_procs > 1 || checkpoint_file[0] != '\0' || resume_file[0] != '\0'
+	                           || trace_file[0] != '\0' || analysis_prefix[0] != '\0')) {
+		printf("The factored and hier methods run one thread per rover, without checkpoints, --trace or --analyze.\n");
+		return -1;
+	}
+
+	if (method == regression && (num_threads > 1 || dist_procs > 1 || checkpoint_file[0] != '\0' || resume_file[0] != '\0'
+	                             || trace_file[0] != '\0' || analysis_prefix[0] != '\0' || helpful_actions || lookahead)) {
+		printf("The regression method runs in a single thread and process, without checkpoints, --trace, --analyze, --helpful-actions or --lookahead.\n");
+		return -1;
+	}
+
+	if (estimate_interval > 0 && (method != astar || num_threads > 1 || dist_procs > 1)) {
+		printf("The effort estimate is only available for the single-threaded, single-process astar method.\n");
+		return -1;
+	}
+
+	if (method == automatic && (num_threads > 1 || dist_procs > 1 || checkpoint_file[0] != '\0' || resume_file[0] != '\0'
+	                            || trace_file[0] != '\0' || analysis_prefix[0] != '\0' || helpful_actions || lookahead || bidirectional)) {
+		printf("The auto method chooses the method itself, without threads, processes, checkpoints, --trace, --analyze, --helpful-actions, --lookahead or --bidirectional.\n");
+		return -1;
+	}
+
+	if (bidirectional && method != regression) {
+		printf("The bidirectional search is only available for the regression method.\n");
+		return -1;
+	}
+
+	if (compact_frontier && dist_procs > 1) {
+		printf("The compact frontier is not available for the multi-process search.\n");
+		return -1;
+	}
+
+	if ((checkpoint_file[0] != '\0' || resume_file[0] != '\0') && (num_threads > 1 || dist_procs > 1)) {
+		printf("Checkpoints are only available for the single-threaded, single-process search.\n");
+		return -1;
+	}
+
+	if (analysis_prefix[0] != '\0' && (num_threads > 1 || dist_procs > 1)) {
+		printf("The heuristic analysis is only available for the single-threaded, single-process search.\n");
+		return -1;
+	}
+
+	if (trace_file[0] != '\0' && (num_threads > 1 || dist_procs > 1 || resume_file[0] != '\0')) {
+		printf("Tracing is only available for a new single-threaded, single-process search.\n");
+		return -1;
+	}
+
+	// Parse the PDDL problem file to get the initial state
+	State *initial_state = parse_pddl_file(argv[2]);
+	if (initial_state == NULL) {
+        return -1;
+	}
+
+	if (trace_file[0] != '\0' && trace_open() < 0)
+		return -1;
+
+	printf("Solving %s using %s...\n",argv[2],argv[1]);
+	c1 = clock();
+	t1 = time(NULL);
+	last_checkpoint = t1;
+	problem_state = initial_state;
+
+	// Choose the methods from the features of the problem
+	int methods[AUTO_METHODS] = {method}, method_count = 1;
+	if (method == automatic) {
+		InstanceFeatures features;
+		precompute_shortest_paths(initial_state);
+		extract_features(initial_state, &features);
+		print_features(&features);
+		method_count = select_methods(&features, methods);
+	}
+
+	struct tree_node *solution_node;
+	int found = 0;
+	for (int i = 0; i < method_count && !found; i++) {
+		if (i > 0)
+			printf("No plan found by %s, trying %s...\n", method_names[methods[i - 1]], method_names[methods[i]]);
+		method = methods[i];
+		found = run_method(initial_state, method, &solution_node);
+	}
+
+	c2 = clock();
+
+	// Let a checkpoint that is still being written finish.
+	wait_checkpoint(1);
+	trace_close();
+
+	// Clean up memory
+	HASH_CLEAR(hh, state_set);
+
+	// Only process 0 reports the result of a multi-process search.
+	if (dist_rank != 0)
+		return 0;
+
+	// If a solution was found, reconstruct and print the plan
+	if (solution_node!=NULL)
+		extract_solution(solution_node);
+	else if (!found && method == regression && reg_limit_reached)
+		printf("No solution found within the limit of %d partial states; a larger --regression-nodes may find one.\n", regression_nodes);
+	else if (!found && max_energy >= 0)
+		printf("No solution found within the energy budget of %d.\n", max_energy);
+	else if (!found)
+		printf("No solution found.\n");
+
+	if (found && eliminate && eliminate_plan(initial_state) < 0)
+		return -1;
+	if (found && improve_seconds > 0 && improve_plan(initial_state) < 0)
+		return -1;
+
+    if (found) {
+		printf("Solution found! (%d steps) (Total recharges: %d)\n",solution_length,total_recharges);
+		printf("(Total energy spent: %d)\n", total_energy);
+		printf("Time spent: %f secs\n",((float) c2-c1)/CLOCKS_PER_SEC);
+		write_solution_to_file(argv[3]);
+		if (analysis_prefix[0] != '\0')
+			write_analysis(initial_state, method_names[method]);
+	}
+
+    return 0;
+}
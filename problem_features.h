@@ -0,0 +1,116 @@
+/**
+ * @file problem_features.h
+ * @brief Instance features for the automatic method selection (auto).
+ *
+ * A handful of numbers that are cheap to compute once the problem is parsed and
+ * the shortest paths are known: the size of the problem, the goals, how tight
+ * the energy is, how much of the map lies in the sun, the diameter of the
+ * rovers' maps and the heuristic value of the initial state. select_methods in
+ * planner.c maps them to the methods to try.
+ */
+
+#ifndef PROBLEM_FEATURES_H
+#define PROBLEM_FEATURES_H
+
+#include <stdio.h>
+
+#include "auxiliary.h"
+#include "heuristic.h"
+
+/**
+ * @struct InstanceFeatures
+ * @brief The features of a problem.
+ */
+typedef struct {
+    int rovers;            // Available rovers.
+    int waypoints;         // Waypoints.
+    int objectives;        // Objectives.
+    int cameras;           // Cameras.
+    int soil_goals;        // Soil data to communicate.
+    int rock_goals;        // Rock data to communicate.
+    int image_goals;       // Images to communicate.
+    int goals;             // All goals.
+    int busy_rovers;       // Rovers that are the cheapest for at least one goal.
+    int sun_percent;       // Share of the waypoints in the sun (percent).
+    int diameter;          // Most moves any rover needs between two waypoints it can connect.
+    int root_h;            // Heuristic value of the initial state (INT_MAX: unsolvable).
+    int unreachable;       // Some goal can never be achieved: the routing bound of the initial state is infinite.
+    int energy;            // Energy of the available rovers at the initial state.
+    int tightness;         // root_h as a share of that energy (percent); above 100, recharges are needed.
+} InstanceFeatures;
+
+/**
+ * @brief Computes the features of a problem.
+ *
+ * Needs the shortest paths (precompute_shortest_paths) of the initial state.
+ * @param init The initial state.
+ * @param f Output: the features.
+ */
+void extract_features(State *init, InstanceFeatures *f) {
+    int cheapest[MAX_ROVERS] = {0}, row[ROW_CACHE_GOALS];
+
+    memset(f, 0, sizeof(InstanceFeatures));
+    f->waypoints = num_waypoints;
+    f->objectives = num_objectives;
+    f->cameras = num_cameras;
+
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        f->soil_goals += goal.communicated_soil_data[wp] != 0;
+        f->rock_goals += goal.communicated_rock_data[wp] != 0;
+        f->sun_percent += init->waypoints[wp].in_sun != 0;
+    }
+    for (int o = 0; o < num_objectives; o++) {
+        for (int m = 0; m < num_modes; m++) f->image_goals += goal.communicated_image_data[o][m] != 0;
+    }
+    f->goals = f->soil_goals + f->rock_goals + f->image_goals;
+    f->sun_percent = num_waypoints > 0 ? 100 * f->sun_percent / num_waypoints : 0;
+
+    for (int r = 0; r < num_rovers; r++) {
+        if (!init->rovers[r].available) continue;
+        f->rovers++;
+        f->energy += init->rovers[r].energy;
+        for (int i = 0; i < num_waypoints; i++) {
+            for (int j = 0; j < num_waypoints; j++) {
+                if (dist[r][i][j] != INT_MAX && dist[r][i][j] / 8 > f->diameter) f->diameter = dist[r][i][j] / 8;
+            }
+        }
+    }
+
+    // The rover with the lowest cost of every goal (the row holds the goals in order).
+    int best_cost[ROW_CACHE_GOALS], best_rover[ROW_CACHE_GOALS];
+    for (int i = 0; i < f->goals && i < ROW_CACHE_GOALS; i++) {
+        best_cost[i] = INT_MAX;
+        best_rover[i] = -1;
+    }
+    for (int r = 0; r < num_rovers; r++) {
+        rover_goal_costs(init, r, row);
+        for (int i = 0; i < f->goals && i < ROW_CACHE_GOALS; i++) {
+            if (row[i] < best_cost[i]) {
+                best_cost[i] = row[i];
+                best_rover[i] = r;
+            }
+        }
+    }
+    for (int i = 0; i < f->goals && i < ROW_CACHE_GOALS; i++) {
+        if (best_rover[i] >= 0 && best_cost[i] > 0) cheapest[best_rover[i]] = 1; // Not achieved initially.
+    }
+    for (int r = 0; r < num_rovers; r++) f->busy_rovers += cheapest[r];
+
+    f->unreachable = !is_goal_state(init) && routing_bound(init) == INT_MAX;
+    f->root_h = evaluate_heuristic(init);
+    if (f->root_h == INT_MAX) f->tightness = INT_MAX;
+    else f->tightness = f->energy > 0 ? 100 * f->root_h / f->energy : INT_MAX;
+}
+
+/**
+ * @brief Prints the features of a problem on one line.
+ */
+void print_features(const InstanceFeatures *f) {
+    printf("Features: rovers=%d (busy %d), waypoints=%d, objectives=%d, cameras=%d, goals=%d (soil %d, rock %d, image %d), "
+           "sun=%d%%, diameter=%d, h=%d, energy=%d, tightness=%d%%\n",
+           f->rovers, f->busy_rovers, f->waypoints, f->objectives, f->cameras, f->goals, f->soil_goals, f->rock_goals,
+           f->image_goals, f->sun_percent, f->diameter, f->root_h == INT_MAX ? -1 : f->root_h, f->energy,
+           f->tightness == INT_MAX ? -1 : f->tightness);
+}
+
+#endif // PROBLEM_FEATURES_H
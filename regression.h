@@ -0,0 +1,1009 @@
+/**
+ * @file regression.h
+ * @brief Regression search from the goal over partial states (regression).
+ *
+ * All goals are communications, which only happen near the lander, so a search
+ * forward from the initial state spends most of its effort on rover moves that
+ * do not matter. The regression search starts from the goal instead and only
+ * ever applies actions that achieve something the current partial state
+ * requires. A partial state is a set of required facts (see PartialState): the
+ * communications still needed, the analyses and images every rover must hold,
+ * the calibrated cameras, the samples that must still lie on the ground, the
+ * stores that must be empty or full, the position of every rover that has to be
+ * somewhere, and an energy interval per rover. Regressing an action removes the
+ * facts it adds, requires its preconditions and moves the energy interval by its
+ * cost; an action that deletes a required fact is not regressed. Negative
+ * preconditions (data not yet communicated) become prohibitions, which hold for
+ * the rest of the regression since communications are never undone. The search
+ * ends at a partial state that the initial state satisfies, and the actions on
+ * the way back to the goal are the plan, in order.
+ *
+ * The heuristic is computed once from the initial state (regression_costs), as
+ * in HSPr: every required fact gets the cost of reaching it from the initial
+ * state, and a rover that has to collect some data and then be at some
+ * waypoint pays for the detour over the farthest of its data sites
+ * (regression_rover_h).
+ *
+ * With --bidirectional, an A* search forward from the initial state runs at the
+ * same time; the side with the smaller open list expands next. Every partial
+ * state the regression generates goes into a meeting index (meet_add), and every
+ * state the forward search generates is looked up in it (meet_find): once a
+ * forward state satisfies a partial state, the forward path and the regression
+ * path back to the goal form the plan.
+ */
+
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "auxiliary.h"
+#include "heuristic.h"
+#include "minheap.h"
+#include "statekey.h"
+#include "solution.h"
+#include "improve.h"
+#include "uthash.h"
+
+#define REGRESSION_NODES 2000000       // Default partial states the regression may generate.
+#define FORWARD_NODES    2000000       // Default states the forward half of --bidirectional may generate.
+#define MEET_SHAPES      1024          // Shapes of partial states in the meeting index (see meet_add).
+#define ENERGY_FREE      32767         // Upper energy bound of a rover without one.
+#define REG_ANYWHERE     MAX_WAYPOINTS // Column of reg_via for a rover without a required position.
+#define REG_SITES        (2 * MAX_WAYPOINTS + MAX_OBJECTIVES + MAX_CAMERAS) // Soil, rock, image and calibration sites.
+
+int bidirectional = 0; // Search forward from the initial state as well (--bidirectional).
+int regression_nodes = REGRESSION_NODES; // Partial states the regression may generate (--regression-nodes).
+int forward_nodes = FORWARD_NODES;       // States the forward search may generate (--forward-nodes).
+int reg_limit_reached = 0;               // Set when the regression stopped at regression_nodes.
+
+/**
+ * @struct PartialState
+ * @brief The facts a state must have to reach the goal with the regressed actions.
+ *
+ * Images use the bit layout of StateKey (objective * num_modes + mode), so that
+ * partial_satisfied can compare with a StateKey directly. Fields are ordered
+ * from widest to narrowest, so the struct has no padding and can be hashed.
+ */
+typedef struct {
+    unsigned int soil[MAX_ROVERS];    // Soil analyses every rover must hold (bitmap of waypoints).
+    unsigned int rock[MAX_ROVERS];    // Rock analyses every rover must hold (bitmap of waypoints).
+    unsigned int image[MAX_ROVERS];   // Images every rover must hold (bitmap of (objective, mode) pairs).
+    unsigned int soil_sample;         // Waypoints that must still have their soil sample.
+    unsigned int rock_sample;         // Waypoints that must still have their rock sample.
+    unsigned int comm_soil;           // Soil data that must have been communicated.
+    unsigned int comm_rock;           // Rock data that must have been communicated.
+    unsigned int comm_image;          // Images that must have been communicated.
+    unsigned int no_soil;             // Soil data that must not have been communicated yet.
+    unsigned int no_rock;             // Rock data that must not have been communicated yet.
+    unsigned int no_image;            // Images that must not have been communicated yet.
+    unsigned short calibrated;        // Cameras that must be calibrated.
+    unsigned short empty;             // Stores that must be empty.
+    unsigned short full;              // Stores that must be full.
+    short energy_lo[MAX_ROVERS];      // Lowest energy every rover may have.
+    short energy_hi[MAX_ROVERS];      // Highest energy every rover may have (ENERGY_FREE: no bound).
+    signed char position[MAX_ROVERS]; // Waypoint every rover must be at (-1: any).
+} PartialState;
+
+/**
+ * @struct RegNode
+ * @brief A node of the regression search.
+ */
+typedef struct reg_node {
+    PartialState p;              // The partial state.
+    int g;                       // Energy of the actions from here to the goal.
+    int h;                       // Estimated energy from the initial state to here.
+    struct reg_node *parent;     // The partial state `action` leads to (NULL for the goal).
+    CompactAction action;        // The action regressed to get here.
+    struct reg_node *next_meet;  // Next node of the same bucket of the meeting index.
+    UT_hash_handle hh;           // Handle of the closed set.
+} RegNode;
+
+/**
+ * @struct FwdNode
+ * @brief A node of the forward half of the bidirectional search.
+ */
+typedef struct fwd_node {
+    StateKey key;                // The state.
+    int g, h;                    // Energy spent so far, and the heuristic value.
+    struct fwd_node *parent;     // The state before `action` (NULL for the initial state).
+    CompactAction action;        // The action that led here.
+    UT_hash_handle hh;           // Handle of the closed set.
+} FwdNode;
+
+/**
+ * @struct MeetKey
+ * @brief Key of a bucket of the meeting index: required communications and rover positions.
+ */
+typedef struct {
+    unsigned int comm_soil, comm_rock, comm_image; // Required communications.
+    unsigned int rovers;                           // Rovers with a required position (bitmap).
+    signed char position[MAX_ROVERS];              // Their positions (0 for the others).
+} MeetKey;
+
+/**
+ * @struct MeetBucket
+ * @brief The partial states of the meeting index with the same MeetKey.
+ */
+typedef struct {
+    MeetKey key;
+    RegNode *nodes;              // Linked through next_meet.
+    UT_hash_handle hh;
+} MeetBucket;
+
+State *reg_init;                                       // The initial state (also the template of the static facts).
+StateKey reg_init_key;                                 // Its key.
+int reg_via[MAX_ROVERS][REG_SITES][MAX_WAYPOINTS + 1]; // Travel from the initial position over a site to a waypoint.
+int reg_comm_soil[MAX_WAYPOINTS];                      // Cost of communicating soil data, from the initial state.
+int reg_comm_rock[MAX_WAYPOINTS];                      // Cost of communicating rock data.
+int reg_comm_image[MAX_OBJECTIVES * MAX_MODES];        // Cost of communicating an image.
+unsigned int reg_modes[MAX_ROVERS];                    // Modes the cameras of every rover support (bitmap).
+
+RegNode *reg_closed = NULL;  // Closed set of the regression.
+MinHeap *reg_open = NULL;    // Open list of the regression.
+int reg_count = 0;           // Partial states generated.
+RegNode *reg_found = NULL;   // Partial state satisfied by the initial state.
+int reg_budget = -1;         // Energy budget of the plan (-1: none).
+
+FwdNode *fwd_closed = NULL;  // Closed set of the forward search.
+MinHeap *fwd_open = NULL;    // Open list of the forward search.
+int fwd_count = 0;           // States generated forward.
+State fwd_target;            // The initial state with every goal achieved (see window_actions).
+FwdNode *fwd_met = NULL;     // Forward state that satisfies...
+RegNode *reg_met = NULL;     // ...this partial state.
+
+MeetBucket *meet_index = NULL;          // The meeting index.
+MeetKey meet_shapes[MEET_SHAPES];       // Distinct (communications, rovers) of the index, positions zeroed.
+int meet_shape_count = 0;
+
+/**
+ * @brief Travel of a rover from its initial position over the best waypoint of a site to a waypoint.
+ * @param r The rover.
+ * @param sites The waypoints of the site (bitmap).
+ * @param to The waypoint, or REG_ANYWHERE.
+ * @return The energy, or INT_MAX if no waypoint of the site can be reached.
+ */
+int regression_site_via(int r, unsigned int sites, int to) {
+    int from = reg_init->rovers[r].position, best = INT_MAX;
+    for (int t = 0; t < num_waypoints; t++) {
+        if (!(sites & (1u << t)) || dist[r][from][t] == INT_MAX) continue;
+        int rest = to == REG_ANYWHERE ? 0 : dist[r][t][to];
+        if (rest != INT_MAX && dist[r][from][t] + rest < best) best = dist[r][from][t] + rest;
+    }
+    return best;
+}
+
+/**
+ * @brief Computes the cost tables of the heuristic from the initial state (once per search).
+ */
+void regression_costs(State *init) {
+    for (int r = 0; r < num_rovers; r++) {
+        int has_store = 0;
+        reg_modes[r] = 0;
+        for (int st = 0; st < num_stores; st++) has_store |= init->stores[st].rover_id == r;
+        for (int c = 0; c < num_cameras; c++) {
+            if (init->cameras[c].rover_id == r && init->rovers[r].equipped_imaging) reg_modes[r] |= init->cameras[c].modes_supported;
+        }
+
+        for (int site = 0; site < REG_SITES; site++) {
+            unsigned int sites = 0;
+            if (site < MAX_WAYPOINTS) {
+                if (site < num_waypoints && init->waypoints[site].has_soil_sample && init->rovers[r].equipped_soil && has_store) sites = 1u << site;
+            }
+            else if (site < 2 * MAX_WAYPOINTS) {
+                int wp = site - MAX_WAYPOINTS;
+                if (wp < num_waypoints && init->waypoints[wp].has_rock_sample && init->rovers[r].equipped_rock && has_store) sites = 1u << wp;
+            }
+            else if (site < 2 * MAX_WAYPOINTS + MAX_OBJECTIVES) {
+                int o = site - 2 * MAX_WAYPOINTS;
+                if (o < num_objectives && reg_modes[r]) sites = init->objectives[o].visible_waypoints;
+            }
+            else {
+                int c = site - 2 * MAX_WAYPOINTS - MAX_OBJECTIVES;
+                if (c < num_cameras && init->cameras[c].rover_id == r && init->rovers[r].equipped_imaging) {
+                    for (int o = 0; o < num_objectives; o++) {
+                        if (init->cameras[c].calibration_targets & (1 << o)) sites |= init->objectives[o].visible_waypoints;
+                    }
+                }
+            }
+            for (int to = 0; to <= REG_ANYWHERE; to++) {
+                reg_via[r][site][to] = sites != 0 && (to < num_waypoints || to == REG_ANYWHERE) ? regression_site_via(r, sites, to) : INT_MAX;
+            }
+        }
+    }
+
+    // A communication costs the cheapest rover its data, the way to a waypoint that sees the lander, and the message.
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        reg_comm_soil[wp] = reg_comm_rock[wp] = INT_MAX;
+        for (int r = 0; r < num_rovers; r++) {
+            if (!init->rovers[r].available) continue;
+            int from = init->rovers[r].position, cost;
+            if (init->rovers[r].has_soil_analysis & (1 << wp)) cost = comm_dist[r][from];
+            else if (reg_via[r][wp][REG_ANYWHERE] == INT_MAX || comm_dist[r][wp] == INT_MAX) cost = INT_MAX;
+            else cost = dist[r][from][wp] + 3 + comm_dist[r][wp];
+            if (cost != INT_MAX && cost + 4 < reg_comm_soil[wp]) reg_comm_soil[wp] = cost + 4;
+
+            if (init->rovers[r].has_rock_analysis & (1 << wp)) cost = comm_dist[r][from];
+            else if (reg_via[r][MAX_WAYPOINTS + wp][REG_ANYWHERE] == INT_MAX || comm_dist[r][wp] == INT_MAX) cost = INT_MAX;
+            else cost = dist[r][from][wp] + 5 + comm_dist[r][wp];
+            if (cost != INT_MAX && cost + 4 < reg_comm_rock[wp]) reg_comm_rock[wp] = cost + 4;
+        }
+    }
+    for (int o = 0; o < num_objectives; o++) {
+        for (int m = 0; m < num_modes; m++) {
+            int bit = o * num_modes + m;
+            reg_comm_image[bit] = INT_MAX;
+            for (int r = 0; r < num_rovers; r++) {
+                if (!init->rovers[r].available) continue;
+                int from = init->rovers[r].position, cost = INT_MAX;
+                if (init->rovers[r].have_image[o][m]) cost = comm_dist[r][from];
+                else if (reg_modes[r] & (1u << m)) {
+                    for (int t = 0; t < num_waypoints; t++) {
+                        if (!(init->objectives[o].visible_waypoints & (1 << t)) || dist[r][from][t] == INT_MAX || comm_dist[r][t] == INT_MAX) continue;
+                        if (dist[r][from][t] + 3 + comm_dist[r][t] < cost) cost = dist[r][from][t] + 3 + comm_dist[r][t];
+                    }
+                }
+                if (cost != INT_MAX && cost + 6 < reg_comm_image[bit]) reg_comm_image[bit] = cost + 6;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Estimates the energy a rover spends from the initial state to a partial state.
+ *
+ * The rover has to visit a site of every analysis, image and calibration it must
+ * hold and does not hold initially, and then be at its required position; the
+ * farthest such detour is its travel. The work of the actions is added.
+ * @return The estimate, or INT_MAX if some site cannot be reached.
+ */
+int regression_rover_h(const PartialState *p, int r) {
+    int to = p->position[r] >= 0 ? p->position[r] : REG_ANYWHERE, from = reg_init->rovers[r].position;
+    int travel = to == REG_ANYWHERE ? 0 : dist[r][from][to], work = 0;
+    unsigned int soil = p->soil[r] & ~reg_init_key.has_soil_analysis[r];
+    unsigned int rock = p->rock[r] & ~reg_init_key.has_rock_analysis[r];
+    unsigned int image = p->image[r] & ~reg_init_key.have_image_bm[r];
+    unsigned int calibrated = p->calibrated & ~reg_init_key.cameras_calibrated;
+
+    for (int wp = 0; wp < num_waypoints && (soil | rock); wp++) {
+        if ((soil >> wp) & 1) {
+            if (reg_via[r][wp][to] > travel) travel = reg_via[r][wp][to];
+            work += 3;
+        }
+        if ((rock >> wp) & 1) {
+            if (reg_via[r][MAX_WAYPOINTS + wp][to] > travel) travel = reg_via[r][MAX_WAYPOINTS + wp][to];
+            work += 5;
+        }
+    }
+    for (int bit = 0; bit < num_objectives * num_modes && image; bit++) {
+        if (!((image >> bit) & 1)) continue;
+        if (!(reg_modes[r] & (1u << (bit % num_modes)))) return INT_MAX;
+        if (reg_via[r][2 * MAX_WAYPOINTS + bit / num_modes][to] > travel) travel = reg_via[r][2 * MAX_WAYPOINTS + bit / num_modes][to];
+        work += 1;
+    }
+    for (int c = 0; c < num_cameras && calibrated; c++) {
+        if (!((calibrated >> c) & 1) || reg_init->cameras[c].rover_id != r) continue;
+        if (reg_via[r][2 * MAX_WAYPOINTS + MAX_OBJECTIVES + c][to] > travel) travel = reg_via[r][2 * MAX_WAYPOINTS + MAX_OBJECTIVES + c][to];
+        work += 2;
+    }
+    return travel == INT_MAX ? INT_MAX : travel + work;
+}
+
+/**
+ * @brief The heuristic of the regression: estimated energy from the initial state to a partial state.
+ * @return The estimate, or INT_MAX if the initial state cannot reach the partial state.
+ */
+int regression_h(const PartialState *p) {
+    unsigned int soil_taken = 0, rock_taken = 0;
+    int h = 0;
+
+    // Samples only disappear, communications only appear, and every sample can be analysed once.
+    if ((p->soil_sample & ~reg_init_key.has_soil_sample) || (p->rock_sample & ~reg_init_key.has_rock_sample)) return INT_MAX;
+    if ((p->no_soil & reg_init_key.communicated_soil_sample) || (p->no_rock & reg_init_key.communicated_rock_sample)
+        || (p->no_image & reg_init_key.communicated_image)) return INT_MAX;
+    for (int r = 0; r < num_rovers; r++) {
+        unsigned int soil = p->soil[r] & ~reg_init_key.has_soil_analysis[r], rock = p->rock[r] & ~reg_init_key.has_rock_analysis[r];
+        if ((soil & soil_taken) || (rock & rock_taken)) return INT_MAX;
+        soil_taken |= soil;
+        rock_taken |= rock;
+    }
+    if ((p->soil_sample & soil_taken) || (p->rock_sample & rock_taken)) return INT_MAX;
+
+    unsigned int comm_soil = p->comm_soil & ~reg_init_key.communicated_soil_sample;
+    unsigned int comm_rock = p->comm_rock & ~reg_init_key.communicated_rock_sample;
+    unsigned int comm_image = p->comm_image & ~reg_init_key.communicated_image;
+    for (int wp = 0; wp < num_waypoints && (comm_soil | comm_rock); wp++) {
+        if ((comm_soil >> wp) & 1) {
+            if (reg_comm_soil[wp] == INT_MAX) return INT_MAX;
+            h += reg_comm_soil[wp];
+        }
+        if ((comm_rock >> wp) & 1) {
+            if (reg_comm_rock[wp] == INT_MAX) return INT_MAX;
+            h += reg_comm_rock[wp];
+        }
+    }
+    for (int bit = 0; bit < num_objectives * num_modes && comm_image; bit++) {
+        if (!((comm_image >> bit) & 1)) continue;
+        if (reg_comm_image[bit] == INT_MAX) return INT_MAX;
+        h += reg_comm_image[bit];
+    }
+
+    for (int r = 0; r < num_rovers; r++) {
+        int rover_h = regression_rover_h(p, r);
+        if (rover_h == INT_MAX) return INT_MAX;
+        h += rover_h;
+    }
+    return h;
+}
+
+/**
+ * @brief Checks if a state has every fact a partial state requires.
+ */
+int partial_satisfied(const PartialState *p, const StateKey *k) {
+    if ((p->comm_soil & ~k->communicated_soil_sample) || (p->comm_rock & ~k->communicated_rock_sample)
+        || (p->comm_image & ~k->communicated_image)) return 0;
+    if ((p->no_soil & k->communicated_soil_sample) || (p->no_rock & k->communicated_rock_sample)
+        || (p->no_image & k->communicated_image)) return 0;
+    if ((p->soil_sample & ~k->has_soil_sample) || (p->rock_sample & ~k->has_rock_sample)) return 0;
+    if ((p->calibrated & ~k->cameras_calibrated) || (p->full & ~k->full_stores) || (p->empty & k->full_stores)) return 0;
+
+    for (int r = 0; r < num_rovers; r++) {
+        if (p->position[r] >= 0 && p->position[r] != k->rover_positions[r]) return 0;
+        if (k->energy_levels[r] < p->energy_lo[r] || k->energy_levels[r] > p->energy_hi[r]) return 0;
+        if ((p->soil[r] & ~k->has_soil_analysis[r]) || (p->rock[r] & ~k->has_rock_analysis[r])
+            || (p->image[r] & ~k->have_image_bm[r])) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Requires a rover to be at a waypoint before an action that does not move it.
+ * @return 0 if the partial state requires it somewhere else.
+ */
+int regress_position(PartialState *p, int r, int wp) {
+    if (p->position[r] >= 0 && p->position[r] != wp) return 0;
+    p->position[r] = wp;
+    return 1;
+}
+
+/**
+ * @brief Moves the energy interval of a rover back over an action that spends `cost` (and needs as much).
+ * @return 0 if the interval becomes empty.
+ */
+int regress_energy(PartialState *p, int r, int cost) {
+    int lo = p->energy_lo[r] + cost, hi = p->energy_hi[r] == ENERGY_FREE ? ENERGY_FREE : p->energy_hi[r] + cost;
+    if (lo < cost) lo = cost;
+    if (hi > ENERGY_FREE) hi = ENERGY_FREE;
+    if (lo > hi) return 0;
+    p->energy_lo[r] = (short) lo;
+    p->energy_hi[r] = (short) hi;
+    return 1;
+}
+
+/**
+ * @brief Regresses a partial state through an action.
+ *
+ * The static preconditions (traversability, visibility, equipment, ownership of
+ * stores and cameras, goals) are checked against the initial state.
+ * @param p The partial state after the action.
+ * @param action_type The integer ID of the action.
+ * @param params The integer parameters of the action.
+ * @param out Output: the partial state before the action.
+ * @param cost Output: the energy of the action.
+ * @return 1 if the action achieves a required fact, deletes none and its preconditions
+ *         are consistent with p; 0 otherwise.
+ */
+int regress_action(const PartialState *p, int action_type, int *params, PartialState *out, int *cost) {
+    State *s = reg_init;
+    int r = params[0];
+
+    memcpy(out, p, sizeof(PartialState));
+    switch (action_type) {
+        case 0: // navigate
+        {
+            int from = params[1], to = params[2];
+            if (p->position[r] != to || from == to || !s->rovers[r].available) return 0;
+            if (!s->rovers[r].can_traverse[from][to] || !(s->waypoints[from].visible_waypoints & (1 << to))) return 0;
+            out->position[r] = from;
+            *cost = 8;
+            return regress_energy(out, r, 8);
+        }
+        case 1: // recharge
+        {
+            int wp = params[1];
+            if (p->position[r] != wp || !s->waypoints[wp].in_sun) return 0;
+            int lo = p->energy_lo[r] - 20, hi = p->energy_hi[r] == ENERGY_FREE ? 7 : p->energy_hi[r] - 20;
+            if (lo < 0) lo = 0;
+            if (hi > 7) hi = 7;
+            if (lo > hi) return 0;
+            out->energy_lo[r] = (short) lo;
+            out->energy_hi[r] = (short) hi;
+            *cost = 0;
+            return 1;
+        }
+        case 2: // sample_soil
+        case 3: // sample_rock
+        {
+            int store = params[1], wp = params[2], soil = action_type == 2;
+            unsigned int bit = 1u << wp;
+            if (!((soil ? p->soil[r] : p->rock[r]) & bit)) return 0;
+            if (((soil ? p->soil_sample : p->rock_sample) & bit) || (p->empty & (1u << store))
+                || ((soil ? p->comm_soil : p->comm_rock) & bit)) return 0;
+            if (!(soil ? s->rovers[r].equipped_soil : s->rovers[r].equipped_rock) || s->stores[store].rover_id != r) return 0;
+            if (!(soil ? goal.communicated_soil_data[wp] : goal.communicated_rock_data[wp])) return 0;
+            if (!regress_position(out, r, wp)) return 0;
+            if (soil) {
+                out->soil[r] &= ~bit;
+                out->soil_sample |= bit;
+                out->no_soil |= bit;
+            }
+            else {
+                out->rock[r] &= ~bit;
+                out->rock_sample |= bit;
+                out->no_rock |= bit;
+            }
+            out->full &= ~(1u << store);
+            out->empty |= 1u << store;
+            *cost = soil ? 3 : 5;
+            return regress_energy(out, r, *cost);
+        }
+        case 4: // drop
+        {
+            int store = params[1];
+            if (!(p->empty & (1u << store)) || s->stores[store].rover_id != r) return 0;
+            out->empty &= ~(1u << store);
+            out->full |= 1u << store;
+            *cost = 0;
+            return 1;
+        }
+        case 5: // calibrate
+        {
+            int camera = params[1], objective = params[2], wp = params[3];
+            if (!(p->calibrated & (1u << camera))) return 0;
+            if (!s->rovers[r].equipped_imaging || s->cameras[camera].rover_id != r) return 0;
+            if (!(s->cameras[camera].calibration_targets & (1 << objective)) || !(s->objectives[objective].visible_waypoints & (1 << wp))) return 0;
+            if (!regress_position(out, r, wp)) return 0;
+            out->calibrated &= ~(1u << camera);
+            *cost = 2;
+            return regress_energy(out, r, 2);
+        }
+        case 6: // take_image
+        {
+            int wp = params[1], objective = params[2], camera = params[3], mode = params[4];
+            unsigned int bit = 1u << (objective * num_modes + mode);
+            if (!(p->image[r] & bit) || (p->calibrated & (1u << camera)) || (p->comm_image & bit)) return 0;
+            if (!s->rovers[r].equipped_imaging || s->cameras[camera].rover_id != r || !(s->cameras[camera].modes_supported & (1 << mode))) return 0;
+            if (!(s->objectives[objective].visible_waypoints & (1 << wp)) || !goal.communicated_image_data[objective][mode]) return 0;
+            if (!regress_position(out, r, wp)) return 0;
+            out->image[r] &= ~bit;
+            out->calibrated |= 1u << camera;
+            out->no_image |= bit;
+            *cost = 1;
+            return regress_energy(out, r, 1);
+        }
+        case 7: // communicate_soil_data
+        case 8: // communicate_rock_data
+        {
+            int wp = params[1], pos = params[2], lander = params[3], soil = action_type == 7;
+            unsigned int bit = 1u << wp;
+            if (!((soil ? p->comm_soil : p->comm_rock) & bit)) return 0;
+            if (s->lander.lander_position != lander || !(s->waypoints[pos].visible_waypoints & (1 << lander))) return 0;
+            if (!s->rovers[r].available || !s->lander.channel_free) return 0;
+            if (!(soil ? goal.communicated_soil_data[wp] : goal.communicated_rock_data[wp])) return 0;
+            if (!regress_position(out, r, pos)) return 0;
+            if (soil) {
+                out->comm_soil &= ~bit;
+                out->no_soil |= bit;
+                out->soil[r] |= bit;
+            }
+            else {
+                out->comm_rock &= ~bit;
+                out->no_rock |= bit;
+                out->rock[r] |= bit;
+            }
+            *cost = 4;
+            return regress_energy(out, r, 4);
+        }
+        case 9: // communicate_image_data
+        {
+            int objective = params[1], mode = params[2], pos = params[3], lander = params[4];
+            unsigned int bit = 1u << (objective * num_modes + mode);
+            if (!(p->comm_image & bit)) return 0;
+            if (s->lander.lander_position != lander || !(s->waypoints[pos].visible_waypoints & (1 << lander))) return 0;
+            if (!s->rovers[r].available || !s->lander.channel_free || !goal.communicated_image_data[objective][mode]) return 0;
+            if (!regress_position(out, r, pos)) return 0;
+            out->comm_image &= ~bit;
+            out->no_image |= bit;
+            out->image[r] |= bit;
+            *cost = 6;
+            return regress_energy(out, r, 6);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Builds the key of the bucket of a partial state in the meeting index.
+ */
+void meet_key(const PartialState *p, MeetKey *key) {
+    memset(key, 0, sizeof(MeetKey));
+    key->comm_soil = p->comm_soil;
+    key->comm_rock = p->comm_rock;
+    key->comm_image = p->comm_image;
+    for (int r = 0; r < num_rovers; r++) {
+        if (p->position[r] < 0) continue;
+        key->rovers |= 1u << r;
+        key->position[r] = p->position[r];
+    }
+}
+
+/**
+ * @brief Adds a partial state to the meeting index.
+ *
+ * A forward state can only satisfy partial states whose communications it has
+ * and whose rovers stand where it has them. The index keeps the distinct shapes
+ * (communications and constrained rovers) of its partial states, so meet_find
+ * builds one key per shape from the state instead of testing every partial
+ * state. Partial states of new shapes are left out once MEET_SHAPES is reached.
+ * @return 0 on success, -1 if memory is exhausted.
+ */
+int meet_add(RegNode *node) {
+    MeetKey key, shape;
+    MeetBucket *bucket;
+    int i;
+
+    meet_key(&node->p, &key);
+    shape = key;
+    memset(shape.position, 0, sizeof(shape.position));
+    for (i = 0; i < meet_shape_count && memcmp(&meet_shapes[i], &shape, sizeof(MeetKey)) != 0; i++);
+    if (i == meet_shape_count) {
+        if (meet_shape_count == MEET_SHAPES) return 0;
+        meet_shapes[meet_shape_count++] = shape;
+    }
+
+    HASH_FIND(hh, meet_index, &key, sizeof(MeetKey), bucket);
+    if (bucket == NULL) {
+        bucket = (MeetBucket*) malloc(sizeof(MeetBucket));
+        if (bucket == NULL) return -1;
+        bucket->key = key;
+        bucket->nodes = NULL;
+        HASH_ADD(hh, meet_index, key, sizeof(MeetKey), bucket);
+    }
+    node->next_meet = bucket->nodes;
+    bucket->nodes = node;
+    return 0;
+}
+
+/**
+ * @brief Finds a partial state of the meeting index that a state satisfies.
+ * @return The partial state, or NULL if there is none.
+ */
+RegNode *meet_find(const StateKey *k) {
+    MeetKey key;
+    MeetBucket *bucket;
+
+    for (int i = 0; i < meet_shape_count; i++) {
+        const MeetKey *shape = &meet_shapes[i];
+        if ((shape->comm_soil & ~k->communicated_soil_sample) || (shape->comm_rock & ~k->communicated_rock_sample)
+            || (shape->comm_image & ~k->communicated_image)) continue;
+
+        key = *shape;
+        for (int r = 0; r < num_rovers; r++) {
+            if (shape->rovers & (1u << r)) key.position[r] = (signed char) k->rover_positions[r];
+        }
+        HASH_FIND(hh, meet_index, &key, sizeof(MeetKey), bucket);
+        if (bucket == NULL) continue;
+        for (RegNode *node = bucket->nodes; node != NULL; node = node->next_meet) {
+            if (partial_satisfied(&node->p, k)) return node;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Returns the data an action samples, photographs or communicates.
+ * @return The goal slot of the data (soil, then rock, then images, as in agenda.h), or -1.
+ */
+int action_data(int action_type, int *params) {
+    switch (action_type) {
+        case 2: return params[2];
+        case 3: return MAX_WAYPOINTS + params[2];
+        case 6: return 2 * MAX_WAYPOINTS + params[2] * MAX_MODES + params[4];
+        case 7: return params[1];
+        case 8: return MAX_WAYPOINTS + params[1];
+        case 9: return 2 * MAX_WAYPOINTS + params[1] * MAX_MODES + params[2];
+    }
+    return -1;
+}
+
+/**
+ * @brief Returns the rover of an action (its first parameter).
+ */
+int action_rover(CompactAction action) {
+    int params[5];
+    compact_action_unpack(action, params);
+    return params[0];
+}
+
+/**
+ * @brief Checks if two actions of a plan may only appear in one order (partial order reduction).
+ *
+ * Actions of different rovers commute unless they sample, photograph or
+ * communicate the same data. Of two neighbouring actions that commute, the
+ * regression only keeps the order where the later action belongs to the rover
+ * with the lower index, so it does not generate every interleaving of the
+ * rovers' plans.
+ * @param action_type The action regressed next (the earlier one in the plan).
+ * @param params Its parameters.
+ * @param later The action regressed last (the later one).
+ * @return 1 if the pair is in the pruned order, 0 otherwise.
+ */
+int regression_pruned(int action_type, int *params, CompactAction later) {
+    int later_params[5];
+    int later_type = compact_action_unpack(later, later_params);
+
+    if (params[0] >= later_params[0]) return 0;
+    int data = action_data(action_type, params);
+    return data < 0 || data != action_data(later_type, later_params);
+}
+
+/**
+ * @brief Adds the partial state before an action to the regression, unless it was reached more cheaply.
+ *
+ * A partial state reached again with the same g through an action of a lower
+ * rover is taken over by the new path and expanded again, since
+ * regression_pruned prunes fewer of its children then.
+ * @param parent The node the action leads to.
+ * @return 0 on success, -1 if the node limit is reached or memory is exhausted.
+ */
+int regression_add(RegNode *parent, int action_type, int *params) {
+    static PartialState next;
+    RegNode *node;
+    int cost;
+
+    if (parent->parent != NULL && regression_pruned(action_type, params, parent->action)) return 0;
+    if (!regress_action(&parent->p, action_type, params, &next, &cost)) return 0;
+    int g = parent->g + cost;
+    if (reg_budget >= 0 && g > reg_budget) return 0;
+    HASH_FIND(hh, reg_closed, &next, sizeof(PartialState), node);
+    if (node != NULL && (node->g < g || (node->g == g && (node->parent == NULL || action_rover(node->action) <= params[0])))) return 0;
+    int h = node != NULL ? node->h : regression_h(&next);
+    if (h == INT_MAX) return 0;
+
+    if (node == NULL) {
+        if (reg_count >= regression_nodes) {
+            reg_limit_reached = 1;
+            return -1;
+        }
+        node = (RegNode*) malloc(sizeof(RegNode));
+        if (node == NULL) return -1;
+        node->p = next;
+        node->h = h;
+        HASH_ADD(hh, reg_closed, p, sizeof(PartialState), node);
+        reg_count++;
+        if (bidirectional && meet_add(node) < 0) return -1;
+    }
+    node->g = g;
+    node->parent = parent;
+    node->action = compact_action_pack(action_type, params);
+    insert_node(reg_open, g + h, h, node);
+
+    if (reg_found == NULL && partial_satisfied(&node->p, &reg_init_key)) reg_found = node;
+    return 0;
+}
+
+/**
+ * @brief Expands a partial state: regresses every action that achieves one of its facts.
+ * @return 0 on success, -1 if the node limit is reached or memory is exhausted.
+ */
+int regression_expand(RegNode *node) {
+    PartialState *p = &node->p;
+    int lander = reg_init->lander.lander_position, err = 0;
+
+    // Communications, by any rover from any waypoint that sees the lander.
+    for (int r = 0; r < num_rovers; r++) {
+        for (int pos = 0; pos < num_waypoints; pos++) {
+            if (!(reg_init->waypoints[pos].visible_waypoints & (1 << lander)) || (p->position[r] >= 0 && p->position[r] != pos)) continue;
+            for (int wp = 0; wp < num_waypoints; wp++) {
+                int params[4] = {r, wp, pos, lander};
+                if ((p->comm_soil >> wp) & 1) err |= regression_add(node, 7, params);
+                if ((p->comm_rock >> wp) & 1) err |= regression_add(node, 8, params);
+            }
+            for (int bit = 0; bit < num_objectives * num_modes; bit++) {
+                if (!((p->comm_image >> bit) & 1)) continue;
+                int params[5] = {r, bit / num_modes, bit % num_modes, pos, lander};
+                err |= regression_add(node, 9, params);
+            }
+        }
+    }
+
+    for (int r = 0; r < num_rovers; r++) {
+        for (int st = 0; st < num_stores; st++) {
+            if (reg_init->stores[st].rover_id != r) continue;
+            for (int wp = 0; wp < num_waypoints; wp++) {
+                int params[3] = {r, st, wp};
+                if ((p->soil[r] >> wp) & 1) err |= regression_add(node, 2, params);
+                if ((p->rock[r] >> wp) & 1) err |= regression_add(node, 3, params);
+            }
+            int params[2] = {r, st};
+            if ((p->empty >> st) & 1) err |= regression_add(node, 4, params);
+        }
+
+        for (int c = 0; c < num_cameras; c++) {
+            if (reg_init->cameras[c].rover_id != r) continue;
+            for (int o = 0; o < num_objectives; o++) {
+                for (int wp = 0; wp < num_waypoints; wp++) {
+                    if (!(reg_init->objectives[o].visible_waypoints & (1 << wp)) || (p->position[r] >= 0 && p->position[r] != wp)) continue;
+                    for (int m = 0; m < num_modes; m++) {
+                        int params[5] = {r, wp, o, c, m};
+                        if ((p->image[r] >> (o * num_modes + m)) & 1) err |= regression_add(node, 6, params);
+                    }
+                    int params[4] = {r, c, o, wp};
+                    if ((p->calibrated >> c) & 1) err |= regression_add(node, 5, params);
+                }
+            }
+        }
+
+        int pos = p->position[r];
+        if (pos < 0) continue;
+        for (int from = 0; from < num_waypoints; from++) {
+            int params[3] = {r, from, pos};
+            err |= regression_add(node, 0, params);
+        }
+        // A recharge only helps a rover that looks short of energy.
+        int rover_h = regression_rover_h(p, r);
+        if (rover_h != INT_MAX && p->energy_lo[r] + rover_h > reg_init->rovers[r].energy) {
+            int params[2] = {r, pos};
+            err |= regression_add(node, 1, params);
+        }
+    }
+    return err;
+}
+
+/**
+ * @brief Adds a state after an action to the forward search, unless it was reached more cheaply.
+ * @return 0 on success, -1 if the node limit is reached or memory is exhausted.
+ */
+int forward_add(FwdNode *parent, State *next, int g, CompactAction action) {
+    StateKey key;
+    FwdNode *node;
+
+    if (reg_budget >= 0 && g > reg_budget) return 0;
+    make_state_key(next, &key);
+    HASH_FIND(hh, fwd_closed, &key, sizeof(StateKey), node);
+    if (node != NULL && node->g <= g) return 0;
+    int h = node != NULL ? node->h : heuristic_function(next);
+    if (h == INT_MAX) return 0;
+
+    if (node == NULL) {
+        if (fwd_count >= forward_nodes) return -1;
+        node = (FwdNode*) malloc(sizeof(FwdNode));
+        if (node == NULL) return -1;
+        node->key = key;
+        node->h = h;
+        HASH_ADD(hh, fwd_closed, key, sizeof(StateKey), node);
+        fwd_count++;
+    }
+    node->g = g;
+    node->parent = parent;
+    node->action = action;
+    insert_node(fwd_open, g + h, h, node);
+
+    if (fwd_met == NULL && (reg_met = meet_find(&node->key)) != NULL) fwd_met = node;
+    return 0;
+}
+
+/**
+ * @brief Expands a state of the forward search (see window_actions).
+ * @return 0 on success, -1 if the node limit is reached or memory is exhausted.
+ */
+int forward_expand(FwdNode *node) {
+    static State s, next;
+    static int actions[WINDOW_ACTIONS][6];
+    int energy_spent, err = 0;
+
+    unpack_state_key(&node->key, reg_init, &s);
+    for (int r = 0; r < num_rovers; r++) {
+        int n = window_actions(&s, &fwd_target, r, actions);
+        for (int i = 0; i < n; i++) {
+            if (!apply_action(&s, actions[i][0], &actions[i][1], &next, &energy_spent)) continue;
+            err |= forward_add(node, &next, node->g + energy_spent, compact_action_pack(actions[i][0], &actions[i][1]));
+        }
+    }
+    return err;
+}
+
+/**
+ * @brief Joins the forward path to a state and the regression path from a partial state to the goal.
+ * @param fwd The forward state (NULL: the initial state).
+ * @param reg The partial state it satisfies.
+ * @return 1 if the plan reaches the goal (it is then stored in the global solution), 0 otherwise.
+ */
+int regression_plan(FwdNode *fwd, RegNode *reg) {
+    int forward = 0, length = 0;
+    for (FwdNode *n = fwd; n != NULL && n->parent != NULL; n = n->parent) forward++;
+    for (RegNode *n = reg; n->parent != NULL; n = n->parent) length++;
+    length += forward;
+
+    CompactAction *codes = (CompactAction*) malloc((length > 0 ? length : 1) * sizeof(CompactAction));
+    if (codes == NULL) {
+        printf("Memory allocation for the plan failed!\n");
+        return 0;
+    }
+    // The forward path is stored backwards; the regression path is already in order.
+    int i = forward;
+    for (FwdNode *n = fwd; n != NULL && n->parent != NULL; n = n->parent) codes[--i] = n->action;
+    i = forward;
+    for (RegNode *n = reg; n->parent != NULL; n = n->parent) codes[i++] = n->action;
+
+    int found = solution_from_codes(reg_init, codes, length);
+    free(codes);
+    if (!found) printf("The plan of the regression search does not reach the goal.\n");
+    return found;
+}
+
+/**
+ * @brief Frees the nodes, open lists and meeting index of the search.
+ */
+void regression_free() {
+    RegNode *reg, *reg_tmp;
+    FwdNode *fwd, *fwd_tmp;
+    MeetBucket *bucket, *bucket_tmp;
+
+    HASH_ITER(hh, reg_closed, reg, reg_tmp) {
+        HASH_DEL(reg_closed, reg);
+        free(reg);
+    }
+    HASH_ITER(hh, fwd_closed, fwd, fwd_tmp) {
+        HASH_DEL(fwd_closed, fwd);
+        free(fwd);
+    }
+    HASH_ITER(hh, meet_index, bucket, bucket_tmp) {
+        HASH_DEL(meet_index, bucket);
+        free(bucket);
+    }
+    if (reg_open != NULL) freeMinHeap(reg_open);
+    if (fwd_open != NULL) freeMinHeap(fwd_open);
+    reg_open = fwd_open = NULL;
+    meet_shape_count = 0;
+}
+
+/**
+ * @brief The regression search (see the file comment).
+ * @param init The initial state.
+ * @param budget The energy budget of the plan (--max-energy), or -1.
+ * @return 1 if a plan within the budget was found (it is then stored in the global solution), 0 otherwise.
+ *         When the regression stopped at its node limit, reg_limit_reached is set: the
+ *         problem may still have a plan.
+ */
+int regression_search(State *init, int budget) {
+    int reg_expanded = 0, fwd_expanded = 0, reg_stopped = 0, fwd_stopped = !bidirectional, found = 0;
+
+    reg_init = init;
+    reg_budget = budget;
+    reg_limit_reached = 0;
+    make_state_key(init, &reg_init_key);
+    regression_costs(init);
+
+    // The goal: every communication of the problem.
+    RegNode *root = (RegNode*) malloc(sizeof(RegNode));
+    if (root == NULL) {
+        printf("Memory allocation for the regression search failed!\n");
+        return 0;
+    }
+    memset(&root->p, 0, sizeof(PartialState));
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        if (goal.communicated_soil_data[wp]) root->p.comm_soil |= 1u << wp;
+        if (goal.communicated_rock_data[wp]) root->p.comm_rock |= 1u << wp;
+    }
+    for (int o = 0; o < num_objectives; o++) {
+        for (int m = 0; m < num_modes; m++) {
+            if (goal.communicated_image_data[o][m]) root->p.comm_image |= 1u << (o * num_modes + m);
+        }
+    }
+    for (int r = 0; r < MAX_ROVERS; r++) {
+        root->p.energy_hi[r] = ENERGY_FREE;
+        root->p.position[r] = -1;
+    }
+    root->g = 0;
+    root->h = regression_h(&root->p);
+    root->parent = NULL;
+    HASH_ADD(hh, reg_closed, p, sizeof(PartialState), root);
+    reg_count = 1;
+    reg_found = partial_satisfied(&root->p, &reg_init_key) ? root : NULL;
+    fwd_met = NULL;
+    reg_met = NULL;
+    reg_open = createMinHeap(1024);
+    if (root->h != INT_MAX) insert_node(reg_open, root->h, root->h, root);
+
+    if (bidirectional) {
+        // The forward search lists the samples, images and communications of the goals (see window_actions).
+        fwd_target = *init;
+        for (int wp = 0; wp < num_waypoints; wp++) {
+            if (goal.communicated_soil_data[wp]) {
+                fwd_target.waypoints[wp].communicated_soil = 1;
+                fwd_target.waypoints[wp].has_soil_sample = 0;
+            }
+            if (goal.communicated_rock_data[wp]) {
+                fwd_target.waypoints[wp].communicated_rock = 1;
+                fwd_target.waypoints[wp].has_rock_sample = 0;
+            }
+        }
+        for (int o = 0; o < num_objectives; o++) {
+            for (int m = 0; m < num_modes; m++) {
+                if (!goal.communicated_image_data[o][m]) continue;
+                fwd_target.objectives[o].communicated_image |= 1 << m;
+                for (int r = 0; r < num_rovers; r++) fwd_target.rovers[r].have_image[o][m] = 1;
+            }
+        }
+
+        fwd_open = createMinHeap(1024);
+        if (meet_add(root) < 0) reg_stopped = 1;
+        FwdNode *start = (FwdNode*) malloc(sizeof(FwdNode));
+        if (start == NULL) fwd_stopped = 1;
+        else {
+            start->key = reg_init_key;
+            start->g = 0;
+            start->h = heuristic_function(init);
+            start->parent = NULL;
+            HASH_ADD(hh, fwd_closed, key, sizeof(StateKey), start);
+            fwd_count = 1;
+            if (start->h != INT_MAX) insert_node(fwd_open, start->h, start->h, start);
+            if ((reg_met = meet_find(&start->key)) != NULL) fwd_met = start;
+        }
+    }
+
+    while (reg_found == NULL && fwd_met == NULL) {
+        int backward = !reg_stopped && !is_empty_heap(reg_open);
+        int forward = !fwd_stopped && !is_empty_heap(fwd_open);
+        if (!backward && !forward) break;
+
+        // The side with the smaller open list goes next.
+        if (backward && (!forward || reg_open->nodeSize <= fwd_open->nodeSize)) {
+            HeapNode min = extract_min(reg_open);
+            RegNode *node = (RegNode*) min.node;
+            total_extracts++;
+            if (min.f > node->g + node->h) continue; // Reached more cheaply since.
+            reg_expanded++;
+            if (regression_expand(node) < 0) {
+                if (reg_limit_reached)
+                    printf("The regression search reached its limit of %d partial states.\n", regression_nodes);
+                else
+                    printf("Memory exhausted in the regression search.\n");
+                reg_stopped = 1;
+            }
+        }
+        else {
+            HeapNode min = extract_min(fwd_open);
+            FwdNode *node = (FwdNode*) min.node;
+            total_extracts++;
+            if (min.f > node->g + node->h) continue;
+            fwd_expanded++;
+            if (forward_expand(node) < 0) {
+                if (fwd_count >= forward_nodes)
+                    printf("The forward search reached its limit of %d states.\n", forward_nodes);
+                else
+                    printf("Memory exhausted in the forward search.\n");
+                fwd_stopped = 1;
+            }
+        }
+    }
+
+    printf("Heap stats: inserts=%d, extracts=%d\n", total_inserts, total_extracts);
+    printf("Regression: %d partial states generated, %d expanded\n", reg_count, reg_expanded);
+    if (bidirectional)
+        printf("Forward: %d states generated, %d expanded, %d index shapes\n", fwd_count, fwd_expanded, meet_shape_count);
+
+    if (reg_found != NULL)
+        found = regression_plan(NULL, reg_found);
+    else if (fwd_met != NULL)
+        found = regression_plan(fwd_met, reg_met);
+    regression_free();
+    reg_closed = NULL;
+    fwd_closed = NULL;
+    return found && (budget < 0 || total_energy <= budget);
+}
+
+#endif // REGRESSION_H
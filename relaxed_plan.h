@@ -0,0 +1,338 @@
+/**
+ * @file relaxed_plan.h
+ * @brief A relaxed plan heuristic specialised for the rover domain, with helpful actions.
+ *
+ * As in FF, the plan ignores delete effects: samples and calibrations are never
+ * used up, a store is emptied at most once, and every rover keeps all the data
+ * it collects. Instead of building a relaxed planning graph, the plan is read off
+ * the precomputed tables in two steps:
+ *  - every open goal is given to the rover that achieves it most cheaply from
+ *    its current position, which adds the sampling, calibration, imaging,
+ *    communication and drop actions, and the waypoints where they happen, to
+ *    that rover's part of the plan;
+ *  - every rover then visits its waypoints in nearest-first order, calibration
+ *    waypoints before the others, and ends at a communication point if it has
+ *    data to send. The first leg is taken from energy_dist, so it includes any
+ *    detour the rover needs for recharging.
+ * Routing each rover through its waypoints, rather than counting a separate path
+ * from its position to every one of them, is what makes moving towards the next
+ * waypoint lower the value.
+ *
+ * Every action counts its energy plus one, so that actions that cost no energy
+ * (drop) also bring the value down; navigate actions count 9.
+ *
+ * The actions of the plan that are applicable in the evaluated state are its
+ * helpful actions: the first moves towards every rover's next waypoint, and the
+ * actions of the plan at the rover's current position. With --helpful-actions,
+ * the children generated by the other actions get HELPFUL_PENALTY added to their
+ * f, so the greedy search tries all helpful children before any other one
+ * without losing completeness.
+ */
+
+#ifndef RELAXED_PLAN_H
+#define RELAXED_PLAN_H
+
+#include <string.h>
+
+#include "auxiliary.h"
+#include "heuristic.h"
+
+#define HELPFUL_PENALTY (1 << 20) // Added to f for unhelpful children; larger than any h.
+
+/**
+ * @struct HelpfulActions
+ * @brief The helpful actions of a state, per rover.
+ */
+typedef struct {
+    unsigned int nav[MAX_ROVERS];   // Bitmap of the waypoints the helpful navigate actions lead to.
+    unsigned int types[MAX_ROVERS]; // Bitmap of the other helpful action types (bit = action type).
+} HelpfulActions;
+
+/**
+ * @struct RelaxedPlan
+ * @brief A relaxed plan under construction.
+ */
+typedef struct {
+    State *state;
+    unsigned int sites[MAX_ROVERS];        // Bitmap of the sampling and imaging waypoints of each rover.
+    unsigned int calibrations[MAX_ROVERS]; // Bitmap of the calibration waypoints of each rover.
+    int communicate[MAX_ROVERS];           // Set if the rover has data to send.
+    int calibrated[MAX_CAMERAS];           // Calibrated in the state or in the plan.
+    int cost;                              // Cost of the non-navigation actions.
+    HelpfulActions *helpful;               // Filled if not NULL.
+} RelaxedPlan;
+
+int helpful_actions = 0;                     // Prefer helpful actions (--helpful-actions).
+_Thread_local HelpfulActions current_helpful; // Helpful actions of the node being expanded.
+
+/**
+ * @brief Returns the waypoint of a bitmap that is closest to `from` for a rover, or -1 if none is reachable.
+ */
+int rp_nearest(int r, int from, unsigned int waypoints) {
+    int nearest = -1;
+    for (int w = 0; w < num_waypoints; w++) {
+        if ((waypoints & (1u << w)) && dist[r][from][w] != INT_MAX && (nearest < 0 || dist[r][from][w] < dist[r][from][nearest])) {
+            nearest = w;
+        }
+    }
+    return nearest;
+}
+
+/**
+ * @brief Adds a non-navigation action of a rover, done at waypoint `at`, to the plan.
+ * @param applicable 1 if the action's other preconditions hold in the state.
+ */
+void rp_add_action(RelaxedPlan *p, int r, int action_type, int energy, int at, int applicable) {
+    p->cost += energy + 1;
+    if (p->helpful != NULL && applicable && at == p->state->rovers[r].position) p->helpful->types[r] |= 1u << action_type;
+}
+
+/**
+ * @brief Adds the communication of data held by one of the rovers in `holders` (a bitmap).
+ * @return 1 on success, 0 if none of them can reach a communication point.
+ */
+int rp_communicate(RelaxedPlan *p, unsigned int holders, unsigned int comm_wps, int action_type, int energy) {
+    int best_rover = -1, best_wp = -1;
+    for (int r = 0; r < num_rovers; r++) {
+        if (!(holders & (1u << r))) continue;
+        int pos = p->state->rovers[r].position;
+        int c = rp_nearest(r, pos, comm_wps);
+        if (c < 0 || energy_dist(p->state, r, COMM_TARGET) == INT_MAX) continue;
+        if (best_rover < 0 || dist[r][pos][c] < dist[best_rover][p->state->rovers[best_rover].position][best_wp]) {
+            best_rover = r;
+            best_wp = c;
+        }
+    }
+    if (best_rover < 0) return 0;
+
+    p->communicate[best_rover] = 1;
+    rp_add_action(p, best_rover, action_type, energy, best_wp, 1);
+    return 1;
+}
+
+/**
+ * @brief Adds the actions for an open soil (kind 0) or rock (kind 1) goal.
+ * @return 1 on success, 0 if the goal cannot be achieved any more.
+ */
+int rp_sample_goal(RelaxedPlan *p, int wp, int kind, unsigned int comm_wps) {
+    State *s = p->state;
+    unsigned int holders = 0;
+
+    for (int r = 0; r < num_rovers; r++) {
+        if (!s->rovers[r].available) continue;
+        if ((kind == 0 ? s->rovers[r].has_soil_analysis : s->rovers[r].has_rock_analysis) & (1 << wp)) holders |= 1u << r;
+    }
+    if (holders) return rp_communicate(p, holders, comm_wps, kind == 0 ? 7 : 8, 4);
+
+    if (!(kind == 0 ? s->waypoints[wp].has_soil_sample : s->waypoints[wp].has_rock_sample)) return 0;
+
+    int sample_energy = kind == 0 ? 3 : 5;
+    int best_rover = -1, best_comm = -1, best_cost = INT_MAX;
+    for (int r = 0; r < num_rovers; r++) {
+        if (!s->rovers[r].available) continue;
+        if (!(kind == 0 ? s->rovers[r].equipped_soil : s->rovers[r].equipped_rock) || rover_stores[r] == 0) continue;
+        if (energy_dist(s, r, wp) == INT_MAX) continue;
+        int c = rp_nearest(r, wp, comm_wps);
+        if (c < 0) continue;
+        int cost = dist[r][s->rovers[r].position][wp] + sample_energy + dist[r][wp][c] + 4;
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_rover = r;
+            best_comm = c;
+        }
+    }
+    if (best_rover < 0) return 0;
+
+    // A rover whose stores are all full drops one first.
+    int empty_store = 0;
+    for (int st = 0; st < num_stores; st++) {
+        if (s->stores[st].rover_id == best_rover && !s->stores[st].is_full) empty_store = 1;
+    }
+    if (!empty_store) rp_add_action(p, best_rover, 4, 0, s->rovers[best_rover].position, 1);
+
+    p->sites[best_rover] |= 1u << wp;
+    p->communicate[best_rover] = 1;
+    rp_add_action(p, best_rover, kind == 0 ? 2 : 3, sample_energy, wp, empty_store);
+    rp_add_action(p, best_rover, kind == 0 ? 7 : 8, 4, best_comm, 0);
+    return 1;
+}
+
+/**
+ * @brief Adds the actions for an open image goal.
+ * @return 1 on success, 0 if the goal cannot be achieved any more.
+ */
+int rp_image_goal(RelaxedPlan *p, int o, int m, unsigned int comm_wps) {
+    State *s = p->state;
+    unsigned int holders = 0;
+
+    for (int r = 0; r < num_rovers; r++) {
+        if (s->rovers[r].available && s->rovers[r].have_image[o][m]) holders |= 1u << r;
+    }
+    if (holders) return rp_communicate(p, holders, comm_wps, 9, 6);
+
+    int best_cam = -1, best_cal = -1, best_img = -1, best_cost = INT_MAX;
+    for (int c = 0; c < num_cameras; c++) {
+        int r = s->cameras[c].rover_id, pos = s->rovers[r].position;
+        if (!s->rovers[r].available || !s->rovers[r].equipped_imaging || !(s->cameras[c].modes_supported & (1 << m))) continue;
+
+        int img = rp_nearest(r, pos, s->objectives[o].visible_waypoints);
+        if (img < 0 || energy_dist(s, r, img) == INT_MAX || rp_nearest(r, img, comm_wps) < 0) continue;
+
+        int cal = -1, cost = 0;
+        if (!p->calibrated[c]) {
+            unsigned int cal_wps = 0;
+            for (int t = 0; t < num_objectives; t++) {
+                if (s->cameras[c].calibration_targets & (1 << t)) cal_wps |= s->objectives[t].visible_waypoints;
+            }
+            cal = rp_nearest(r, pos, cal_wps);
+            if (cal < 0) continue;
+            cost = dist[r][pos][cal] + 2;
+        }
+        cost += dist[r][pos][img] + 1 + comm_dist[r][img] + 6;
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_cam = c;
+            best_cal = cal;
+            best_img = img;
+        }
+    }
+    if (best_cam < 0) return 0;
+
+    int r = s->cameras[best_cam].rover_id;
+    if (best_cal >= 0) {
+        p->calibrations[r] |= 1u << best_cal;
+        rp_add_action(p, r, 5, 2, best_cal, 1);
+        p->calibrated[best_cam] = 1;
+    }
+    p->sites[r] |= 1u << best_img;
+    p->communicate[r] = 1;
+    rp_add_action(p, r, 6, 1, best_img, s->cameras[best_cam].calibrated);
+    rp_add_action(p, r, 9, 6, rp_nearest(r, best_img, comm_wps), 0);
+    return 1;
+}
+
+/**
+ * @brief Marks the first moves of a rover's shortest paths from its position to `to` as helpful.
+ */
+void rp_helpful_moves(RelaxedPlan *p, int r, int to) {
+    State *s = p->state;
+    int pos = s->rovers[r].position;
+    for (int u = 0; u < num_waypoints; u++) {
+        if (u != pos && s->rovers[r].can_traverse[pos][u] && (s->waypoints[pos].visible_waypoints & (1 << u)) &&
+            dist[r][u][to] != INT_MAX && dist[r][u][to] + 8 == dist[r][pos][to]) {
+            p->helpful->nav[r] |= 1u << u;
+        }
+    }
+}
+
+/**
+ * @brief Routes a rover through its waypoints of the plan (see the file comment).
+ * @return The cost of the navigate actions, or INT_MAX if the rover cannot get somewhere it has to.
+ */
+int rp_route(RelaxedPlan *p, int r, unsigned int comm_wps) {
+    State *s = p->state;
+    int pos = s->rovers[r].position, at = pos, travel = 0;
+    unsigned int calibrations = p->calibrations[r] & ~(1u << pos);
+    unsigned int sites = p->sites[r] & ~(calibrations ? 0 : 1u << pos);
+
+    while (calibrations | sites) {
+        int next = rp_nearest(r, at, calibrations ? calibrations : sites);
+        if (next < 0) return INT_MAX;
+        int leg = at == pos ? energy_dist(s, r, next) : dist[r][at][next];
+        if (leg == INT_MAX) return INT_MAX;
+        if (at == pos && p->helpful != NULL) rp_helpful_moves(p, r, next);
+
+        travel += leg;
+        at = next;
+        if (calibrations) {
+            calibrations &= ~(1u << at);
+            if (!calibrations) sites &= ~(1u << at);
+        }
+        else sites &= ~(1u << at);
+    }
+
+    if (p->communicate[r] && !(comm_wps & (1u << at))) {
+        int c = rp_nearest(r, at, comm_wps);
+        int leg = at == pos ? energy_dist(s, r, COMM_TARGET) : (c < 0 ? INT_MAX : dist[r][at][c]);
+        if (leg == INT_MAX) return INT_MAX;
+        if (at == pos && p->helpful != NULL) rp_helpful_moves(p, r, c);
+        travel += leg;
+    }
+    return travel + travel / 8;
+}
+
+/**
+ * @brief Extracts a relaxed plan for a state.
+ * @param s The state.
+ * @param helpful If not NULL, filled with the helpful actions of the state.
+ * @return The cost of the relaxed plan, or INT_MAX if some goal cannot be achieved.
+ */
+int relaxed_plan(State *s, HelpfulActions *helpful) {
+    RelaxedPlan p;
+    memset(&p, 0, sizeof(RelaxedPlan));
+    p.state = s;
+    p.helpful = helpful;
+    if (helpful != NULL) memset(helpful, 0, sizeof(HelpfulActions));
+    for (int c = 0; c < num_cameras; c++) p.calibrated[c] = s->cameras[c].calibrated;
+
+    unsigned int comm_wps = 0;
+    for (int w = 0; w < num_waypoints; w++) {
+        if (s->waypoints[w].visible_waypoints & (1 << s->lander.lander_position)) comm_wps |= 1u << w;
+    }
+
+    for (int wp = 0; wp < num_waypoints; wp++) {
+        if (goal.communicated_soil_data[wp] && !s->waypoints[wp].communicated_soil && !rp_sample_goal(&p, wp, 0, comm_wps)) return INT_MAX;
+        if (goal.communicated_rock_data[wp] && !s->waypoints[wp].communicated_rock && !rp_sample_goal(&p, wp, 1, comm_wps)) return INT_MAX;
+    }
+    for (int o = 0; o < num_objectives; o++) {
+        for (int m = 0; m < num_modes; m++) {
+            if (goal.communicated_image_data[o][m] && !(s->objectives[o].communicated_image & (1 << m)) &&
+                !rp_image_goal(&p, o, m, comm_wps)) return INT_MAX;
+        }
+    }
+
+    int h = p.cost;
+    for (int r = 0; r < num_rovers; r++) {
+        int travel = rp_route(&p, r, comm_wps);
+        if (travel == INT_MAX) return INT_MAX;
+        h += travel;
+    }
+
+    // Energy is relaxed away, so recharging is always worth trying for a rover with work to do.
+    if (helpful != NULL) {
+        for (int r = 0; r < num_rovers; r++) {
+            if (helpful->nav[r] || helpful->types[r]) helpful->types[r] |= 1u << 1;
+        }
+    }
+    return h;
+}
+
+/**
+ * @brief The relaxed plan heuristic (--heuristic rp).
+ * @param nodeState The state for which to calculate the heuristic value (not modified).
+ * @return The cost of the relaxed plan, 0 for goal states, INT_MAX for dead ends.
+ */
+int relaxed_plan_heuristic(State *nodeState) {
+    if (is_goal_state(nodeState)) return 0;
+    return relaxed_plan(nodeState, NULL);
+}
+
+/**
+ * @brief Computes the helpful actions of a node that is about to be expanded.
+ */
+void find_helpful_actions(State *s) {
+    relaxed_plan(s, &current_helpful);
+}
+
+/**
+ * @brief Checks whether an action is one of the helpful actions found by find_helpful_actions.
+ * @param action_type The integer ID of the action.
+ * @param params The integer parameters of the action (params[0] is the rover).
+ */
+int is_helpful(int action_type, int *params) {
+    int r = params[0];
+    if (action_type == 0) return (current_helpful.nav[r] >> params[2]) & 1;
+    return (current_helpful.types[r] >> action_type) & 1;
+}
+
+#endif // RELAXED_PLAN_H
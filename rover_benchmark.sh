@@ -0,0 +1,131 @@
+#!/bin/bash
+#
+# rover_benchmark.sh - Scaling benchmark of the planner on generated problems.
+#
+# Sweeps one size parameter of rover_generate, solves every generated problem
+# with the planner and records the time, the peak memory (from GNU time, or else
+# VmHWM sampled from /proc while the planner runs) and the heap inserts and
+# extracts in a CSV file.
+# If gnuplot is installed, the three measures are also charted against the size.
+#
+# Usage:
+#   ./rover_benchmark.sh <param> <from> <to> [step] [-- generator and planner options]
+#
+# <param> is a rover_generate option without the dashes (rovers, waypoints,
+# objectives, soil, rock, images, ...). The environment variables below change
+# the defaults.
+
+PLANNER=${PLANNER:-./rover_planner}
+GENERATOR=${GENERATOR:-./rover_generate}
+METHOD=${METHOD:-best}
+SEEDS=${SEEDS:-3}         # Problems per size.
+LIMIT=${LIMIT:-60}        # Seconds per run.
+OUT=${OUT:-benchmark}     # Output prefix: <OUT>.csv, <OUT>.png and the problem files.
+
+if [ $# -lt 3 ]; then
+    sed -n '4,23p' "$0" | sed 's/^# \{0,1\}//'
+    exit 1
+fi
+
+PARAM=$1
+FROM=$2
+TO=$3
+STEP=1
+shift 3
+if [ $# -gt 0 ] && [ "$1" != "--" ]; then
+    STEP=$1
+    shift
+fi
+[ "$1" == "--" ] && shift
+
+# Options after "--" that the generator knows go to it, the rest to the planner.
+GEN_OPTS=()
+PLAN_OPTS=()
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --seed|--rovers|--waypoints|--objectives|--edges|--soil|--rock|--images|--sun|--energy)
+            GEN_OPTS+=("$1" "$2")
+            shift 2 ;;
+        *)
+            PLAN_OPTS+=("$1")
+            shift ;;
+    esac
+done
+
+for tool in "$PLANNER" "$GENERATOR"; do
+    if [ ! -x "$tool" ]; then
+        echo "Error: $tool not found (see How to Compile in README.md)."
+        exit 1
+    fi
+done
+
+mkdir -p "$OUT.problems"
+echo "$PARAM,seed,status,seconds,peak_kb,inserts,extracts,steps,energy" > "$OUT.csv"
+
+for ((size = FROM; size <= TO; size += STEP)); do
+    for ((seed = 1; seed <= SEEDS; seed++)); do
+        problem="$OUT.problems/$PARAM$size-$seed.pddl"
+        if ! "$GENERATOR" "$problem" "${GEN_OPTS[@]}" --"$PARAM" "$size" --seed "$seed" > /dev/null; then
+            echo "Error: rover_generate rejected --$PARAM $size."
+            exit 1
+        fi
+
+        log="$OUT.problems/$PARAM$size-$seed.log"
+        start=$(date +%s.%N)
+        if [ -x /usr/bin/time ]; then
+            /usr/bin/time -f %M -o "$log.mem" timeout "$LIMIT" "$PLANNER" "$METHOD" "$problem" "$OUT.problems/$PARAM$size-$seed.sol" "${PLAN_OPTS[@]}" > "$log" 2>&1
+            rc=$?
+            peak=$(tail -1 "$log.mem")
+        else
+            timeout "$LIMIT" "$PLANNER" "$METHOD" "$problem" "$OUT.problems/$PARAM$size-$seed.sol" "${PLAN_OPTS[@]}" > "$log" 2>&1 &
+            pid=$!
+            peak=0
+            while kill -0 "$pid" 2> /dev/null; do
+                # The planner is the child of timeout.
+                for p in $(pgrep -P "$pid") "$pid"; do
+                    kb=$(awk '/VmHWM/ {print $2}' "/proc/$p/status" 2> /dev/null)
+                    [ -n "$kb" ] && [ "$kb" -gt "$peak" ] && peak=$kb
+                done
+                sleep 0.05
+            done
+            wait "$pid"
+            rc=$?
+            [ "$peak" -eq 0 ] && peak="" # Finished before the first sample.
+        fi
+        seconds=$(echo "$start $(date +%s.%N)" | awk '{printf "%.3f", $2 - $1}')
+
+        if grep -q "Solution found" "$log"; then status=solved
+        elif [ $rc -eq 124 ]; then status=timeout
+        else status=failed
+        fi
+        inserts=$(sed -n 's/.*inserts=\([0-9]*\).*/\1/p' "$log" | tail -1)
+        extracts=$(sed -n 's/.*extracts=\([0-9]*\).*/\1/p' "$log" | tail -1)
+        steps=$(sed -n 's/.*Solution found! (\([0-9]*\) steps).*/\1/p' "$log")
+        energy=$(sed -n 's/.*Total energy spent: \([0-9]*\).*/\1/p' "$log")
+
+        echo "$size,$seed,$status,$seconds,$peak,$inserts,$extracts,$steps,$energy" >> "$OUT.csv"
+        echo "--$PARAM $size seed $seed: $status in $seconds s, peak ${peak:-?} KB, ${extracts:-?} expansions"
+    done
+done
+
+if command -v gnuplot > /dev/null; then
+    gnuplot <<EOF
+set terminal png size 1200,400
+set output "$OUT.png"
+set datafile separator ","
+set key off
+set xlabel "$PARAM"
+set multiplot layout 1,3
+set title "time (s)"
+plot "$OUT.csv" every ::1 using 1:4 with points pt 7
+set title "peak memory (KB)"
+plot "$OUT.csv" every ::1 using 1:5 with points pt 7
+set title "expansions"
+set logscale y
+plot "$OUT.csv" every ::1 using 1:7 with points pt 7
+unset multiplot
+EOF
+    echo "Results: $OUT.csv, chart: $OUT.png"
+else
+    echo "Results: $OUT.csv (install gnuplot for a chart)"
+fi
@@ -0,0 +1,558 @@
+/**
+ * @file rover_generate.c
+ * @brief A standalone tool that generates random, solvable Rover problems.
+ *
+ * The size of the problem (rovers, waypoints, objectives, goals, sun spots and
+ * initial energy) is given on the command line, together with a seed; the same
+ * parameters and seed always produce the same file. The output uses exactly the
+ * line format read by `parse_pddl_file`.
+ *
+ * Every problem is solvable by construction: after drawing the problem, the
+ * generator builds a plan for it (the "witness") by simulating the rovers, with
+ * recharges at sun spots where needed. If a rover runs out of energy in the
+ * simulation, its initial energy is raised and the witness is built again, so
+ * the energies written can be higher than requested on energy-starved settings.
+ * The witness can be written to a file and checked with rover_verify.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "auxiliary.h"
+
+#define GEN_MAX_ENERGY 100000 // Upper bound for the energy of a rover during generation.
+#define GEN_MAX_PLAN   100000 // Maximum number of actions in the witness plan.
+
+const char *mode_names[MAX_MODES] = {"colour", "high_res", "low_res"};
+
+/**
+ * @struct GenProblem
+ * @brief The generated problem, in the generator's own (static) form.
+ */
+typedef struct {
+    int rovers, waypoints, objectives;
+    int lander;                                         // Lander waypoint.
+    int visible[MAX_WAYPOINTS][MAX_WAYPOINTS];
+    int traverse[MAX_ROVERS][MAX_WAYPOINTS][MAX_WAYPOINTS];
+    int in_sun[MAX_WAYPOINTS];
+    int soil_sample[MAX_WAYPOINTS], rock_sample[MAX_WAYPOINTS];
+    int start[MAX_ROVERS], energy[MAX_ROVERS];
+    int soil[MAX_ROVERS], rock[MAX_ROVERS], imaging[MAX_ROVERS];
+    int camera_of[MAX_ROVERS];                          // Camera of an imaging rover (-1 if none).
+    int cameras;
+    int camera_rover[MAX_CAMERAS], camera_modes[MAX_CAMERAS], camera_target[MAX_CAMERAS];
+    int objective_visible[MAX_OBJECTIVES][MAX_WAYPOINTS];
+    int goal_soil[MAX_WAYPOINTS], goal_rock[MAX_WAYPOINTS];
+    int goal_image[MAX_OBJECTIVES][MAX_MODES];
+} GenProblem;
+
+/**
+ * @struct GenOptions
+ * @brief The command line parameters of the generator.
+ */
+typedef struct {
+    unsigned long long seed;
+    int rovers, waypoints, objectives, extra_edges;
+    int soil_goals, rock_goals, image_goals, sun, energy;
+    char plan_file[MAX_LINE];
+} GenOptions;
+
+unsigned long long rng_state; // State of the random number generator (splitmix64).
+
+/**
+ * @brief Returns a random integer in [0, n). The sequence only depends on the seed.
+ */
+int rng(int n) {
+    unsigned long long z = (rng_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (int) (z % (unsigned long long) n);
+}
+
+/**
+ * @brief Displays a syntax message for incorrect command-line arguments.
+ */
+void syntax_message_generate() {
+	printf("Usage:\n\n");
+	printf("\trover_generate <problem-file> [options]\n\n");
+	printf("options:\n");
+	printf("--seed <n>          Seed of the random generator (default 1).\n");
+	printf("--rovers <n>        Number of rovers, 1..%d (default 2).\n", MAX_ROVERS);
+	printf("--waypoints <n>     Number of waypoints, 2..%d (default 10).\n", MAX_WAYPOINTS);
+	printf("--objectives <n>    Number of objectives, 1..%d (default 3).\n", MAX_OBJECTIVES);
+	printf("--edges <n>         Paths added to the random spanning tree of waypoints (default waypoints / 2).\n");
+	printf("--soil <n>          Soil data goals (default 2).\n");
+	printf("--rock <n>          Rock data goals (default 2).\n");
+	printf("--images <n>        Image data goals (default 2).\n");
+	printf("--sun <n>           Waypoints in the sun (default 2).\n");
+	printf("--energy <n>        Initial energy of every rover (default 50; raised if the problem needs it).\n");
+	printf("--plan <file>       Also write the witness plan, which rover_verify can check.\n");
+}
+
+/**
+ * @brief Reads the command line into `opt`.
+ * @return 0 on success, -1 on an unknown option or a value out of range.
+ */
+int parse_generate_options(int argc, char **argv, GenOptions *opt) {
+    opt->seed = 1;
+    opt->rovers = 2;
+    opt->waypoints = 10;
+    opt->objectives = 3;
+    opt->extra_edges = -1;
+    opt->soil_goals = 2;
+    opt->rock_goals = 2;
+    opt->image_goals = 2;
+    opt->sun = 2;
+    opt->energy = 50;
+    opt->plan_file[0] = '\0';
+
+    for (int i = 2; i < argc; i++) {
+        if (i + 1 >= argc) return -1;
+        if (strcmp(argv[i], "--seed") == 0) opt->seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--rovers") == 0) opt->rovers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--waypoints") == 0) opt->waypoints = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--objectives") == 0) opt->objectives = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--edges") == 0) opt->extra_edges = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--soil") == 0) opt->soil_goals = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rock") == 0) opt->rock_goals = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--images") == 0) opt->image_goals = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--sun") == 0) opt->sun = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--energy") == 0) opt->energy = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--plan") == 0) {
+            strncpy(opt->plan_file, argv[++i], MAX_LINE - 1);
+            opt->plan_file[MAX_LINE - 1] = '\0';
+        }
+        else return -1;
+    }
+    if (opt->extra_edges < 0) opt->extra_edges = opt->waypoints / 2;
+
+    if (opt->rovers < 1 || opt->rovers > MAX_ROVERS || opt->rovers > MAX_CAMERAS || opt->rovers > MAX_STORES) return -1;
+    if (opt->waypoints < 2 || opt->waypoints > MAX_WAYPOINTS) return -1;
+    if (opt->objectives < 1 || opt->objectives > MAX_OBJECTIVES) return -1;
+    if (opt->soil_goals < 0 || opt->soil_goals > opt->waypoints) return -1;
+    if (opt->rock_goals < 0 || opt->rock_goals > opt->waypoints) return -1;
+    if (opt->image_goals < 0 || opt->image_goals > opt->objectives * MAX_MODES) return -1;
+    if (opt->sun < 0 || opt->sun > opt->waypoints) return -1;
+    if (opt->energy < 0 || opt->energy > GEN_MAX_ENERGY) return -1;
+    // The parser keeps all object names in one table of MAX_TOKENS entries.
+    if (1 + MAX_MODES + 3 * opt->rovers + opt->waypoints + opt->objectives > MAX_TOKENS) return -1;
+    return 0;
+}
+
+/**
+ * @brief Picks `k` distinct random waypoints and sets their flags to 1.
+ */
+void pick_waypoints(int n, int k, int flags[]) {
+    for (int i = 0; i < n; i++) flags[i] = 0;
+    for (int picked = 0; picked < k; ) {
+        int wp = rng(n);
+        if (!flags[wp]) {
+            flags[wp] = 1;
+            picked++;
+        }
+    }
+}
+
+/**
+ * @brief Draws a random problem with the requested parameters.
+ *
+ * The waypoints form a random spanning tree, which every rover can traverse in
+ * both directions, plus some extra paths that each rover may or may not use, so
+ * every waypoint can be reached by every rover. Equipment is random, but every
+ * kind of goal has at least one rover that can achieve it.
+ */
+void generate_problem(const GenOptions *opt, GenProblem *p) {
+    memset(p, 0, sizeof(GenProblem));
+    p->rovers = opt->rovers;
+    p->waypoints = opt->waypoints;
+    p->objectives = opt->objectives;
+
+    // Waypoint graph.
+    for (int i = 1; i < p->waypoints; i++) {
+        int j = rng(i);
+        p->visible[i][j] = p->visible[j][i] = 1;
+        for (int r = 0; r < p->rovers; r++) p->traverse[r][i][j] = p->traverse[r][j][i] = 1;
+    }
+    for (int e = 0; e < opt->extra_edges; e++) {
+        int i = rng(p->waypoints), j = rng(p->waypoints);
+        if (i == j) continue;
+        p->visible[i][j] = p->visible[j][i] = 1;
+        for (int r = 0; r < p->rovers; r++) {
+            if (rng(2)) p->traverse[r][i][j] = p->traverse[r][j][i] = 1;
+        }
+    }
+    p->lander = rng(p->waypoints);
+    pick_waypoints(p->waypoints, opt->sun, p->in_sun);
+
+    // Rovers and their equipment.
+    for (int r = 0; r < p->rovers; r++) {
+        p->start[r] = rng(p->waypoints);
+        p->energy[r] = opt->energy;
+        p->soil[r] = rng(2);
+        p->rock[r] = rng(2);
+        p->imaging[r] = rng(2);
+    }
+    if (opt->soil_goals > 0) p->soil[rng(p->rovers)] = 1;
+    if (opt->rock_goals > 0) p->rock[rng(p->rovers)] = 1;
+    if (opt->image_goals > 0) p->imaging[rng(p->rovers)] = 1;
+
+    // One camera per imaging rover.
+    for (int r = 0; r < p->rovers; r++) {
+        p->camera_of[r] = -1;
+        if (!p->imaging[r]) continue;
+        int c = p->cameras++;
+        p->camera_of[r] = c;
+        p->camera_rover[c] = r;
+        p->camera_modes[c] = 1 + rng((1 << MAX_MODES) - 1);
+        p->camera_target[c] = rng(p->objectives);
+    }
+
+    // Every objective is visible from one to three waypoints.
+    for (int o = 0; o < p->objectives; o++) {
+        int views = 1 + rng(3);
+        for (int v = 0; v < views; v++) p->objective_visible[o][rng(p->waypoints)] = 1;
+    }
+
+    // Goals, with a sample at every soil and rock goal waypoint.
+    pick_waypoints(p->waypoints, opt->soil_goals, p->goal_soil);
+    pick_waypoints(p->waypoints, opt->rock_goals, p->goal_rock);
+    for (int wp = 0; wp < p->waypoints; wp++) {
+        p->soil_sample[wp] = p->goal_soil[wp] || !rng(4);
+        p->rock_sample[wp] = p->goal_rock[wp] || !rng(4);
+    }
+    int supported = 0;
+    for (int c = 0; c < p->cameras; c++) supported |= p->camera_modes[c];
+    int possible = 0;
+    for (int m = 0; m < MAX_MODES; m++) if (supported & (1 << m)) possible += p->objectives;
+    for (int placed = 0; placed < opt->image_goals && placed < possible; ) {
+        int o = rng(p->objectives), m = rng(MAX_MODES);
+        if (!(supported & (1 << m)) || p->goal_image[o][m]) continue;
+        p->goal_image[o][m] = 1;
+        placed++;
+    }
+}
+
+/**
+ * @struct Witness
+ * @brief The rovers' simulated situation and the plan built so far.
+ */
+typedef struct {
+    int position[MAX_ROVERS], energy[MAX_ROVERS], store_full[MAX_ROVERS], calibrated[MAX_ROVERS];
+    char (*plan)[MAX_LINE];
+    int plan_len;
+} Witness;
+
+/**
+ * @brief Appends an action to the witness plan.
+ */
+void witness_add(Witness *w, const char *action) {
+    if (w->plan_len < GEN_MAX_PLAN) {
+        snprintf(w->plan[w->plan_len], MAX_LINE, "%s", action);
+    }
+    w->plan_len++;
+}
+
+/**
+ * @brief Moves a rover to any waypoint of `targets`, arriving with at least `need` energy.
+ *
+ * Breadth-first search over (waypoint, energy) pairs, where a move costs 8 energy
+ * and a recharge (+20, only below 8 energy and in the sun) is also a step. The
+ * moves and recharges found are appended to the plan.
+ * @return 1 on success, 0 if the rover cannot get there (it is then left unchanged).
+ */
+int witness_travel(const GenProblem *p, Witness *w, int r, const int targets[], int need) {
+    int limit = w->energy[r] > 27 ? w->energy[r] : 27;
+    int levels = limit + 1;
+    int states = p->waypoints * levels;
+    int *from = (int*) malloc((size_t) states * sizeof(int));
+    int *queue = (int*) malloc((size_t) states * sizeof(int));
+    if (from == NULL || queue == NULL) {
+        printf("Memory exhausted while building the witness plan.\n");
+        exit(1);
+    }
+    for (int s = 0; s < states; s++) from[s] = -2;
+
+    int head = 0, tail = 0, found = -1;
+    int start = w->position[r] * levels + w->energy[r];
+    from[start] = -1;
+    queue[tail++] = start;
+    while (head < tail && found < 0) {
+        int s = queue[head++];
+        int wp = s / levels, e = s % levels;
+        if (targets[wp] && e >= need) {
+            found = s;
+            break;
+        }
+        if (p->in_sun[wp] && e < 8) {
+            int t = wp * levels + (e + 20 < limit ? e + 20 : limit);
+            if (from[t] == -2) {
+                from[t] = s;
+                queue[tail++] = t;
+            }
+        }
+        if (e < 8) continue;
+        for (int to = 0; to < p->waypoints; to++) {
+            if (!p->visible[wp][to] || !p->traverse[r][wp][to]) continue;
+            int t = to * levels + e - 8;
+            if (from[t] == -2) {
+                from[t] = s;
+                queue[tail++] = t;
+            }
+        }
+    }
+
+    if (found >= 0) {
+        // Unwind the path, then replay it forwards.
+        int length = 0;
+        for (int s = found; s != start; s = from[s]) queue[length++] = s;
+        int prev = start;
+        char action[MAX_LINE];
+        for (int i = length - 1; i >= 0; i--) {
+            int s = queue[i];
+            int wp = prev / levels, to = s / levels;
+            if (wp == to) snprintf(action, sizeof(action), "( recharge rover%d waypoint%d )", r, wp);
+            else snprintf(action, sizeof(action), "( navigate rover%d waypoint%d waypoint%d )", r, wp, to);
+            witness_add(w, action);
+            prev = s;
+        }
+        w->position[r] = found / levels;
+        w->energy[r] = found % levels;
+    }
+
+    free(from);
+    free(queue);
+    return found >= 0;
+}
+
+/**
+ * @brief Moves a rover to a waypoint and pays for an action there.
+ * @return 1 on success, 0 if the rover cannot reach the waypoint with enough energy.
+ */
+int witness_go(const GenProblem *p, Witness *w, int r, int wp, int cost) {
+    int targets[MAX_WAYPOINTS] = {0};
+    targets[wp] = 1;
+    if (!witness_travel(p, w, r, targets, cost)) return 0;
+    w->energy[r] -= cost;
+    return 1;
+}
+
+/**
+ * @brief Moves a rover next to the lander and appends the communication action.
+ * @param what The communicated data, as it appears in the action (e.g. "communicate_soil_data rover0 waypoint3").
+ */
+int witness_communicate(const GenProblem *p, Witness *w, int r, const char *what, int cost) {
+    int targets[MAX_WAYPOINTS];
+    for (int wp = 0; wp < p->waypoints; wp++) targets[wp] = p->visible[wp][p->lander];
+    if (!witness_travel(p, w, r, targets, cost)) return 0;
+    w->energy[r] -= cost;
+
+    char action[MAX_LINE];
+    snprintf(action, sizeof(action), "( %s waypoint%d waypoint%d )", what, w->position[r], p->lander);
+    witness_add(w, action);
+    return 1;
+}
+
+/**
+ * @brief Builds a plan for the problem with the current initial energies.
+ *
+ * Goals are handled one after the other, each by a random rover that is able to
+ * achieve it.
+ * @return -1 on success, or the rover that ran out of energy.
+ */
+int build_witness(const GenProblem *p, Witness *w) {
+    char action[MAX_LINE], what[MAX_LINE];
+    unsigned long long saved_rng = rng_state;
+
+    w->plan_len = 0;
+    for (int r = 0; r < p->rovers; r++) {
+        w->position[r] = p->start[r];
+        w->energy[r] = p->energy[r];
+        w->store_full[r] = 0;
+        w->calibrated[r] = 0;
+    }
+
+    for (int kind = 0; kind < 2; kind++) {
+        for (int wp = 0; wp < p->waypoints; wp++) {
+            if (!(kind == 0 ? p->goal_soil[wp] : p->goal_rock[wp])) continue;
+            int r;
+            do r = rng(p->rovers); while (!(kind == 0 ? p->soil[r] : p->rock[r]));
+
+            if (w->store_full[r]) {
+                snprintf(action, sizeof(action), "( drop rover%d rover%dstore )", r, r);
+                witness_add(w, action);
+                w->store_full[r] = 0;
+            }
+            if (!witness_go(p, w, r, wp, kind == 0 ? 3 : 5)) return r;
+            snprintf(action, sizeof(action), "( %s rover%d rover%dstore waypoint%d )", kind == 0 ? "sample_soil" : "sample_rock", r, r, wp);
+            witness_add(w, action);
+            w->store_full[r] = 1;
+
+            snprintf(what, sizeof(what), "%s rover%d waypoint%d", kind == 0 ? "communicate_soil_data" : "communicate_rock_data", r, wp);
+            if (!witness_communicate(p, w, r, what, 4)) return r;
+        }
+    }
+
+    for (int o = 0; o < p->objectives; o++) {
+        for (int m = 0; m < MAX_MODES; m++) {
+            if (!p->goal_image[o][m]) continue;
+            int r;
+            do r = rng(p->rovers); while (p->camera_of[r] < 0 || !(p->camera_modes[p->camera_of[r]] & (1 << m)));
+            int c = p->camera_of[r];
+
+            // Calibrate where the camera's target is visible, then shoot where the objective is.
+            int targets[MAX_WAYPOINTS];
+            for (int wp = 0; wp < p->waypoints; wp++) targets[wp] = p->objective_visible[p->camera_target[c]][wp];
+            if (!witness_travel(p, w, r, targets, 2)) return r;
+            w->energy[r] -= 2;
+            snprintf(action, sizeof(action), "( calibrate rover%d camera%d objective%d waypoint%d )", r, c, p->camera_target[c], w->position[r]);
+            witness_add(w, action);
+
+            for (int wp = 0; wp < p->waypoints; wp++) targets[wp] = p->objective_visible[o][wp];
+            if (!witness_travel(p, w, r, targets, 1)) return r;
+            w->energy[r] -= 1;
+            snprintf(action, sizeof(action), "( take_image rover%d waypoint%d objective%d camera%d %s )", r, w->position[r], o, c, mode_names[m]);
+            witness_add(w, action);
+
+            snprintf(what, sizeof(what), "communicate_image_data rover%d objective%d %s", r, o, mode_names[m]);
+            if (!witness_communicate(p, w, r, what, 6)) return r;
+        }
+    }
+
+    rng_state = saved_rng; // Rebuilding the witness must make the same choices again.
+    return -1;
+}
+
+/**
+ * @brief Writes the problem in the format read by parse_pddl_file.
+ * @return 0 on success, -1 if the file cannot be written.
+ */
+int write_problem(const char *filename, const GenProblem *p, unsigned long long seed) {
+    FILE *f = fopen(filename, "w");
+    if (f == NULL) {
+        printf("Error: Could not open problem file: %s\n", filename);
+        return -1;
+    }
+
+    fprintf(f, "(define (problem rovergen%llu) (:domain rover)\n(:objects\n", seed);
+    fprintf(f, "\tgeneral - lander\n\tcolour high_res low_res - mode\n\t");
+    for (int r = 0; r < p->rovers; r++) fprintf(f, "rover%d ", r);
+    fprintf(f, "- rover\n\t");
+    for (int r = 0; r < p->rovers; r++) fprintf(f, "rover%dstore ", r);
+    fprintf(f, "- store\n\t");
+    for (int wp = 0; wp < p->waypoints; wp++) fprintf(f, "waypoint%d ", wp);
+    fprintf(f, "- waypoint\n");
+    if (p->cameras > 0) {
+        fprintf(f, "\t");
+        for (int c = 0; c < p->cameras; c++) fprintf(f, "camera%d ", c);
+        fprintf(f, "- camera\n");
+    }
+    fprintf(f, "\t");
+    for (int o = 0; o < p->objectives; o++) fprintf(f, "objective%d ", o);
+    fprintf(f, "- objective\n\t)\n(:init\n");
+
+    for (int i = 0; i < p->waypoints; i++) {
+        for (int j = 0; j < p->waypoints; j++) {
+            if (p->visible[i][j]) fprintf(f, "\t(visible waypoint%d waypoint%d)\n", i, j);
+        }
+    }
+    for (int wp = 0; wp < p->waypoints; wp++) if (p->soil_sample[wp]) fprintf(f, "\t(at_soil_sample waypoint%d)\n", wp);
+    for (int wp = 0; wp < p->waypoints; wp++) if (p->rock_sample[wp]) fprintf(f, "\t(at_rock_sample waypoint%d)\n", wp);
+    for (int wp = 0; wp < p->waypoints; wp++) if (p->in_sun[wp]) fprintf(f, "\t(in_sun waypoint%d)\n", wp);
+    fprintf(f, "\t(at_lander general waypoint%d)\n\t(channel_free general)\n\t(= (recharges) 0)\n", p->lander);
+
+    for (int r = 0; r < p->rovers; r++) {
+        fprintf(f, "\t(= (energy rover%d) %d)\n\t(in rover%d waypoint%d)\n\t(available rover%d)\n", r, p->energy[r], r, p->start[r], r);
+        fprintf(f, "\t(store_of rover%dstore rover%d)\n\t(empty rover%dstore)\n", r, r, r);
+        if (p->soil[r]) fprintf(f, "\t(equipped_for_soil_analysis rover%d)\n", r);
+        if (p->rock[r]) fprintf(f, "\t(equipped_for_rock_analysis rover%d)\n", r);
+        if (p->imaging[r]) fprintf(f, "\t(equipped_for_imaging rover%d)\n", r);
+        for (int i = 0; i < p->waypoints; i++) {
+            for (int j = 0; j < p->waypoints; j++) {
+                if (p->traverse[r][i][j]) fprintf(f, "\t(can_traverse rover%d waypoint%d waypoint%d)\n", r, i, j);
+            }
+        }
+    }
+
+    for (int c = 0; c < p->cameras; c++) {
+        fprintf(f, "\t(on_board camera%d rover%d)\n\t(calibration_target camera%d objective%d)\n", c, p->camera_rover[c], c, p->camera_target[c]);
+        for (int m = 0; m < MAX_MODES; m++) {
+            if (p->camera_modes[c] & (1 << m)) fprintf(f, "\t(supports camera%d %s)\n", c, mode_names[m]);
+        }
+    }
+    for (int o = 0; o < p->objectives; o++) {
+        for (int wp = 0; wp < p->waypoints; wp++) {
+            if (p->objective_visible[o][wp]) fprintf(f, "\t(visible_from objective%d waypoint%d)\n", o, wp);
+        }
+    }
+
+    fprintf(f, ")\n(:goal (and\n");
+    for (int wp = 0; wp < p->waypoints; wp++) if (p->goal_soil[wp]) fprintf(f, "(communicated_soil_data waypoint%d)\n", wp);
+    for (int wp = 0; wp < p->waypoints; wp++) if (p->goal_rock[wp]) fprintf(f, "(communicated_rock_data waypoint%d)\n", wp);
+    for (int o = 0; o < p->objectives; o++) {
+        for (int m = 0; m < MAX_MODES; m++) {
+            if (p->goal_image[o][m]) fprintf(f, "(communicated_image_data objective%d %s)\n", o, mode_names[m]);
+        }
+    }
+    fprintf(f, "\t)\n)\n)\n");
+
+    fclose(f);
+    return 0;
+}
+
+/**
+ * @brief Writes the witness plan in the solution format read by rover_verify.
+ * @return 0 on success, -1 if the file cannot be written.
+ */
+int write_witness(const char *filename, const Witness *w) {
+    FILE *f = fopen(filename, "w");
+    if (f == NULL) {
+        printf("Error: Could not open plan file: %s\n", filename);
+        return -1;
+    }
+    fprintf(f, "Solution length: %d\n", w->plan_len);
+    for (int i = 0; i < w->plan_len; i++) fprintf(f, "%s\n", w->plan[i]);
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    GenOptions opt;
+    GenProblem problem;
+    Witness witness;
+
+    if (argc < 2 || parse_generate_options(argc, argv, &opt) < 0) {
+        syntax_message_generate();
+        return -1;
+    }
+
+    rng_state = opt.seed;
+    generate_problem(&opt, &problem);
+
+    witness.plan = malloc((size_t) GEN_MAX_PLAN * sizeof(*witness.plan));
+    if (witness.plan == NULL) {
+        printf("Memory exhausted while building the witness plan.\n");
+        return -1;
+    }
+
+    // Raise the energy of rovers that get stuck until the witness plan goes through.
+    int stuck;
+    while ((stuck = build_witness(&problem, &witness)) >= 0) {
+        if (problem.energy[stuck] + 8 > GEN_MAX_ENERGY) {
+            printf("Cannot make the problem solvable (rover%d).\n", stuck);
+            return -1;
+        }
+        problem.energy[stuck] += 8;
+    }
+    if (witness.plan_len > GEN_MAX_PLAN) {
+        printf("The witness plan is longer than %d actions.\n", GEN_MAX_PLAN);
+        return -1;
+    }
+
+    if (write_problem(argv[1], &problem, opt.seed) < 0) return -1;
+    if (opt.plan_file[0] != '\0' && write_witness(opt.plan_file, &witness) < 0) return -1;
+
+    printf("Problem written to %s (witness plan: %d actions).\n", argv[1], witness.plan_len);
+    return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file rover_stress.c
+ * @brief A standalone stress test of the lock-free closed set (concurrent_set.h).
+ *
+ * Several threads insert overlapping ranges of keys into one ConcurrentSet at the
+ * same time, each in its own order and with its own g-values, so that claims of
+ * the same empty slot and updates of the same best g race all the time. When the
+ * threads are done, the set must hold every distinct key exactly once (no insert
+ * lost, none duplicated), and every key must carry the lowest g any thread
+ * offered for it. Every round starts from a new set; the first failure is
+ * reported and the program returns 1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "concurrent_set.h"
+
+/**
+ * @struct StressOptions
+ * @brief The command line parameters of the stress test.
+ */
+typedef struct {
+    int threads;    // Inserting threads.
+    int keys;       // Keys per thread.
+    int overlap;    // Percentage of a thread's keys that the next thread inserts too.
+    int rounds;     // Independent runs over a new set.
+} StressOptions;
+
+/**
+ * @struct StressThread
+ * @brief The work of one thread.
+ */
+typedef struct {
+    int id;
+    int first;                // First key of the thread's range.
+    ConcurrentSet *set;
+    pthread_barrier_t *start; // Released when all threads are ready.
+    const StressOptions *opt;
+    int full;                 // Set if an insert found the set full.
+} StressThread;
+
+/**
+ * @brief Displays a syntax message for incorrect command-line arguments.
+ */
+void syntax_message_stress() {
+	printf("Usage:\n\n");
+	printf("\trover_stress [options]\n\n");
+	printf("options:\n");
+	printf("--threads <n>   Inserting threads, 2..%d (default 4).\n", CSET_MAX_THREADS);
+	printf("--keys <n>      Keys per thread (default 200000).\n");
+	printf("--overlap <p>   Percentage of a thread's keys the next thread inserts too, 0..100 (default 50).\n");
+	printf("--rounds <n>    Runs, each over a new set (default 5).\n");
+}
+
+/**
+ * @brief Builds a distinct StateKey for every index.
+ *
+ * The index is spread over several fields, so that keys differ in more than one
+ * word and collide in the hash bits as they would in a search.
+ */
+void stress_key(int i, StateKey *key) {
+    memset(key, 0, sizeof(StateKey));
+    key->has_soil_sample = (unsigned int) i;
+    key->communicated_image = (unsigned int) i * 2654435761u;
+    key->energy_levels[0] = (unsigned short) (i & 0xFFFF);
+    key->rover_positions[0] = (unsigned char) (i >> 16);
+}
+
+/**
+ * @brief The g-value a thread offers for a key. Every pass of a thread lowers it.
+ */
+int stress_g(int key, int thread, int pass) {
+    return 1000 + (int) (((unsigned int) key * 2654435761u + (unsigned int) thread * 40503u) % 1000) - 100 * pass;
+}
+
+/**
+ * @brief Body of a thread: inserts its range twice, forwards then backwards.
+ *
+ * The second pass offers lower g-values for the same keys, so it races the best-g
+ * update of every key against the threads whose ranges overlap.
+ */
+void *stress_main(void *arg) {
+    StressThread *t = (StressThread*) arg;
+    StateKey key;
+
+    pthread_barrier_wait(t->start);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int n = 0; n < t->opt->keys; n++) {
+            int i = t->first + (pass == 0 ? n : t->opt->keys - 1 - n);
+            stress_key(i, &key);
+            if (cset_insert(t->set, &key, state_key_hash(&key), stress_g(i, t->id, pass), t->id) == CSET_FULL)
+                t->full = 1;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs one round and checks the set.
+ * @return 0 if the set is correct, -1 otherwise.
+ */
+int stress_round(const StressOptions *opt, int round) {
+    int stride = opt->keys - opt->keys * opt->overlap / 100;
+    int distinct = stride * (opt->threads - 1) + opt->keys;
+    pthread_t threads[CSET_MAX_THREADS];
+    StressThread work[CSET_MAX_THREADS];
+    pthread_barrier_t start;
+    StateKey key;
+    int errors = 0;
+
+    ConcurrentSet *set = cset_create(2ULL * distinct);
+    if (set == NULL) {
+        printf("Memory allocation for the set failed!\n");
+        return -1;
+    }
+    pthread_barrier_init(&start, NULL, opt->threads);
+    for (int t = 0; t < opt->threads; t++) {
+        work[t] = (StressThread) {t, t * stride, set, &start, opt, 0};
+        pthread_create(&threads[t], NULL, stress_main, &work[t]);
+    }
+    for (int t = 0; t < opt->threads; t++) {
+        pthread_join(threads[t], NULL);
+        if (work[t].full) {
+            printf("Round %d: thread %d found the set full.\n", round, t);
+            errors++;
+        }
+    }
+    pthread_barrier_destroy(&start);
+
+    long long count = atomic_load(&set->count), inserts = 0;
+    for (int t = 0; t < opt->threads; t++) inserts += set->stats[t].inserts;
+    if (count != distinct || inserts != distinct) {
+        printf("Round %d: %lld keys stored and %lld inserts reported, expected %d distinct keys.\n",
+               round, count, inserts, distinct);
+        errors++;
+    }
+
+    // Every key must be present with the lowest g of the threads whose range holds it.
+    for (int i = 0; i < distinct && errors < 10; i++) {
+        int best_g, expected = -1;
+        for (int t = 0; t < opt->threads; t++) {
+            if (i < work[t].first || i >= work[t].first + opt->keys) continue;
+            int g = stress_g(i, t, 1);
+            if (expected < 0 || g < expected) expected = g;
+        }
+        stress_key(i, &key);
+        if (!cset_contains(set, &key, state_key_hash(&key), &best_g)) {
+            printf("Round %d: key %d was lost.\n", round, i);
+            errors++;
+        }
+        else if (best_g != expected) {
+            printf("Round %d: key %d has g %d, expected %d.\n", round, i, best_g, expected);
+            errors++;
+        }
+    }
+
+    long long cas_failures = 0;
+    for (int t = 0; t < opt->threads; t++) cas_failures += set->stats[t].cas_failures;
+    printf("Round %d: %d threads, %d distinct keys, %lld lost races: %s\n",
+           round, opt->threads, distinct, cas_failures, errors ? "FAILED" : "ok");
+    cset_free(set);
+    return errors ? -1 : 0;
+}
+
+/**
+ * @brief Reads the command line into `opt`.
+ * @return 0 on success, -1 on an unknown option or a value out of range.
+ */
+int parse_stress_options(int argc, char **argv, StressOptions *opt) {
+    *opt = (StressOptions) {4, 200000, 50, 5};
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) return -1;
+        if (strcmp(argv[i], "--threads") == 0) opt->threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--keys") == 0) opt->keys = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--overlap") == 0) opt->overlap = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rounds") == 0) opt->rounds = atoi(argv[++i]);
+        else return -1;
+    }
+    if (opt->threads < 2 || opt->threads > CSET_MAX_THREADS || opt->keys < 1 || opt->keys > 1 << 22
+        || opt->overlap < 0 || opt->overlap > 100 || opt->rounds < 1)
+        return -1;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    StressOptions opt;
+
+    if (parse_stress_options(argc, argv, &opt) < 0) {
+        syntax_message_stress();
+        return -1;
+    }
+    for (int round = 1; round <= opt.rounds; round++) {
+        if (stress_round(&opt, round) < 0) return 1;
+    }
+    printf("All %d rounds passed.\n", opt.rounds);
+    return 0;
+}
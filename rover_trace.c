@@ -0,0 +1,341 @@
+/**
+ * @file rover_trace.c
+ * @brief A standalone tool that reads the search traces written with --trace.
+ *
+ * The trace (see trace.h) can be converted to CSV, one line per record, or
+ * summarised: node counts by outcome and by action type, expansions by depth and
+ * by h, the branching factor and the plateaus of the best h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "auxiliary.h"
+#include "trace.h"
+
+/**
+ * @struct TraceNode
+ * @brief What the reader keeps of every numbered node.
+ */
+typedef struct {
+    int parent;
+    int depth;
+    int g, h, f;  // h and f are -1 for nodes that were not added to the frontier.
+} TraceNode;
+
+/**
+ * @struct TraceReader
+ * @brief Buffered input over a trace file, with the nodes read so far.
+ */
+typedef struct {
+    FILE *fp;
+    unsigned char buf[TRACE_BUFFER];
+    int len, pos;
+    TraceNode *nodes;
+    int count, capacity;
+    int expanding;   // The node of the last expansion record (-1 before the first one).
+} TraceReader;
+
+/**
+ * @brief Displays a syntax message for incorrect command-line arguments.
+ */
+void syntax_message_trace() {
+	printf("Usage:\n\n");
+	printf("\trover_trace <trace-file> csv [<csv-file>]\n");
+	printf("\trover_trace <trace-file> summary\n\n");
+	printf("csv      writes one line per record (to the standard output if no file is given).\n");
+	printf("summary  prints node counts by outcome, action type, depth and h.\n");
+}
+
+/**
+ * @brief Reads the next byte of the trace.
+ * @return The byte, or -1 at the end of the file.
+ */
+int trace_byte(TraceReader *r) {
+    if (r->pos == r->len) {
+        r->len = (int) fread(r->buf, 1, sizeof(r->buf), r->fp);
+        r->pos = 0;
+        if (r->len == 0) return -1;
+    }
+    return r->buf[r->pos++];
+}
+
+/**
+ * @brief Reads a varint of the trace.
+ * @return 0 on success, -1 if the file ends inside the value.
+ */
+int trace_varint(TraceReader *r, unsigned long long *value) {
+    unsigned char bytes[10];
+    for (int n = 0; n < 10; n++) {
+        int b = trace_byte(r);
+        if (b < 0) return -1;
+        bytes[n] = (unsigned char) b;
+        if (!(b & 0x80)) {
+            get_varint(bytes, n + 1, value);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Gives the next number to a node read from the trace.
+ * @return The node's number, or -1 if memory is exhausted.
+ */
+int trace_add_node(TraceReader *r, int parent, int g, int h, int f) {
+    if (r->count == r->capacity) {
+        int capacity = r->capacity ? 2 * r->capacity : 1 << 16;
+        TraceNode *grown = (TraceNode*) realloc(r->nodes, capacity * sizeof(TraceNode));
+        if (grown == NULL) {
+            printf("Memory exhausted after %d trace nodes.\n", r->count);
+            return -1;
+        }
+        r->nodes = grown;
+        r->capacity = capacity;
+    }
+    TraceNode *n = &r->nodes[r->count];
+    n->parent = parent;
+    n->depth = parent >= 0 ? r->nodes[parent].depth + 1 : 0;
+    n->g = g;
+    n->h = h;
+    n->f = f;
+    return r->count++;
+}
+
+/**
+ * @struct TraceEvent
+ * @brief One decoded record.
+ */
+typedef struct {
+    int tag;
+    int node;             // The node the record is about.
+    CompactAction code;   // Generation records only.
+} TraceEvent;
+
+/**
+ * @brief Reads and decodes the next record.
+ * @return 1 if a record was read, 0 at the end of the trace, -1 on a malformed trace.
+ */
+int trace_next(TraceReader *r, TraceEvent *ev) {
+    unsigned long long v[4];
+    int tag = trace_byte(r);
+    if (tag < 0) return 0;
+
+    ev->tag = tag;
+    ev->code = 0;
+    switch (tag) {
+        case TRACE_ROOT:
+            if (trace_varint(r, &v[0]) < 0 || trace_varint(r, &v[1]) < 0) return -1;
+            ev->node = trace_add_node(r, -1, 0, (int) v[0], (int) v[1]);
+            break;
+        case TRACE_EXPAND:
+        case TRACE_SOLUTION:
+            if (trace_varint(r, &v[0]) < 0 || v[0] >= (unsigned long long) r->count) return -1;
+            ev->node = (int) v[0];
+            if (tag == TRACE_EXPAND) r->expanding = ev->node;
+            break;
+        case TRACE_GENERATED:
+        case TRACE_DUPLICATE:
+        case TRACE_DEAD_END: {
+            int values = tag == TRACE_GENERATED ? 4 : 2;
+            for (int i = 0; i < values; i++) {
+                if (trace_varint(r, &v[i]) < 0) return -1;
+            }
+            if (tag != TRACE_GENERATED) v[2] = v[3] = (unsigned long long) -1;
+            ev->code = (CompactAction) v[0];
+            ev->node = trace_add_node(r, r->expanding, (int) v[1], (int) v[2], (int) v[3]);
+            break;
+        }
+        default:
+            return -1;
+    }
+    return ev->node < 0 ? -1 : 1;
+}
+
+/**
+ * @brief Opens a trace file and checks its header.
+ * @return 0 on success, -1 on failure.
+ */
+int open_trace(const char *filename, TraceReader *r) {
+    char magic[8];
+    unsigned long long version;
+
+    memset(r, 0, sizeof(TraceReader));
+    r->expanding = -1;
+    r->fp = fopen(filename, "rb");
+    if (r->fp == NULL) {
+        printf("Error: Could not open trace file: %s\n", filename);
+        return -1;
+    }
+    if (fread(magic, 1, 8, r->fp) != 8 || memcmp(magic, TRACE_MAGIC, 8) != 0) {
+        printf("Error: %s is not a trace file.\n", filename);
+        return -1;
+    }
+    if (trace_varint(r, &version) < 0 || version != TRACE_VERSION) {
+        printf("Error: Unsupported trace version in %s.\n", filename);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes every record of the trace as a line of CSV.
+ * @return 0 on success, -1 on a malformed trace.
+ */
+int trace_to_csv(TraceReader *r, FILE *out) {
+    const char *events[] = {"", "root", "expand", "generated", "duplicate", "dead_end", "solution"};
+    TraceEvent ev;
+    int status, params[5];
+
+    fprintf(out, "event,node,parent,depth,action,params,g,h,f\n");
+    while ((status = trace_next(r, &ev)) == 1) {
+        TraceNode *n = &r->nodes[ev.node];
+        fprintf(out, "%s,%d,", events[ev.tag], ev.node);
+        if (n->parent >= 0) fprintf(out, "%d", n->parent);
+        fprintf(out, ",%d,", n->depth);
+
+        if (ev.tag == TRACE_GENERATED || ev.tag == TRACE_DUPLICATE || ev.tag == TRACE_DEAD_END) {
+            int action_type = compact_action_unpack(ev.code, params);
+            fprintf(out, "%s,", action_name(action_type));
+            for (int i = 0; i < action_param_count(action_type); i++) fprintf(out, "%s%d", i ? " " : "", params[i]);
+        }
+        else fprintf(out, ",");
+
+        fprintf(out, ",%d,", n->g);
+        if (n->h >= 0) fprintf(out, "%d,%d\n", n->h, n->f);
+        else fprintf(out, ",\n");
+    }
+    return status;
+}
+
+/**
+ * @brief Adds 1 to entry `i` of a growable counter array.
+ * @return 0 on success, -1 if memory is exhausted.
+ */
+int count_at(long long **counts, int *size, int i) {
+    if (i < 0) return 0;
+    if (i >= *size) {
+        int grown_size = *size ? *size : 64;
+        while (grown_size <= i) grown_size *= 2;
+        long long *grown = (long long*) realloc(*counts, grown_size * sizeof(long long));
+        if (grown == NULL) return -1;
+        for (int j = *size; j < grown_size; j++) grown[j] = 0;
+        *counts = grown;
+        *size = grown_size;
+    }
+    (*counts)[i]++;
+    return 0;
+}
+
+/**
+ * @brief Prints the non-zero entries of a counter array.
+ */
+void print_counts(const char *title, const char *label, long long *counts, int size) {
+    printf("\n%s\n%8s %12s\n", title, label, "expansions");
+    for (int i = 0; i < size; i++) {
+        if (counts[i] > 0) printf("%8d %12lld\n", i, counts[i]);
+    }
+}
+
+/**
+ * @brief Prints aggregate statistics of the trace.
+ *
+ * A trace that ends inside a record (e.g. because the planner was killed) is
+ * summarised up to its last complete record.
+ * @return 0 on success, -1 on a malformed trace or if memory is exhausted.
+ */
+int trace_summary(TraceReader *r) {
+    long long by_tag[TRACE_SOLUTION + 1] = {0};
+    long long by_action[10][3] = {{0}};   // Generated, duplicate, dead end.
+    long long *by_depth = NULL, *by_h = NULL;
+    int depth_size = 0, h_size = 0;
+    long long since_best = 0, longest_plateau = 0, plateaus = 0;
+    int best_h = -1, solution = -1;
+    TraceEvent ev;
+    int status, params[5];
+
+    while ((status = trace_next(r, &ev)) == 1) {
+        TraceNode *n = &r->nodes[ev.node];
+        by_tag[ev.tag]++;
+
+        if (ev.tag == TRACE_GENERATED || ev.tag == TRACE_DUPLICATE || ev.tag == TRACE_DEAD_END) {
+            by_action[compact_action_unpack(ev.code, params)][ev.tag - TRACE_GENERATED]++;
+        }
+        else if (ev.tag == TRACE_EXPAND) {
+            if (count_at(&by_depth, &depth_size, n->depth) < 0 || count_at(&by_h, &h_size, n->h) < 0) {
+                printf("Memory exhausted while counting expansions.\n");
+                return -1;
+            }
+            if (best_h < 0 || n->h < best_h) {
+                if (best_h >= 0) plateaus++;
+                best_h = n->h;
+                since_best = 0;
+            }
+            else if (++since_best > longest_plateau) longest_plateau = since_best;
+        }
+        else if (ev.tag == TRACE_SOLUTION) solution = ev.node;
+    }
+    long long children = by_tag[TRACE_GENERATED] + by_tag[TRACE_DUPLICATE] + by_tag[TRACE_DEAD_END];
+    printf("Nodes: %d\n", r->count);
+    printf("Expansions: %lld\n", by_tag[TRACE_EXPAND]);
+    printf("Children: %lld (generated %lld, duplicates %lld, dead ends %lld)\n",
+           children, by_tag[TRACE_GENERATED], by_tag[TRACE_DUPLICATE], by_tag[TRACE_DEAD_END]);
+    if (by_tag[TRACE_EXPAND] > 0) {
+        printf("Branching factor: %.2f (%.2f added to the frontier)\n",
+               (double) children / by_tag[TRACE_EXPAND], (double) by_tag[TRACE_GENERATED] / by_tag[TRACE_EXPAND]);
+    }
+    printf("Best h: %d, improved %lld times; longest run of expansions without improvement: %lld\n",
+           best_h, plateaus, longest_plateau);
+    if (solution >= 0)
+        printf("Solution: node %d, depth %d, g=%d\n", solution, r->nodes[solution].depth, r->nodes[solution].g);
+    else
+        printf("Solution: none in the trace\n");
+
+    printf("\n%-24s %12s %12s %12s\n", "action", "generated", "duplicates", "dead ends");
+    for (int a = 0; a < 10; a++) {
+        if (by_action[a][0] + by_action[a][1] + by_action[a][2] == 0) continue;
+        printf("%-24s %12lld %12lld %12lld\n", action_name(a), by_action[a][0], by_action[a][1], by_action[a][2]);
+    }
+    print_counts("Expansions by depth", "depth", by_depth, depth_size);
+    print_counts("Expansions by h", "h", by_h, h_size);
+
+    free(by_depth);
+    free(by_h);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    TraceReader *r;
+    int status;
+
+    if (argc < 3 || (strcmp(argv[2], "csv") != 0 && strcmp(argv[2], "summary") != 0) ||
+        (strcmp(argv[2], "summary") == 0 && argc != 3) || argc > 4) {
+        syntax_message_trace();
+        return -1;
+    }
+
+    r = (TraceReader*) malloc(sizeof(TraceReader));
+    if (r == NULL || open_trace(argv[1], r) < 0) return -1;
+
+    if (strcmp(argv[2], "csv") == 0) {
+        FILE *out = argc == 4 ? fopen(argv[3], "w") : stdout;
+        if (out == NULL) {
+            printf("Error: Could not open CSV file: %s\n", argv[3]);
+            return -1;
+        }
+        status = trace_to_csv(r, out);
+        if (out != stdout) fclose(out);
+    }
+    else status = trace_summary(r);
+
+    if (status < 0) {
+        printf("Error: %s is truncated or malformed after %d nodes; only the records before were read.\n", argv[1], r->count);
+        return -1;
+    }
+
+    fclose(r->fp);
+    free(r->nodes);
+    free(r);
+    return 0;
+}
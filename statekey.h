@@ -0,0 +1,287 @@
+/**
+ * @file statekey.h
+ * @brief Packed, "flat" representation of a State used for duplicate detection.
+ *
+ * A full State carries every static table of the problem (traversal matrices,
+ * visibility bitmaps, ...), which makes it far too large to hash and store for
+ * every generated node. This file defines the StateKey, which keeps only the
+ * dynamic part of a State in narrow integer fields and bitmaps, together with
+ * the function that builds it and a 64-bit hash over it. The key is exact: two
+ * states with the same key are interchangeable for the search.
+ */
+
+#ifndef STATEKEY_H
+#define STATEKEY_H
+
+#include <string.h>
+
+#include "auxiliary.h"
+#include "uthash.h"
+
+/**
+ * @struct StateKey
+ * @brief A compact, "flat" representation of a State.
+ *
+ * This structure is used as the key for the closed set. It converts the complex
+ * data from the main State struct into a combination of narrow integers and bitmaps,
+ * enabling efficient comparison and storage of visited states. Fields are ordered
+ * from widest to narrowest so that the struct has no internal padding.
+ */
+typedef struct {
+    unsigned int has_soil_analysis[MAX_ROVERS]; // Bitmap of waypoints per rover
+    unsigned int has_rock_analysis[MAX_ROVERS]; // Bitmap of waypoints per rover
+    unsigned int have_image_bm[MAX_ROVERS];     // Bitmap of (objective, mode) pairs per rover
+    unsigned int has_soil_sample;               // Bitmap of waypoints
+    unsigned int has_rock_sample;               // Bitmap of waypoints
+    unsigned int communicated_soil_sample;      // Bitmap of waypoints
+    unsigned int communicated_rock_sample;      // Bitmap of waypoints
+    unsigned int communicated_image;            // Bitmap of (objective, mode) pairs
+    int recharges;
+    unsigned short energy_levels[MAX_ROVERS];   // Energy never exceeds 16 bits in practice
+    unsigned short cameras_calibrated;          // Bitmap of cameras
+    unsigned short full_stores;                 // Bitmap of stores
+    unsigned char rover_positions[MAX_ROVERS];
+} StateKey;
+
+/**
+ * @struct state_entry
+ * @brief Entry structure for the Hash Table (using uthash).
+ *
+ * Contains the state key (StateKey) and the necessary handle (hh)
+ * required by the uthash library to manage hash entries.
+ */
+typedef struct  {
+    StateKey key;
+    int g;             // Lowest g the state has been reached with.
+    UT_hash_handle hh; // Handle used by uthash
+} state_entry;
+
+/**
+ * @brief Creates a compact StateKey from a full State struct.
+ * @param s The full State to be converted.
+ * @param key The resulting StateKey.
+ */
+void make_state_key(State *s, StateKey *key) {
+    memset(key, 0, sizeof(StateKey));
+
+    // Convert dynamic information into bitmaps for a compact representation.
+    for (int r = 0; r < num_rovers; r++) {
+        key->rover_positions[r] = (unsigned char) s->rovers[r].position;
+        key->energy_levels[r] = (unsigned short) s->rovers[r].energy;
+        key->has_soil_analysis[r] = (unsigned int) s->rovers[r].has_soil_analysis;
+        key->has_rock_analysis[r] = (unsigned int) s->rovers[r].has_rock_analysis;
+        for (int o = 0; o < num_objectives; o++) {
+            for (int m = 0; m < num_modes; m++) {
+                if (s->rovers[r].have_image[o][m]) {
+                    key->have_image_bm[r] |= (1U << (o * num_modes + m));
+                }
+            }
+        }
+    }
+
+    for (int w = 0; w < num_waypoints; w++) {
+        if (s->waypoints[w].has_soil_sample) key->has_soil_sample |= (1U << w);
+        if (s->waypoints[w].has_rock_sample) key->has_rock_sample |= (1U << w);
+        if (s->waypoints[w].communicated_soil) key->communicated_soil_sample |= (1U << w);
+        if (s->waypoints[w].communicated_rock) key->communicated_rock_sample |= (1U << w);
+    }
+
+    for (int c = 0; c < num_cameras; c++) {
+        if (s->cameras[c].calibrated) key->cameras_calibrated |= (1U << c);
+    }
+
+    for (int st = 0; st < num_stores; st++) {
+        if (s->stores[st].is_full) key->full_stores |= (1U << st);
+    }
+
+    for (int o = 0; o < num_objectives; o++) {
+        for (int m = 0; m < num_modes; m++) {
+            if (s->objectives[o].communicated_image & (1 << m)) {
+                key->communicated_image |= (1U << (o * num_modes + m));
+            }
+        }
+    }
+
+    key->recharges = s->recharges;
+}
+
+/**
+ * @brief Computes a 64-bit hash of a StateKey (FNV-1a over its bytes).
+ *
+ * The key is always fully zeroed by make_state_key, so hashing the raw bytes
+ * is well defined.
+ * @param key The key to hash.
+ * @return The 64-bit hash value.
+ */
+unsigned long long state_key_hash(const StateKey *key) {
+    const unsigned char *bytes = (const unsigned char *) key;
+    unsigned long long h = 1469598103934665603ULL;
+    for (size_t i = 0; i < sizeof(StateKey); i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief Rebuilds a full State from a StateKey.
+ *
+ * The static parts of a state (traversal matrices, visibility, equipment, ...)
+ * never change during the search, so they are taken from a template state,
+ * normally the initial state, and only the dynamic fields are filled in from the key.
+ * @param key The packed state.
+ * @param template_state A state of the same problem providing the static fields.
+ * @param s The resulting full State.
+ */
+void unpack_state_key(const StateKey *key, const State *template_state, State *s) {
+    memcpy(s, template_state, sizeof(State));
+
+    for (int r = 0; r < num_rovers; r++) {
+        s->rovers[r].position = key->rover_positions[r];
+        s->rovers[r].energy = key->energy_levels[r];
+        s->rovers[r].has_soil_analysis = (int) key->has_soil_analysis[r];
+        s->rovers[r].has_rock_analysis = (int) key->has_rock_analysis[r];
+        for (int o = 0; o < num_objectives; o++) {
+            for (int m = 0; m < num_modes; m++) {
+                s->rovers[r].have_image[o][m] = (key->have_image_bm[r] >> (o * num_modes + m)) & 1U;
+            }
+        }
+    }
+
+    for (int w = 0; w < num_waypoints; w++) {
+        s->waypoints[w].has_soil_sample = (key->has_soil_sample >> w) & 1U;
+        s->waypoints[w].has_rock_sample = (key->has_rock_sample >> w) & 1U;
+        s->waypoints[w].communicated_soil = (key->communicated_soil_sample >> w) & 1U;
+        s->waypoints[w].communicated_rock = (key->communicated_rock_sample >> w) & 1U;
+    }
+
+    for (int c = 0; c < num_cameras; c++) {
+        s->cameras[c].calibrated = (key->cameras_calibrated >> c) & 1U;
+    }
+
+    for (int st = 0; st < num_stores; st++) {
+        s->stores[st].is_full = (key->full_stores >> st) & 1U;
+    }
+
+    for (int o = 0; o < num_objectives; o++) {
+        s->objectives[o].communicated_image = 0;
+        for (int m = 0; m < num_modes; m++) {
+            if ((key->communicated_image >> (o * num_modes + m)) & 1U) {
+                s->objectives[o].communicated_image |= (1 << m);
+            }
+        }
+    }
+
+    s->recharges = key->recharges;
+}
+
+/**
+ * @brief Writes an unsigned integer as a variable-length integer (LEB128).
+ *
+ * Every byte stores 7 bits of the value; the high bit is set on all bytes
+ * except the last one. Small values, which dominate search data, take one byte.
+ * @param buf The output buffer (at least 10 bytes must be available).
+ * @param value The value to write.
+ * @return The number of bytes written.
+ */
+int put_varint(unsigned char *buf, unsigned long long value) {
+    int n = 0;
+    while (value >= 0x80) {
+        buf[n++] = (unsigned char) (value | 0x80);
+        value >>= 7;
+    }
+    buf[n++] = (unsigned char) value;
+    return n;
+}
+
+/**
+ * @brief Reads a variable-length integer written by put_varint.
+ * @param buf The input buffer.
+ * @param len The number of bytes available in the buffer.
+ * @param value Output parameter for the decoded value.
+ * @return The number of bytes read, or 0 if the buffer ends inside the value.
+ */
+int get_varint(const unsigned char *buf, int len, unsigned long long *value) {
+    unsigned long long v = 0;
+    int shift = 0;
+    for (int n = 0; n < len && n < 10; n++) {
+        v |= (unsigned long long) (buf[n] & 0x7F) << shift;
+        if (!(buf[n] & 0x80)) {
+            *value = v;
+            return n + 1;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+/**
+ * @brief Encodes a StateKey as a delta against a base key.
+ *
+ * Writes the number of bytes that differ from the base, then every differing
+ * byte as (distance from the previous differing byte, XORed value). States
+ * reached during a search share most bytes with the initial state, so the
+ * encoding is usually a few dozen bytes long.
+ * @param buf The output buffer (at least 11 * sizeof(StateKey) + 10 bytes).
+ * @param key The key to encode.
+ * @param base The base key.
+ * @return The number of bytes written.
+ */
+int put_key_delta(unsigned char *buf, const StateKey *key, const StateKey *base) {
+    const unsigned char *bytes = (const unsigned char*) key;
+    const unsigned char *base_bytes = (const unsigned char*) base;
+    int changed = 0, n = 0;
+    size_t last = 0;
+
+    for (size_t i = 0; i < sizeof(StateKey); i++) if (bytes[i] != base_bytes[i]) changed++;
+    n += put_varint(buf + n, (unsigned long long) changed);
+    for (size_t i = 0; i < sizeof(StateKey); i++) {
+        if (bytes[i] == base_bytes[i]) continue;
+        n += put_varint(buf + n, (unsigned long long) (i - last));
+        buf[n++] = bytes[i] ^ base_bytes[i];
+        last = i;
+    }
+    return n;
+}
+
+/**
+ * @brief Decodes a StateKey written by put_key_delta.
+ * @param buf The input buffer.
+ * @param len The number of bytes available in the buffer.
+ * @param key Output parameter for the decoded key.
+ * @param base The base key used by the encoder.
+ * @return The number of bytes read, or 0 if the data is malformed.
+ */
+int get_key_delta(const unsigned char *buf, int len, StateKey *key, const StateKey *base) {
+    unsigned char *bytes = (unsigned char*) key;
+    unsigned long long changed, v;
+    size_t at = 0;
+    int pos, n;
+
+    memcpy(key, base, sizeof(StateKey));
+    if ((pos = get_varint(buf, len, &changed)) == 0) return 0;
+    for (unsigned long long i = 0; i < changed; i++) {
+        if ((n = get_varint(buf + pos, len - pos, &v)) == 0 || pos + n >= len) return 0;
+        pos += n;
+        at += (size_t) v;
+        if (at >= sizeof(StateKey)) return 0;
+        bytes[at] ^= buf[pos++];
+    }
+    return pos;
+}
+
+/**
+ * @brief Maps a signed integer to an unsigned one so that small magnitudes stay small.
+ */
+unsigned long long zigzag_encode(long long v) {
+    return ((unsigned long long) v << 1) ^ (unsigned long long) (v >> 63);
+}
+
+/**
+ * @brief Inverse of zigzag_encode.
+ */
+long long zigzag_decode(unsigned long long v) {
+    return (long long) (v >> 1) ^ -(long long) (v & 1);
+}
+
+#endif // STATEKEY_H
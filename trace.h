@@ -0,0 +1,153 @@
+/**
+ * @file trace.h
+ * @brief Binary trace of the search, for offline analysis (--trace).
+ *
+ * Every expansion and every generated child is written to the trace file as a
+ * small record of varints (see put_varint). Records go through a memory buffer,
+ * which is written out when it is full and when the program exits, so tracing
+ * can stay on for full-length runs.
+ *
+ * Nodes are numbered in the order they are generated: the root is node 0, and
+ * every generation record (whatever its outcome) takes the next number. A
+ * generation record does not store its parent: the parent is the node of the
+ * last expansion record before it.
+ *
+ * File layout:
+ *   magic (8 bytes), version,
+ *   records: a tag byte followed by varints
+ *     TRACE_ROOT       h, f                    (node 0, g = 0)
+ *     TRACE_EXPAND     node
+ *     TRACE_GENERATED  action code, g, h, f    (added to the frontier)
+ *     TRACE_DUPLICATE  action code, g          (already seen; dropped)
+ *     TRACE_DEAD_END   action code, g          (heuristic reported a dead end; dropped)
+ *     TRACE_SOLUTION   node
+ * The action code is the CompactAction of the generating action.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "auxiliary.h"
+#include "statekey.h"
+
+#define TRACE_MAGIC   "RVTRACE\n" // 8 bytes.
+#define TRACE_VERSION 1
+#define TRACE_BUFFER  (1 << 16)   // Bytes buffered before a write.
+
+#define TRACE_ROOT      1
+#define TRACE_EXPAND    2
+#define TRACE_GENERATED 3
+#define TRACE_DUPLICATE 4
+#define TRACE_DEAD_END  5
+#define TRACE_SOLUTION  6
+
+char trace_file[MAX_LINE] = "";   // Trace file (--trace); empty when disabled.
+FILE *trace_fp = NULL;            // Open trace file (NULL when not tracing).
+unsigned char *trace_buffer = NULL;
+int trace_len = 0;                // Bytes in trace_buffer.
+int trace_nodes = 0;              // Numbers given to nodes so far.
+
+/**
+ * @brief Writes the buffered records to the trace file.
+ *
+ * A write error stops the tracing; the search goes on.
+ */
+void trace_flush() {
+    if (trace_fp == NULL || trace_len == 0) return;
+    if (fwrite(trace_buffer, 1, trace_len, trace_fp) != (size_t) trace_len) {
+        printf("Error writing trace file %s. Tracing is stopped.\n", trace_file);
+        fclose(trace_fp);
+        trace_fp = NULL;
+    }
+    trace_len = 0;
+}
+
+/**
+ * @brief Flushes and closes the trace file (also registered with atexit).
+ */
+void trace_close() {
+    if (trace_fp == NULL) return;
+    trace_flush();
+    if (trace_fp != NULL) fclose(trace_fp);
+    trace_fp = NULL;
+    free(trace_buffer);
+    trace_buffer = NULL;
+}
+
+/**
+ * @brief Opens the trace file given with --trace and writes its header.
+ * @return 0 on success, -1 if the file cannot be created.
+ */
+int trace_open() {
+    trace_fp = fopen(trace_file, "wb");
+    trace_buffer = (unsigned char*) malloc(TRACE_BUFFER);
+    if (trace_fp == NULL || trace_buffer == NULL) {
+        printf("Cannot create trace file %s.\n", trace_file);
+        if (trace_fp != NULL) fclose(trace_fp);
+        trace_fp = NULL;
+        return -1;
+    }
+    fwrite(TRACE_MAGIC, 1, 8, trace_fp);
+    trace_len = put_varint(trace_buffer, TRACE_VERSION);
+    atexit(trace_close); // Runs on timeouts and other exits too.
+    return 0;
+}
+
+/**
+ * @brief Appends a record to the buffer.
+ * @param tag The record type.
+ * @param values The varints of the record.
+ * @param count The number of values (at most 4).
+ */
+void trace_record(int tag, const unsigned long long *values, int count) {
+    if (trace_len + 1 + 10 * count > TRACE_BUFFER) trace_flush();
+    if (trace_fp == NULL) return;
+    trace_buffer[trace_len++] = (unsigned char) tag;
+    for (int i = 0; i < count; i++) trace_len += put_varint(trace_buffer + trace_len, values[i]);
+}
+
+/**
+ * @brief Records the root of the search and gives it number 0.
+ */
+void trace_root(struct tree_node *root) {
+    unsigned long long values[2] = {(unsigned long long) root->h, (unsigned long long) root->f};
+    root->id = trace_nodes++;
+    trace_record(TRACE_ROOT, values, 2);
+}
+
+/**
+ * @brief Records the expansion of a node.
+ */
+void trace_expand(struct tree_node *node) {
+    unsigned long long value = (unsigned long long) node->id;
+    trace_record(TRACE_EXPAND, &value, 1);
+}
+
+/**
+ * @brief Records a generated child and gives it the next number.
+ * @param child The child; h and f are only read for TRACE_GENERATED.
+ * @param outcome TRACE_GENERATED, TRACE_DUPLICATE or TRACE_DEAD_END.
+ */
+void trace_child(struct tree_node *child, int outcome) {
+    unsigned long long values[4] = {child->action_taken.code, (unsigned long long) child->g, 0, 0};
+    child->id = trace_nodes++;
+    if (outcome == TRACE_GENERATED) {
+        values[2] = (unsigned long long) child->h;
+        values[3] = (unsigned long long) child->f;
+        trace_record(outcome, values, 4);
+    }
+    else trace_record(outcome, values, 2);
+}
+
+/**
+ * @brief Records the node found to be a solution.
+ */
+void trace_solution(struct tree_node *node) {
+    unsigned long long value = (unsigned long long) node->id;
+    trace_record(TRACE_SOLUTION, &value, 1);
+}
+
+#endif // TRACE_H